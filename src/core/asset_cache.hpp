@@ -0,0 +1,170 @@
+#ifndef CROSSDEV_ASSET_CACHE_HPP
+#define CROSSDEV_ASSET_CACHE_HPP
+
+#include "dir_handle.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "file_id.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+/** IMF-fixdate ("Sun, 06 Nov 1994 08:49:37 GMT") for seconds since the epoch, whatever the locale */
+std::string httpDate(int64_t seconds);
+/** Inverse of httpDate(); false if text is not an IMF-fixdate */
+bool parseHttpDate(std::string_view text, int64_t& seconds);
+/** Content-Type for a file name, chosen by extension */
+const char* mimeTypeFor(std::string_view name);
+
+/**
+ * An open file with the validators and headers a web tier needs to
+ * answer for it. Everything, including the content hash, is computed when
+ * AssetCache opens the file, outside its lock; the asset is immutable once
+ * published.
+ */
+class Asset {
+public:
+    ~Asset();
+    Asset(const Asset&) = delete;
+    Asset& operator=(const Asset&) = delete;
+
+    /** Read-only descriptor for this exact file version */
+    int fd() const { return m_fd; }
+    const std::string& path() const { return m_path; }
+    FileId id() const { return m_id; }
+    uint64_t size() const { return m_size; }
+    int64_t mtimeNs() const { return m_mtimeNs; }
+    const char* contentType() const { return m_contentType; }
+    const std::string& lastModified() const { return m_lastModified; }
+
+    /**
+     * hash64() of the content. Files larger than
+     * AssetCacheOptions::hashLimit are not hashed and report 0.
+     */
+    uint64_t contentHash() const { return m_hash; }
+    /**
+     * Strong ETag: the content hash, or size and mtime for files above
+     * the hash limit
+     */
+    const std::string& etag() const { return m_etag; }
+    /**
+     * "Content-Type", "Last-Modified", "ETag" and "Accept-Ranges" lines,
+     * each ending in CRLF, ready to append to a response head
+     */
+    const std::string& headers() const { return m_headers; }
+
+    /** If-None-Match against etag(), using the weak comparison */
+    bool matchesETag(std::string_view ifNoneMatch) const;
+    /** False when If-Modified-Since is a valid date not older than the file */
+    bool modifiedSince(std::string_view ifModifiedSince) const;
+
+private:
+    friend class AssetCache;
+    Asset() = default;
+
+    void computeValidators(uint64_t hashLimit);
+
+    int m_fd = -1;
+    std::string m_path;
+    FileId m_id;
+    uint64_t m_size = 0;
+    int64_t m_mtimeNs = 0;
+    const char* m_contentType = nullptr;
+    std::string m_lastModified;
+    uint64_t m_hash = 0;
+    std::string m_etag;
+    std::string m_headers;
+
+    // Owned by the cache, under its lock: last time the entry was checked against the disk
+    int64_t m_checkedMs = 0;
+};
+
+/**
+ * Tuning for AssetCache
+ */
+struct AssetCacheOptions {
+    /** Assets (and therefore open descriptors) kept */
+    size_t capacity = 1024;
+    /**
+     * An entry younger than this is trusted without touching the disk;
+     * older entries are re-stat-ed and reopened if (dev, ino, size, mtime)
+     * changed. Use invalidate() to drop entries as soon as a watcher
+     * reports a change.
+     */
+    int64_t revalidateMs = 1000;
+    /** Largest file whose content is hashed for its ETag, when it is opened */
+    uint64_t hashLimit = 16 * 1024 * 1024;
+};
+
+enum class AssetStatus {
+    Found,
+    NotFound,
+    Forbidden,
+    /** The path names a directory */
+    Directory
+};
+
+struct AssetLookup {
+    std::shared_ptr<const Asset> asset;
+    AssetStatus status = AssetStatus::NotFound;
+    /** Answered from the cache without opening the file */
+    bool cached = false;
+};
+
+/**
+ * LRU cache of Assets below a root directory, keyed by relative path and
+ * validated by (dev, ino, size, mtime).
+ *
+ * Within revalidateMs of the last check a lookup is a hash-map probe
+ * under a mutex with no system calls, so conditional requests for hot
+ * files are answered without disk I/O. Opening, hashing and re-stat-ing
+ * happen outside the mutex, so a miss never stalls other lookups.
+ *
+ * Lookups cannot leave the root: on Linux files are opened with
+ * openat2(RESOLVE_BENEATH), so symlinks are followed only while they stay
+ * below it; elsewhere no symlink is followed. Either way an escape is
+ * reported as AssetStatus::Forbidden. Assets are handed out as
+ * shared_ptrs: an evicted or replaced file stays open until its last
+ * holder lets go. Thread-safe.
+ */
+class AssetCache {
+public:
+    explicit AssetCache(const Path& root, AssetCacheOptions options = AssetCacheOptions());
+
+    /** The asset at a relative path ('/'-separated, no leading slash) */
+    AssetLookup lookup(const std::string& relative);
+
+    /** Drop the entry for relative, e.g. on a change notification */
+    void invalidate(const std::string& relative);
+    void clear();
+
+    size_t size() const;
+    const Path& root() const { return m_root.path(); }
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<Asset>>;
+
+    std::shared_ptr<Asset> open(const std::string& relative, AssetStatus& status) const;
+
+    DirHandle m_root;
+    AssetCacheOptions m_options;
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
+
+#endif // CROSSDEV_ASSET_CACHE_HPP
@@ -0,0 +1,389 @@
+#include "asset_cache.hpp"
+#include "hash.hpp"
+#include "unix_io.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/openat2.h>)
+#define CROSSDEV_HAVE_OPENAT2 1
+#include <linux/openat2.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr size_t kHashChunk = 64 * 1024;
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int64_t mtimeOf(const struct stat& st) {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+bool sameVersion(const Asset& asset, const struct stat& st) {
+    return asset.id() == FileId{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)} &&
+           asset.size() == static_cast<uint64_t>(st.st_size) && asset.mtimeNs() == mtimeOf(st);
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+/**
+ * Open relative below root without letting it escape: symlinks may not
+ * resolve outside root, and ".." may not climb above it. Uses openat2()
+ * with RESOLVE_BENEATH where the kernel has it; elsewhere every
+ * component is opened with O_NOFOLLOW, so no symlink is followed at all.
+ */
+int openBeneath(int root, const std::string& relative, int flags) {
+#if defined(CROSSDEV_HAVE_OPENAT2)
+    static std::atomic<bool> unsupported{false};
+    if (!unsupported.load(std::memory_order_relaxed)) {
+        struct open_how how;
+        std::memset(&how, 0, sizeof(how));
+        how.flags = static_cast<uint64_t>(flags);
+        how.resolve = RESOLVE_BENEATH | RESOLVE_NO_MAGICLINKS;
+        int fd = static_cast<int>(::syscall(SYS_openat2, root, relative.c_str(), &how, sizeof(how)));
+        if (fd >= 0 || (errno != ENOSYS && errno != EPERM)) {
+            return fd;
+        }
+        // Old kernel, or a seccomp filter that does not know the call
+        unsupported.store(true, std::memory_order_relaxed);
+    }
+#endif
+    detail::FileDescriptor directory;
+    int parent = root;
+    size_t start = 0;
+    for (;;) {
+        size_t slash = relative.find('/', start);
+        std::string component = relative.substr(start, slash == std::string::npos ? std::string::npos : slash - start);
+        if (component == "..") {
+            errno = EXDEV;
+            return -1;
+        }
+        if (slash == std::string::npos) {
+            return ::openat(parent, component.empty() ? "." : component.c_str(), flags | O_NOFOLLOW);
+        }
+        if (!component.empty() && component != ".") {
+            directory.reset(::openat(parent, component.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+            if (!directory.valid()) {
+                // O_DIRECTORY reports a link as ENOTDIR; report it as the refusal it is
+                struct stat st;
+                if (errno == ENOTDIR && ::fstatat(parent, component.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0 &&
+                    S_ISLNK(st.st_mode)) {
+                    errno = ELOOP;
+                }
+                return -1;
+            }
+            parent = directory.get();
+        }
+        start = slash + 1;
+    }
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+} // namespace
+
+// HTTP dates are always English; strftime()'s %a and %b would follow LC_TIME
+const char* const kDayNames[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+const char* const kMonthNames[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                   "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+std::string httpDate(int64_t seconds) {
+    time_t value = static_cast<time_t>(seconds);
+    struct tm parts;
+    gmtime_r(&value, &parts);
+    char buffer[64];
+    int length = std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                               kDayNames[parts.tm_wday], parts.tm_mday, kMonthNames[parts.tm_mon],
+                               parts.tm_year + 1900, parts.tm_hour, parts.tm_min, parts.tm_sec);
+    return std::string(buffer, static_cast<size_t>(length));
+}
+
+bool parseHttpDate(std::string_view text, int64_t& seconds) {
+    // "Sun, 06 Nov 1994 08:49:37 GMT": fixed width, so every field has a fixed offset
+    if (text.size() != 29 || text.substr(3, 2) != ", " || text[7] != ' ' || text[11] != ' ' || text[16] != ' ' ||
+        text[19] != ':' || text[22] != ':' || text.substr(25) != " GMT") {
+        return false;
+    }
+    auto number = [&](size_t at, size_t width, int& value) {
+        value = 0;
+        for (size_t i = at; i < at + width; ++i) {
+            if (text[i] < '0' || text[i] > '9') {
+                return false;
+            }
+            value = value * 10 + (text[i] - '0');
+        }
+        return true;
+    };
+    auto name = [&](std::string_view field, const char* const* names, int count) {
+        for (int i = 0; i < count; ++i) {
+            if (field == names[i]) {
+                return i;
+            }
+        }
+        return -1;
+    };
+    struct tm parts;
+    std::memset(&parts, 0, sizeof(parts));
+    int year;
+    parts.tm_mon = name(text.substr(8, 3), kMonthNames, 12);
+    if (name(text.substr(0, 3), kDayNames, 7) < 0 || parts.tm_mon < 0 || !number(5, 2, parts.tm_mday) ||
+        !number(12, 4, year) || !number(17, 2, parts.tm_hour) || !number(20, 2, parts.tm_min) ||
+        !number(23, 2, parts.tm_sec) || parts.tm_mday < 1 || parts.tm_mday > 31 || parts.tm_hour > 23 ||
+        parts.tm_min > 59 || parts.tm_sec > 60) {
+        return false;
+    }
+    parts.tm_year = year - 1900;
+    seconds = static_cast<int64_t>(timegm(&parts));
+    return true;
+}
+
+const char* mimeTypeFor(std::string_view name) {
+    static const std::pair<const char*, const char*> kTypes[] = {
+        {".html", "text/html; charset=utf-8"},
+        {".htm", "text/html; charset=utf-8"},
+        {".css", "text/css; charset=utf-8"},
+        {".js", "text/javascript; charset=utf-8"},
+        {".mjs", "text/javascript; charset=utf-8"},
+        {".json", "application/json"},
+        {".map", "application/json"},
+        {".txt", "text/plain; charset=utf-8"},
+        {".xml", "application/xml"},
+        {".svg", "image/svg+xml"},
+        {".png", "image/png"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".gif", "image/gif"},
+        {".webp", "image/webp"},
+        {".ico", "image/x-icon"},
+        {".woff", "font/woff"},
+        {".woff2", "font/woff2"},
+        {".wasm", "application/wasm"},
+        {".pdf", "application/pdf"},
+    };
+    size_t dot = name.find_last_of("./");
+    if (dot != std::string_view::npos && name[dot] == '.') {
+        std::string_view extension = name.substr(dot);
+        for (const auto& type : kTypes) {
+            if (equalsIgnoreCase(extension, type.first)) {
+                return type.second;
+            }
+        }
+    }
+    return "application/octet-stream";
+}
+
+Asset::~Asset() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+void Asset::computeValidators(uint64_t hashLimit) {
+    char etag[48];
+    bool hashed = false;
+    if (m_size <= hashLimit) {
+        Hasher64 hasher;
+        char buffer[kHashChunk];
+        uint64_t offset = 0;
+        hashed = true;
+        while (offset < m_size) {
+            ssize_t got = ::pread(m_fd, buffer, sizeof(buffer), static_cast<off_t>(offset));
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            if (got <= 0) {
+                hashed = false; // Truncated or unreadable; fall back to the metadata validator
+                break;
+            }
+            hasher.update(buffer, static_cast<size_t>(got));
+            offset += static_cast<uint64_t>(got);
+        }
+        m_hash = hashed ? hasher.digest() : 0;
+    }
+    if (hashed) {
+        std::snprintf(etag, sizeof(etag), "\"%016llx\"", static_cast<unsigned long long>(m_hash));
+    } else {
+        std::snprintf(etag, sizeof(etag), "\"%llx-%llx\"", static_cast<unsigned long long>(m_size),
+                      static_cast<unsigned long long>(m_mtimeNs));
+    }
+    m_etag = etag;
+    m_headers = std::string("Content-Type: ") + m_contentType + "\r\nLast-Modified: " + m_lastModified +
+                "\r\nETag: " + m_etag + "\r\nAccept-Ranges: bytes\r\n";
+}
+
+bool Asset::matchesETag(std::string_view ifNoneMatch) const {
+    if (trim(ifNoneMatch) == "*") {
+        return true;
+    }
+    const std::string& current = etag();
+    while (!ifNoneMatch.empty()) {
+        size_t comma = ifNoneMatch.find(',');
+        std::string_view candidate = trim(ifNoneMatch.substr(0, comma));
+        if (candidate.substr(0, 2) == "W/") {
+            candidate.remove_prefix(2);
+        }
+        if (candidate == current) {
+            return true;
+        }
+        ifNoneMatch = comma == std::string_view::npos ? std::string_view() : ifNoneMatch.substr(comma + 1);
+    }
+    return false;
+}
+
+bool Asset::modifiedSince(std::string_view ifModifiedSince) const {
+    int64_t since;
+    if (!parseHttpDate(ifModifiedSince, since)) {
+        return true;
+    }
+    return m_mtimeNs / 1000000000 > since;
+}
+
+AssetCache::AssetCache(const Path& root, AssetCacheOptions options)
+    : m_root(root), m_options(options) {
+    m_options.capacity = std::max<size_t>(m_options.capacity, 1);
+}
+
+AssetLookup AssetCache::lookup(const std::string& relative) {
+    AssetLookup result;
+    int64_t now = nowMs();
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto found = m_index.find(relative);
+    if (found != m_index.end()) {
+        std::shared_ptr<Asset> cached = found->second->second;
+        m_lru.splice(m_lru.begin(), m_lru, found->second);
+        bool fresh = now - cached->m_checkedMs < m_options.revalidateMs;
+        if (!fresh) {
+            // Re-stat without the lock; the entry may be dropped or replaced meanwhile
+            lock.unlock();
+            struct stat st;
+            fresh = ::fstatat(m_root.fd(), relative.c_str(), &st, 0) == 0 && sameVersion(*cached, st);
+            lock.lock();
+        }
+        if (fresh) {
+            cached->m_checkedMs = std::max(cached->m_checkedMs, now);
+            result.asset = std::move(cached);
+            result.status = AssetStatus::Found;
+            result.cached = true;
+            return result;
+        }
+        found = m_index.find(relative);
+        if (found != m_index.end() && found->second->second == cached) {
+            m_lru.erase(found->second);
+            m_index.erase(found);
+        }
+    }
+    lock.unlock();
+
+    std::shared_ptr<Asset> opened = open(relative, result.status);
+    if (!opened) {
+        return result;
+    }
+    opened->m_checkedMs = now;
+
+    lock.lock();
+    found = m_index.find(relative);
+    if (found != m_index.end()) {
+        // Another thread opened it meanwhile; keep the published one
+        result.asset = found->second->second;
+        return result;
+    }
+    m_lru.emplace_front(relative, opened);
+    m_index.emplace(m_lru.front().first, m_lru.begin());
+    while (m_lru.size() > m_options.capacity) {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+    result.asset = std::move(opened);
+    return result;
+}
+
+std::shared_ptr<Asset> AssetCache::open(const std::string& relative, AssetStatus& status) const {
+    // O_NONBLOCK so a FIFO or device in the tree cannot stall the caller in open()
+    detail::FileDescriptor fd(openBeneath(m_root.fd(), relative, O_RDONLY | O_NONBLOCK | O_CLOEXEC));
+    struct stat st;
+    if (!fd.valid() || ::fstat(fd.get(), &st) != 0) {
+        // EXDEV and ELOOP: a symlink or ".." that would leave the root
+        bool refused = errno == EACCES || errno == EXDEV || errno == ELOOP;
+        status = refused ? AssetStatus::Forbidden : AssetStatus::NotFound;
+        return nullptr;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        status = AssetStatus::Directory;
+        return nullptr;
+    }
+    if (!S_ISREG(st.st_mode)) {
+        status = AssetStatus::Forbidden;
+        return nullptr;
+    }
+    int flags = ::fcntl(fd.get(), F_GETFL);
+    if (flags >= 0) {
+        ::fcntl(fd.get(), F_SETFL, flags & ~O_NONBLOCK);
+    }
+
+    std::shared_ptr<Asset> asset(new Asset());
+    asset->m_fd = fd.release();
+    asset->m_path = relative;
+    asset->m_id = FileId{static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    asset->m_size = static_cast<uint64_t>(st.st_size);
+    asset->m_mtimeNs = mtimeOf(st);
+    asset->m_contentType = mimeTypeFor(relative);
+    asset->m_lastModified = httpDate(asset->m_mtimeNs / 1000000000);
+    asset->computeValidators(m_options.hashLimit);
+    status = AssetStatus::Found;
+    return asset;
+}
+
+void AssetCache::invalidate(const std::string& relative) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(relative);
+    if (found != m_index.end()) {
+        m_lru.erase(found->second);
+        m_index.erase(found);
+    }
+}
+
+void AssetCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_lru.clear();
+}
+
+size_t AssetCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lru.size();
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,78 @@
+#include "async.hpp"
+#include "thread_pool.hpp"
+
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+template <typename T, typename Operation>
+std::future<T> runAsync(Operation operation, Completion<T> onComplete) {
+    return ThreadPool::io().submit([operation = std::move(operation), onComplete = std::move(onComplete)]() mutable {
+        T value;
+        try {
+            value = operation();
+        } catch (...) {
+            if (onComplete) {
+                onComplete(T(), std::current_exception());
+            }
+            throw;
+        }
+        if (onComplete) {
+            onComplete(value, nullptr);
+        }
+        return value;
+    });
+}
+
+template <typename Operation>
+std::future<void> runAsync(Operation operation, VoidCompletion onComplete) {
+    return ThreadPool::io().submit([operation = std::move(operation), onComplete = std::move(onComplete)]() mutable {
+        try {
+            operation();
+        } catch (...) {
+            if (onComplete) {
+                onComplete(std::current_exception());
+            }
+            throw;
+        }
+        if (onComplete) {
+            onComplete(nullptr);
+        }
+    });
+}
+
+} // namespace
+
+std::future<std::string> readAsync(const Path& path, Completion<std::string> onComplete) {
+    return runAsync<std::string>([path]() { return File(path).readAsText(); }, std::move(onComplete));
+}
+
+std::future<std::vector<uint8_t>> readBinaryAsync(const Path& path, Completion<std::vector<uint8_t>> onComplete) {
+    return runAsync<std::vector<uint8_t>>([path]() { return File(path).readAsBinary(); }, std::move(onComplete));
+}
+
+std::future<void> writeAsync(const Path& path, std::string content, VoidCompletion onComplete) {
+    return runAsync([path, content = std::move(content)]() { File(path).writeText(content); },
+                    std::move(onComplete));
+}
+
+std::future<void> writeBinaryAsync(const Path& path, std::vector<uint8_t> content, VoidCompletion onComplete) {
+    return runAsync([path, content = std::move(content)]() { File(path).writeBinary(content); },
+                    std::move(onComplete));
+}
+
+std::future<std::vector<Path>> listAsync(const Path& directory, bool recursive,
+                                         Completion<std::vector<Path>> onComplete) {
+    return runAsync<std::vector<Path>>([directory, recursive]() { return Directory(directory).list(recursive); },
+                                       std::move(onComplete));
+}
+
+std::future<void> copyAsync(const Path& source, const Path& destination, VoidCompletion onComplete) {
+    return runAsync([source, destination]() { File(source).copy(destination); }, std::move(onComplete));
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,45 @@
+#ifndef CROSSDEV_ASYNC_HPP
+#define CROSSDEV_ASYNC_HPP
+
+#include "filesystem.hpp"
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <string>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Completion callbacks for asynchronous operations.
+ *
+ * The callback runs on the I/O pool thread that finished the operation,
+ * before the returned future becomes ready. On failure the value is
+ * default-constructed and error holds the exception.
+ */
+template <typename T>
+using Completion = std::function<void(const T& value, std::exception_ptr error)>;
+using VoidCompletion = std::function<void(std::exception_ptr error)>;
+
+/**
+ * Asynchronous counterparts of the File and Directory operations.
+ *
+ * Each call is queued on ThreadPool::io(), a bounded pool shared by the
+ * whole process, so callers on an event loop never block on the disk.
+ */
+std::future<std::string> readAsync(const Path& path, Completion<std::string> onComplete = nullptr);
+std::future<std::vector<uint8_t>> readBinaryAsync(const Path& path,
+                                                  Completion<std::vector<uint8_t>> onComplete = nullptr);
+std::future<void> writeAsync(const Path& path, std::string content, VoidCompletion onComplete = nullptr);
+std::future<void> writeBinaryAsync(const Path& path, std::vector<uint8_t> content,
+                                   VoidCompletion onComplete = nullptr);
+std::future<std::vector<Path>> listAsync(const Path& directory, bool recursive = false,
+                                         Completion<std::vector<Path>> onComplete = nullptr);
+std::future<void> copyAsync(const Path& source, const Path& destination, VoidCompletion onComplete = nullptr);
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_ASYNC_HPP
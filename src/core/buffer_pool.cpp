@@ -0,0 +1,72 @@
+#include "buffer_pool.hpp"
+
+#include <new>
+#include <utility>
+
+namespace crossdev {
+
+AlignedBufferPool::Buffer::~Buffer() {
+    if (m_data != nullptr) {
+        m_pool->release(m_data);
+    }
+}
+
+AlignedBufferPool::Buffer::Buffer(Buffer&& other) noexcept
+    : m_pool(std::exchange(other.m_pool, nullptr)), m_data(std::exchange(other.m_data, nullptr)) {}
+
+AlignedBufferPool::Buffer& AlignedBufferPool::Buffer::operator=(Buffer&& other) noexcept {
+    if (this != &other) {
+        if (m_data != nullptr) {
+            m_pool->release(m_data);
+        }
+        m_pool = std::exchange(other.m_pool, nullptr);
+        m_data = std::exchange(other.m_data, nullptr);
+    }
+    return *this;
+}
+
+AlignedBufferPool::AlignedBufferPool(size_t bufferSize, size_t alignment, size_t maxPooled)
+    : m_bufferSize((bufferSize + alignment - 1) / alignment * alignment),
+      m_alignment(alignment),
+      m_maxPooled(maxPooled) {}
+
+AlignedBufferPool::~AlignedBufferPool() {
+    for (char* data : m_free) {
+        deallocate(data);
+    }
+}
+
+AlignedBufferPool::Buffer AlignedBufferPool::acquire() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_free.empty()) {
+            char* data = m_free.back();
+            m_free.pop_back();
+            return Buffer(this, data);
+        }
+    }
+    void* data = ::operator new(m_bufferSize, std::align_val_t(m_alignment));
+    return Buffer(this, static_cast<char*>(data));
+}
+
+void AlignedBufferPool::release(char* data) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_free.size() < m_maxPooled) {
+            m_free.push_back(data);
+            return;
+        }
+    }
+    deallocate(data);
+}
+
+void AlignedBufferPool::deallocate(char* data) const {
+    ::operator delete(data, std::align_val_t(m_alignment));
+}
+
+AlignedBufferPool& AlignedBufferPool::shared() {
+    static AlignedBufferPool pool(1 << 20, 4096);
+    return pool;
+}
+
+} // namespace crossdev
@@ -0,0 +1,70 @@
+#ifndef CROSSDEV_BUFFER_POOL_HPP
+#define CROSSDEV_BUFFER_POOL_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace crossdev {
+
+/**
+ * Pool of equally sized, aligned I/O buffers.
+ *
+ * Unbuffered (O_DIRECT) transfers need memory aligned to the device block
+ * size; allocating that per call is expensive, so buffers are recycled.
+ * Buffers returned while the pool already holds maxPooled are freed.
+ */
+class AlignedBufferPool {
+public:
+    class Buffer {
+    public:
+        Buffer() = default;
+        ~Buffer();
+        Buffer(Buffer&& other) noexcept;
+        Buffer& operator=(Buffer&& other) noexcept;
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+
+        char* data() const { return m_data; }
+        size_t size() const { return m_pool ? m_pool->m_bufferSize : 0; }
+        explicit operator bool() const { return m_data != nullptr; }
+
+    private:
+        friend class AlignedBufferPool;
+        Buffer(AlignedBufferPool* pool, char* data) : m_pool(pool), m_data(data) {}
+
+        AlignedBufferPool* m_pool = nullptr;
+        char* m_data = nullptr;
+    };
+
+    AlignedBufferPool(size_t bufferSize, size_t alignment, size_t maxPooled = 16);
+    ~AlignedBufferPool();
+
+    AlignedBufferPool(const AlignedBufferPool&) = delete;
+    AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+    Buffer acquire();
+
+    size_t bufferSize() const { return m_bufferSize; }
+    size_t alignment() const { return m_alignment; }
+
+    /**
+     * Shared pool of 1 MiB buffers aligned to 4 KiB, used by the streaming
+     * reader and writer.
+     */
+    static AlignedBufferPool& shared();
+
+private:
+    void release(char* data);
+    void deallocate(char* data) const;
+
+    size_t m_bufferSize;
+    size_t m_alignment;
+    size_t m_maxPooled;
+    std::vector<char*> m_free;
+    std::mutex m_mutex;
+};
+
+} // namespace crossdev
+
+#endif // CROSSDEV_BUFFER_POOL_HPP
@@ -0,0 +1,466 @@
+#include "content_index.hpp"
+#include "index_format.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+#include "walker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'D', 'X', 'C', 'O', 'N', 'T', '\0'};
+constexpr uint32_t kVersion = 1;
+// Files read per indexing task; each task owns one trigram bitmap
+constexpr size_t kFilesPerTask = 64;
+// Documents per posting-list build shard
+constexpr size_t kDocumentsPerShard = 1024;
+// Document flags. A file whose content is not indexed (too large, binary or
+// unreadable) can never be ruled out by its trigrams, so it is a candidate
+// for every query unless it is binary; an unreadable one is also retried by
+// the next update() even if its size and mtime are unchanged
+constexpr uint8_t kNotIndexed = 1;
+constexpr uint8_t kBinary = 2;
+constexpr uint8_t kUnreadable = 4;
+
+using detail::Section;
+using detail::TrigramEntry;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t documentCount;
+    uint64_t trigramCount;
+    Section root;
+    Section pathOffsets;
+    Section pathBytes;
+    Section sizes;
+    Section mtimes;
+    Section flags;
+    Section forwardOffsets;
+    Section forwardBytes;
+    Section trigrams;
+    Section postings;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "sections after the header must stay 8-byte aligned");
+
+[[noreturn]] void corrupt() {
+    throw FileSystemException("Corrupt content index");
+}
+
+struct Document {
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    uint8_t flags = 0;
+    // Delta-varint encoded, sorted trigram set
+    std::string forward;
+};
+
+void encodeDeltas(const std::vector<uint32_t>& values, std::string& out) {
+    uint32_t previous = 0;
+    for (uint32_t value : values) {
+        detail::putVarint(out, value - previous);
+        previous = value;
+    }
+}
+
+// Decode count delta-encoded values; single-byte deltas, the common case
+// for dense posting lists, skip the general varint loop
+void decodeDeltas(const uint8_t* position, const uint8_t* end, size_t count, std::vector<uint32_t>& out) {
+    out.resize(count);
+    uint32_t value = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (position < end && *position < 0x80) {
+            value += *position++;
+        } else {
+            uint64_t delta;
+            position = detail::getVarint(position, end, delta);
+            if (position == nullptr) {
+                corrupt();
+            }
+            value += static_cast<uint32_t>(delta);
+        }
+        out[i] = value;
+    }
+}
+
+// Distinct byte trigrams of content, sorted; seen is a 2^24-bit scratch bitmap left cleared
+void extractTrigrams(std::string_view content, std::vector<uint64_t>& seen, std::vector<uint32_t>& out) {
+    out.clear();
+    if (content.size() < 3) {
+        return;
+    }
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(content.data());
+    uint32_t key = (static_cast<uint32_t>(data[0]) << 8) | data[1];
+    for (size_t i = 2; i < content.size(); ++i) {
+        key = ((key << 8) | data[i]) & 0xFFFFFF;
+        uint64_t bit = uint64_t(1) << (key & 63);
+        uint64_t& word = seen[key >> 6];
+        if (!(word & bit)) {
+            word |= bit;
+            out.push_back(key);
+        }
+    }
+    for (uint32_t trigram : out) {
+        seen[trigram >> 6] = 0;
+    }
+    std::sort(out.begin(), out.end());
+}
+
+std::string serialize(const std::string& root, const std::vector<Document>& documents, ThreadPool& pool) {
+    const size_t count = documents.size();
+    if (count >= UINT32_MAX) {
+        throw FileSystemException("Too many files for a content index");
+    }
+
+    // Invert the forward lists shard by shard
+    size_t shards = (count + kDocumentsPerShard - 1) / kDocumentsPerShard;
+    std::vector<detail::TrigramShard> partial(shards);
+    pool.parallelFor(shards, [&](size_t shard) {
+        std::vector<uint32_t> trigrams;
+        size_t end = std::min(count, (shard + 1) * kDocumentsPerShard);
+        for (size_t id = shard * kDocumentsPerShard; id < end; ++id) {
+            const std::string& forward = documents[id].forward;
+            const uint8_t* position = reinterpret_cast<const uint8_t*>(forward.data());
+            const uint8_t* finish = position + forward.size();
+            uint32_t trigram = 0;
+            while (position < finish) {
+                uint64_t delta;
+                position = detail::getVarint(position, finish, delta);
+                if (position == nullptr) {
+                    corrupt();
+                }
+                trigram += static_cast<uint32_t>(delta);
+                partial[shard][trigram].push_back(static_cast<uint32_t>(id));
+            }
+        }
+    });
+
+    std::string postings;
+    std::vector<TrigramEntry> table = detail::mergeTrigramShards(partial, [&](const std::vector<uint32_t>& ids) {
+        uint64_t offset = postings.size();
+        encodeDeltas(ids, postings);
+        return offset;
+    });
+
+    std::vector<uint64_t> pathOffsets{0};
+    std::vector<uint64_t> forwardOffsets{0};
+    std::string pathBytes;
+    std::string forwardBytes;
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> mtimes;
+    std::vector<uint8_t> flags;
+    for (const Document& document : documents) {
+        pathBytes += document.path;
+        pathOffsets.push_back(pathBytes.size());
+        forwardBytes += document.forward;
+        forwardOffsets.push_back(forwardBytes.size());
+        sizes.push_back(document.size);
+        mtimes.push_back(document.mtimeNs);
+        flags.push_back(document.flags);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = detail::kByteOrderMark;
+    header.documentCount = count;
+    header.trigramCount = table.size();
+
+    std::string out(sizeof(Header), '\0');
+    header.root = detail::appendSection(out, root.data(), root.size());
+    header.pathOffsets = detail::appendColumn(out, pathOffsets);
+    header.pathBytes = detail::appendSection(out, pathBytes.data(), pathBytes.size());
+    header.sizes = detail::appendColumn(out, sizes);
+    header.mtimes = detail::appendColumn(out, mtimes);
+    header.flags = detail::appendColumn(out, flags);
+    header.forwardOffsets = detail::appendColumn(out, forwardOffsets);
+    header.forwardBytes = detail::appendSection(out, forwardBytes.data(), forwardBytes.size());
+    header.trigrams = detail::appendColumn(out, table);
+    header.postings = detail::appendSection(out, postings.data(), postings.size());
+    std::memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+} // namespace
+
+struct ContentIndex::Block {
+    std::string owned;
+    std::unique_ptr<MappedFile> mapped;
+    const char* data = nullptr;
+    size_t length = 0;
+
+    std::string_view root;
+    size_t count = 0;
+    const uint64_t* pathOffsets = nullptr;
+    const char* pathBytes = nullptr;
+    uint64_t pathBytesLength = 0;
+    const uint64_t* sizes = nullptr;
+    const int64_t* mtimes = nullptr;
+    const uint8_t* flags = nullptr;
+    const uint64_t* forwardOffsets = nullptr;
+    const char* forwardBytes = nullptr;
+    uint64_t forwardBytesLength = 0;
+    size_t trigramCount = 0;
+    const TrigramEntry* trigrams = nullptr;
+    const uint8_t* postings = nullptr;
+    const uint8_t* postingsEnd = nullptr;
+
+    void attach(const char* bytes, size_t size) {
+        data = bytes;
+        length = size;
+        if (size < sizeof(Header)) {
+            corrupt();
+        }
+        Header header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            header.byteOrder != detail::kByteOrderMark || header.documentCount >= size ||
+            header.trigramCount > size) {
+            corrupt();
+        }
+        auto check = [&](const Section& section, uint64_t expected = UINT64_MAX) {
+            const char* result = detail::sectionData(bytes, size, section, expected);
+            if (result == nullptr) {
+                corrupt();
+            }
+            return result;
+        };
+        const uint64_t n = header.documentCount;
+        count = static_cast<size_t>(n);
+        root = std::string_view(check(header.root), static_cast<size_t>(header.root.length));
+        pathOffsets = reinterpret_cast<const uint64_t*>(check(header.pathOffsets, (n + 1) * 8));
+        pathBytes = check(header.pathBytes);
+        pathBytesLength = header.pathBytes.length;
+        sizes = reinterpret_cast<const uint64_t*>(check(header.sizes, n * 8));
+        mtimes = reinterpret_cast<const int64_t*>(check(header.mtimes, n * 8));
+        flags = reinterpret_cast<const uint8_t*>(check(header.flags, n));
+        forwardOffsets = reinterpret_cast<const uint64_t*>(check(header.forwardOffsets, (n + 1) * 8));
+        forwardBytes = check(header.forwardBytes);
+        forwardBytesLength = header.forwardBytes.length;
+        trigramCount = static_cast<size_t>(header.trigramCount);
+        trigrams = reinterpret_cast<const TrigramEntry*>(check(header.trigrams, header.trigramCount * 16));
+        postings = reinterpret_cast<const uint8_t*>(check(header.postings));
+        postingsEnd = postings + header.postings.length;
+    }
+
+    std::string_view path(size_t id) const {
+        uint64_t begin = pathOffsets[id];
+        uint64_t end = pathOffsets[id + 1];
+        if (begin > end || end > pathBytesLength) {
+            corrupt();
+        }
+        return std::string_view(pathBytes + begin, static_cast<size_t>(end - begin));
+    }
+
+    std::string_view forward(size_t id) const {
+        uint64_t begin = forwardOffsets[id];
+        uint64_t end = forwardOffsets[id + 1];
+        if (begin > end || end > forwardBytesLength) {
+            corrupt();
+        }
+        return std::string_view(forwardBytes + begin, static_cast<size_t>(end - begin));
+    }
+
+    size_t find(std::string_view relativePath) const {
+        size_t low = 0;
+        size_t high = count;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (path(middle) < relativePath) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low < count && path(low) == relativePath ? low : SIZE_MAX;
+    }
+
+    const TrigramEntry* findTrigram(uint32_t trigram) const {
+        const TrigramEntry* end = trigrams + trigramCount;
+        const TrigramEntry* found = std::lower_bound(
+            trigrams, end, trigram, [](const TrigramEntry& entry, uint32_t key) { return entry.trigram < key; });
+        if (found == end || found->trigram != trigram) {
+            return nullptr;
+        }
+        if (found->offset > static_cast<uint64_t>(postingsEnd - postings)) {
+            corrupt();
+        }
+        return found;
+    }
+};
+
+ContentIndex::ContentIndex(const Path& root, ContentIndexOptions options)
+    : m_root(root), m_options(options), m_block(new Block()) {
+    m_block->owned = serialize(m_root.toString(), {}, m_options.pool ? *m_options.pool : ThreadPool::io());
+    m_block->attach(m_block->owned.data(), m_block->owned.size());
+}
+
+ContentIndex::~ContentIndex() = default;
+ContentIndex::ContentIndex(ContentIndex&&) noexcept = default;
+ContentIndex& ContentIndex::operator=(ContentIndex&&) noexcept = default;
+
+size_t ContentIndex::size() const {
+    return m_block->count;
+}
+
+void ContentIndex::update() {
+    ThreadPool& pool = m_options.pool ? *m_options.pool : ThreadPool::io();
+    m_stats = ContentIndexStats();
+
+    WalkOptions walkOptions;
+    walkOptions.pool = &pool;
+    PathList entries = Walker(walkOptions).scan(m_root);
+
+    std::vector<Document> documents;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries.type(i) == EntryType::File) {
+            Document document;
+            entries.relativePathInto(i, document.path);
+            document.size = entries.fileSize(i);
+            document.mtimeNs = entries.mtime(i);
+            documents.push_back(std::move(document));
+        }
+    }
+    std::sort(documents.begin(), documents.end(),
+              [](const Document& a, const Document& b) { return a.path < b.path; });
+
+    // Carry over files whose size and mtime are unchanged
+    std::vector<size_t> changed;
+    for (size_t i = 0; i < documents.size(); ++i) {
+        Document& document = documents[i];
+        size_t old = m_block->find(document.path);
+        if (old != SIZE_MAX && m_block->sizes[old] == document.size && m_block->mtimes[old] == document.mtimeNs &&
+            !(m_block->flags[old] & kUnreadable)) {
+            document.flags = m_block->flags[old];
+            document.forward.assign(m_block->forward(old));
+            ++m_stats.filesReused;
+        } else {
+            changed.push_back(i);
+        }
+    }
+
+    std::atomic<size_t> indexed{0};
+    std::atomic<size_t> skipped{0};
+    std::atomic<uint64_t> bytesRead{0};
+    size_t tasks = (changed.size() + kFilesPerTask - 1) / kFilesPerTask;
+    pool.parallelFor(tasks, [&](size_t task) {
+        std::vector<uint64_t> seen(size_t(1) << 18, 0);
+        std::vector<uint32_t> trigrams;
+        size_t end = std::min(changed.size(), (task + 1) * kFilesPerTask);
+        for (size_t k = task * kFilesPerTask; k < end; ++k) {
+            Document& document = documents[changed[k]];
+            if (document.size > m_options.maxFileSize) {
+                document.flags = kNotIndexed;
+                ++skipped;
+                continue;
+            }
+            try {
+                MappedFile file(m_root / document.path);
+                std::string_view content = file.view();
+                size_t probe = std::min(content.size(), m_options.binaryProbeBytes);
+                if (std::memchr(content.data(), '\0', probe) != nullptr) {
+                    document.flags = kNotIndexed | kBinary;
+                    ++skipped;
+                    continue;
+                }
+                extractTrigrams(content, seen, trigrams);
+                encodeDeltas(trigrams, document.forward);
+                bytesRead += content.size();
+                ++indexed;
+            } catch (const FileSystemException&) {
+                document.flags = kNotIndexed | kUnreadable;
+                ++skipped;
+            }
+        }
+    });
+    m_stats.filesIndexed = indexed.load();
+    m_stats.filesSkipped = skipped.load();
+    m_stats.bytesRead = bytesRead.load();
+
+    std::unique_ptr<Block> block(new Block());
+    block->owned = serialize(m_root.toString(), documents, pool);
+    block->attach(block->owned.data(), block->owned.size());
+    m_block = std::move(block);
+}
+
+void ContentIndex::save(const Path& file) const {
+    detail::writeFileAtomically(file, std::string(m_block->data, m_block->length));
+}
+
+void ContentIndex::load(const Path& file) {
+    std::unique_ptr<Block> block(new Block());
+    block->mapped = std::make_unique<MappedFile>(file);
+    block->attach(block->mapped->data(), block->mapped->size());
+    if (block->root != m_root.toString()) {
+        throw FileSystemException("Content index belongs to another root: " + std::string(block->root));
+    }
+    m_block = std::move(block);
+}
+
+std::vector<Path> ContentIndex::candidates(std::string_view literal) const {
+    const Block& block = *m_block;
+    std::vector<uint32_t> ids;
+
+    if (literal.size() < 3) {
+        // No trigram to look up: every file that is not binary is a candidate
+        for (size_t id = 0; id < block.count; ++id) {
+            if (!(block.flags[id] & kBinary)) {
+                ids.push_back(static_cast<uint32_t>(id));
+            }
+        }
+    } else {
+        std::vector<uint32_t> trigrams;
+        detail::trigramsOf(literal, trigrams, [](char c) { return static_cast<uint8_t>(c); });
+        ids = detail::intersectTrigrams(
+            trigrams, [&](uint32_t trigram) { return block.findTrigram(trigram); },
+            [&](const TrigramEntry& entry, std::vector<uint32_t>& scratch) {
+                decodeDeltas(block.postings + entry.offset, block.postingsEnd, entry.count, scratch);
+                return scratch.data();
+            });
+
+        // Text files without trigrams cannot be ruled out; having no postings, they merge without duplicates
+        std::vector<uint32_t> unindexed;
+        for (size_t id = 0; id < block.count; ++id) {
+            if ((block.flags[id] & (kNotIndexed | kBinary)) == kNotIndexed) {
+                unindexed.push_back(static_cast<uint32_t>(id));
+            }
+        }
+        if (!unindexed.empty()) {
+            std::vector<uint32_t> merged;
+            merged.reserve(ids.size() + unindexed.size());
+            std::merge(ids.begin(), ids.end(), unindexed.begin(), unindexed.end(), std::back_inserter(merged));
+            ids.swap(merged);
+        }
+    }
+
+    std::vector<Path> result;
+    result.reserve(ids.size());
+    for (uint32_t id : ids) {
+        if (id >= block.count) {
+            corrupt();
+        }
+        result.push_back(m_root / block.path(id));
+    }
+    return result;
+}
+
+std::vector<SearchMatch> ContentIndex::search(std::string_view literal, SearchOptions options) const {
+    if (options.pool == nullptr) {
+        options.pool = m_options.pool;
+    }
+    // The trigrams only narrow the set; the search confirms real matches
+    return ContentSearch({std::string(literal)}, options).search(candidates(literal));
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,98 @@
+#ifndef CROSSDEV_CONTENT_INDEX_HPP
+#define CROSSDEV_CONTENT_INDEX_HPP
+
+#include "filesystem.hpp"
+#include "search.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Tuning for ContentIndex
+ */
+struct ContentIndexOptions {
+    /**
+     * Larger files are listed but their content is not indexed; they are
+     * searched directly by every query
+     */
+    uint64_t maxFileSize = 16 * 1024 * 1024;
+    /** Files with a NUL byte in their first binaryProbeBytes are not indexed */
+    size_t binaryProbeBytes = 8192;
+    /** Pool used to read and index files; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+/**
+ * Counters describing the last update()
+ */
+struct ContentIndexStats {
+    size_t filesIndexed = 0;
+    size_t filesReused = 0;
+    /** Binary, oversized or unreadable files */
+    size_t filesSkipped = 0;
+    uint64_t bytesRead = 0;
+};
+
+/**
+ * Persistent trigram index over the contents of the files below a root.
+ *
+ * For every file the index keeps its size, mtime and sorted set of byte
+ * trigrams; for every trigram it keeps the ids of the files containing
+ * it. Both lists are delta-encoded as LEB128 varints. A literal query
+ * intersects the posting lists of its trigrams and then searches only
+ * the candidate files, so its cost follows the number of plausible files
+ * rather than the size of the tree.
+ *
+ * update() walks the root and reads only files that are new or whose size
+ * or mtime changed, or that could not be read last time; the trigram sets
+ * of all other files are carried over. Files that are too large or could
+ * not be read have no trigrams, so they are candidates for every query;
+ * only binary files are never searched.
+ * save() writes the index as a single block that load() maps back in
+ * place. Matching is byte-exact (case-sensitive).
+ */
+class ContentIndex {
+public:
+    explicit ContentIndex(const Path& root, ContentIndexOptions options = ContentIndexOptions());
+    ~ContentIndex();
+    ContentIndex(ContentIndex&&) noexcept;
+    ContentIndex& operator=(ContentIndex&&) noexcept;
+
+    /** Bring the index in line with the tree, re-reading changed files only */
+    void update();
+
+    void save(const Path& file) const;
+    /** Map an index saved for the same root; throws if the file is invalid */
+    void load(const Path& file);
+
+    /** Number of files known to the index, indexed or not */
+    size_t size() const;
+    const ContentIndexStats& stats() const { return m_stats; }
+
+    /** Files that may contain literal, without reading any of them */
+    std::vector<Path> candidates(std::string_view literal) const;
+    /** Matches of literal, searching only the candidate files */
+    std::vector<SearchMatch> search(std::string_view literal, SearchOptions options = SearchOptions()) const;
+
+private:
+    struct Block;
+
+    Path m_root;
+    ContentIndexOptions m_options;
+    std::unique_ptr<Block> m_block;
+    ContentIndexStats m_stats;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_CONTENT_INDEX_HPP
@@ -0,0 +1,229 @@
+#include "dedup.hpp"
+#include "hash.hpp"
+#include "thread_pool.hpp"
+#include "walker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+struct Candidate {
+    size_t index;
+    uint64_t size;
+    uint64_t hash = 0;
+    bool readable = true;
+};
+
+bool readAt(std::ifstream& file, uint64_t offset, std::vector<char>& buffer, size_t length) {
+    buffer.resize(length);
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(buffer.data(), static_cast<std::streamsize>(length));
+    return static_cast<size_t>(file.gcount()) == length;
+}
+
+uint64_t hashEdges(const Path& path, uint64_t size, size_t edgeBytes, bool& readable, std::atomic<uint64_t>& bytesRead) {
+    std::ifstream file(path.toString(), std::ios::binary);
+    std::vector<char> buffer;
+    Hasher64 hasher;
+
+    size_t head = static_cast<size_t>(std::min<uint64_t>(size, edgeBytes));
+    if (!file || !readAt(file, 0, buffer, head)) {
+        readable = false;
+        return 0;
+    }
+    hasher.update(buffer.data(), head);
+    bytesRead += head;
+
+    if (size > head) {
+        size_t tail = static_cast<size_t>(std::min<uint64_t>(size - head, edgeBytes));
+        if (!readAt(file, size - tail, buffer, tail)) {
+            readable = false;
+            return 0;
+        }
+        hasher.update(buffer.data(), tail);
+        bytesRead += tail;
+    }
+    return hasher.digest();
+}
+
+uint64_t hashContent(const Path& path, bool& readable, std::atomic<uint64_t>& bytesRead) {
+    std::ifstream file(path.toString(), std::ios::binary);
+    if (!file) {
+        readable = false;
+        return 0;
+    }
+    std::vector<char> buffer(1 << 16);
+    Hasher64 hasher;
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize got = file.gcount();
+        if (got <= 0) {
+            break;
+        }
+        hasher.update(buffer.data(), static_cast<size_t>(got));
+        bytesRead += static_cast<uint64_t>(got);
+    }
+    return hasher.digest();
+}
+
+// Split candidates into groups of equal (size, hash), dropping singletons
+std::vector<std::vector<Candidate>> collide(const std::vector<Candidate>& candidates) {
+    std::map<std::pair<uint64_t, uint64_t>, std::vector<Candidate>> groups;
+    for (const Candidate& candidate : candidates) {
+        if (candidate.readable) {
+            groups[{candidate.size, candidate.hash}].push_back(candidate);
+        }
+    }
+    std::vector<std::vector<Candidate>> result;
+    for (auto& entry : groups) {
+        if (entry.second.size() > 1) {
+            result.push_back(std::move(entry.second));
+        }
+    }
+    return result;
+}
+
+} // namespace
+
+DuplicateFinder::DuplicateFinder(DuplicateOptions options) : m_options(options) {}
+
+std::vector<DuplicateGroup> DuplicateFinder::find(const Path& root) {
+    m_stats = DuplicateStats();
+
+    // Stage 1 straight from the walk metadata: no per-file stat or Path
+    WalkOptions walkOptions;
+    walkOptions.pool = m_options.pool;
+    PathList entries = Walker(walkOptions).scan(root);
+
+    std::unordered_map<uint64_t, std::vector<uint32_t>> bySize;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries.type(i) != EntryType::File) {
+            continue;
+        }
+        ++m_stats.filesScanned;
+        uint64_t size = entries.fileSize(i);
+        if (size >= m_options.minSize && size > 0) {
+            bySize[size].push_back(static_cast<uint32_t>(i));
+        }
+    }
+
+    // Only files sharing a size are ever materialised as Paths
+    std::vector<Path> files;
+    std::vector<uint64_t> sizes;
+    for (const auto& entry : bySize) {
+        if (entry.second.size() > 1) {
+            for (uint32_t index : entry.second) {
+                files.push_back(entries.path(index));
+                sizes.push_back(entry.first);
+            }
+        }
+    }
+    return hashStages(files, sizes);
+}
+
+std::vector<DuplicateGroup> DuplicateFinder::find(const std::vector<Path>& files) {
+    m_stats = DuplicateStats();
+
+    // Stage 1: group by size without touching content
+    std::vector<uint64_t> sizes(files.size(), 0);
+    std::unordered_map<uint64_t, size_t> sizeCounts;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!files[i].isFile()) {
+            continue;
+        }
+        ++m_stats.filesScanned;
+        try {
+            sizes[i] = File(files[i]).size();
+        } catch (const FileSystemException&) {
+            continue;
+        }
+        if (sizes[i] >= m_options.minSize && sizes[i] > 0) {
+            ++sizeCounts[sizes[i]];
+        }
+    }
+
+    std::vector<Path> candidates;
+    std::vector<uint64_t> candidateSizes;
+    for (size_t i = 0; i < files.size(); ++i) {
+        auto found = sizeCounts.find(sizes[i]);
+        if (sizes[i] > 0 && found != sizeCounts.end() && found->second > 1) {
+            candidates.push_back(files[i]);
+            candidateSizes.push_back(sizes[i]);
+        }
+    }
+    return hashStages(candidates, candidateSizes);
+}
+
+std::vector<DuplicateGroup> DuplicateFinder::hashStages(const std::vector<Path>& files,
+                                                        const std::vector<uint64_t>& sizes) {
+    ThreadPool& pool = m_options.pool ? *m_options.pool : ThreadPool::io();
+    std::atomic<uint64_t> bytesRead{0};
+
+    std::vector<Candidate> candidates;
+    candidates.reserve(files.size());
+    for (size_t i = 0; i < files.size(); ++i) {
+        candidates.push_back({i, sizes[i]});
+    }
+    m_stats.sizeCandidates = candidates.size();
+
+    // Stage 2: hash the first and last edgeBytes of each candidate
+    pool.parallelFor(candidates.size(), [&](size_t i) {
+        Candidate& candidate = candidates[i];
+        candidate.hash = hashEdges(files[candidate.index], candidate.size, m_options.edgeBytes,
+                                   candidate.readable, bytesRead);
+    });
+
+    std::vector<std::vector<Candidate>> edgeGroups = collide(candidates);
+    std::vector<Candidate*> needFullHash;
+    for (auto& group : edgeGroups) {
+        m_stats.edgeCandidates += group.size();
+        // Edges cover the whole file, so the edge hash is already a content hash
+        if (group.front().size > 2 * static_cast<uint64_t>(m_options.edgeBytes)) {
+            for (Candidate& candidate : group) {
+                needFullHash.push_back(&candidate);
+            }
+        }
+    }
+    m_stats.fullyHashed = needFullHash.size();
+
+    // Stage 3: full content hash of the survivors
+    pool.parallelFor(needFullHash.size(), [&](size_t i) {
+        Candidate& candidate = *needFullHash[i];
+        candidate.hash = hashContent(files[candidate.index], candidate.readable, bytesRead);
+    });
+
+    std::vector<DuplicateGroup> result;
+    for (const auto& group : edgeGroups) {
+        for (const auto& confirmed : collide(group)) {
+            DuplicateGroup duplicate;
+            duplicate.size = confirmed.front().size;
+            for (const Candidate& candidate : confirmed) {
+                duplicate.files.push_back(files[candidate.index]);
+            }
+            std::sort(duplicate.files.begin(), duplicate.files.end(),
+                      [](const Path& a, const Path& b) { return a.toString() < b.toString(); });
+            result.push_back(std::move(duplicate));
+        }
+    }
+
+    std::sort(result.begin(), result.end(), [](const DuplicateGroup& a, const DuplicateGroup& b) {
+        if (a.size != b.size) {
+            return a.size > b.size;
+        }
+        return a.files.front().toString() < b.files.front().toString();
+    });
+
+    m_stats.bytesRead = bytesRead.load();
+    return result;
+}
+
+} // namespace fs
+} // namespace crossdev
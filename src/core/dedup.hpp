@@ -0,0 +1,76 @@
+#ifndef CROSSDEV_DEDUP_HPP
+#define CROSSDEV_DEDUP_HPP
+
+#include "filesystem.hpp"
+
+#include <cstdint>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * A set of files with identical content
+ */
+struct DuplicateGroup {
+    uint64_t size = 0;
+    std::vector<Path> files;
+};
+
+/**
+ * Tuning for DuplicateFinder
+ */
+struct DuplicateOptions {
+    /** Bytes hashed from each end of a file in the second stage */
+    size_t edgeBytes = 4096;
+    /** Files smaller than this are ignored (empty files are never reported) */
+    uint64_t minSize = 1;
+    /** Pool used for hashing; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+/**
+ * Counters describing how much work each stage pruned
+ */
+struct DuplicateStats {
+    size_t filesScanned = 0;
+    size_t sizeCandidates = 0;
+    size_t edgeCandidates = 0;
+    size_t fullyHashed = 0;
+    uint64_t bytesRead = 0;
+};
+
+/**
+ * Staged duplicate file detector.
+ *
+ * 1. Files are grouped by size; unique sizes are dropped without reading.
+ * 2. Same-size files are hashed over their first and last edgeBytes.
+ * 3. Only files that still collide are hashed in full, in parallel.
+ *
+ * Files no larger than two edges are fully covered by stage 2 and skip
+ * stage 3. Content is compared by 64-bit hash, not byte-for-byte.
+ */
+class DuplicateFinder {
+public:
+    explicit DuplicateFinder(DuplicateOptions options = DuplicateOptions());
+
+    std::vector<DuplicateGroup> find(const Path& root);
+    std::vector<DuplicateGroup> find(const std::vector<Path>& files);
+
+    const DuplicateStats& stats() const { return m_stats; }
+
+private:
+    // Stages 2 and 3 over files already known to share their size
+    std::vector<DuplicateGroup> hashStages(const std::vector<Path>& files, const std::vector<uint64_t>& sizes);
+
+    DuplicateOptions m_options;
+    DuplicateStats m_stats;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_DEDUP_HPP
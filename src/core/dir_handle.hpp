@@ -0,0 +1,118 @@
+#ifndef CROSSDEV_DIR_HANDLE_HPP
+#define CROSSDEV_DIR_HANDLE_HPP
+
+#include "filesystem.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/types.h>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Metadata returned by DirHandle::statAt()
+ */
+struct FileStatus {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    int64_t ctimeNs = 0;
+    uint32_t mode = 0;
+
+    bool isDirectory() const;
+    bool isFile() const;
+    bool isSymlink() const;
+};
+
+/**
+ * Open directory (O_DIRECTORY descriptor) used as the base for relative
+ * *at() system calls.
+ *
+ * Operations on entries take a name relative to this directory, so the
+ * kernel resolves one component instead of walking the full path each
+ * time. Available on POSIX platforms only.
+ */
+class DirHandle {
+public:
+    explicit DirHandle(const Path& path);
+    ~DirHandle();
+
+    DirHandle(DirHandle&& other) noexcept;
+    DirHandle& operator=(DirHandle&& other) noexcept;
+    DirHandle(const DirHandle&) = delete;
+    DirHandle& operator=(const DirHandle&) = delete;
+
+    int fd() const { return m_fd; }
+    const Path& path() const { return m_path; }
+
+    /** Open a subdirectory relative to this one */
+    DirHandle openDirectory(std::string_view name) const;
+
+    /** openat(); the caller owns the returned descriptor */
+    int openAt(std::string_view name, int flags, mode_t mode = 0666) const;
+
+    FileStatus statAt(std::string_view name, bool followSymlinks = false) const;
+    bool existsAt(std::string_view name) const;
+
+    void mkdirAt(std::string_view name, mode_t mode = 0755) const;
+    void unlinkAt(std::string_view name) const;
+    void removeDirectoryAt(std::string_view name) const;
+    void renameAt(std::string_view name, const DirHandle& target, std::string_view newName) const;
+
+    /** Names of the entries, excluding "." and ".." */
+    std::vector<std::string> list() const;
+
+    /** Recursively delete an entry without following symlinks */
+    void removeTreeAt(std::string_view name) const;
+
+private:
+    DirHandle(int fd, Path path) : m_fd(fd), m_path(std::move(path)) {}
+
+    int m_fd = -1;
+    Path m_path;
+};
+
+/**
+ * Thread-safe LRU cache of open directory handles.
+ *
+ * A miss whose parent directory is cached is opened with openat() relative
+ * to the parent. The capacity defaults to a quarter of the RLIMIT_NOFILE
+ * soft limit so the cache cannot exhaust the descriptor table. Evicted
+ * handles stay open until the last shared_ptr to them is released.
+ */
+class DirHandleCache {
+public:
+    explicit DirHandleCache(size_t capacity = 0);
+
+    std::shared_ptr<const DirHandle> get(const Path& directory);
+
+    size_t size() const;
+    size_t capacity() const { return m_capacity; }
+    void clear();
+
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const DirHandle>>;
+
+    size_t m_capacity;
+    std::list<Entry> m_lru;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> m_index;
+    mutable std::mutex m_mutex;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
+
+#endif // CROSSDEV_DIR_HANDLE_HPP
@@ -0,0 +1,264 @@
+#include "dir_handle.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// NUL-terminated copy of a name for the system call interface; short
+// names (the common case) stay on the stack
+class CName {
+public:
+    explicit CName(std::string_view name) {
+        if (name.size() < sizeof(m_small)) {
+            std::copy(name.begin(), name.end(), m_small);
+            m_small[name.size()] = '\0';
+            m_ptr = m_small;
+        } else {
+            m_large.assign(name.data(), name.size());
+            m_ptr = m_large.c_str();
+        }
+    }
+    const char* c_str() const { return m_ptr; }
+
+private:
+    char m_small[256];
+    std::string m_large;
+    const char* m_ptr;
+};
+
+int64_t toNanoseconds(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+FileStatus toStatus(const struct stat& st) {
+    FileStatus status;
+    status.device = static_cast<uint64_t>(st.st_dev);
+    status.inode = static_cast<uint64_t>(st.st_ino);
+    status.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    status.mtimeNs = toNanoseconds(st.st_mtimespec);
+    status.ctimeNs = toNanoseconds(st.st_ctimespec);
+#else
+    status.mtimeNs = toNanoseconds(st.st_mtim);
+    status.ctimeNs = toNanoseconds(st.st_ctim);
+#endif
+    status.mode = static_cast<uint32_t>(st.st_mode);
+    return status;
+}
+
+} // namespace
+
+bool FileStatus::isDirectory() const {
+    return S_ISDIR(mode);
+}
+
+bool FileStatus::isFile() const {
+    return S_ISREG(mode);
+}
+
+bool FileStatus::isSymlink() const {
+    return S_ISLNK(mode);
+}
+
+// DirHandle implementation
+DirHandle::DirHandle(const Path& path)
+    : m_fd(::open(path.toString().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)), m_path(path) {
+    if (m_fd < 0) {
+        throw FileSystemException("Could not open directory");
+    }
+}
+
+DirHandle::~DirHandle() {
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+DirHandle::DirHandle(DirHandle&& other) noexcept : m_fd(other.m_fd), m_path(std::move(other.m_path)) {
+    other.m_fd = -1;
+}
+
+DirHandle& DirHandle::operator=(DirHandle&& other) noexcept {
+    if (this != &other) {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+        m_fd = other.m_fd;
+        m_path = std::move(other.m_path);
+        other.m_fd = -1;
+    }
+    return *this;
+}
+
+DirHandle DirHandle::openDirectory(std::string_view name) const {
+    int fd = ::openat(m_fd, CName(name).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw FileSystemException("Could not open directory");
+    }
+    return DirHandle(fd, m_path / name);
+}
+
+int DirHandle::openAt(std::string_view name, int flags, mode_t mode) const {
+    int fd = ::openat(m_fd, CName(name).c_str(), flags | O_CLOEXEC, mode);
+    if (fd < 0) {
+        throw FileSystemException("Could not open file");
+    }
+    return fd;
+}
+
+FileStatus DirHandle::statAt(std::string_view name, bool followSymlinks) const {
+    struct stat st;
+    if (::fstatat(m_fd, CName(name).c_str(), &st, followSymlinks ? 0 : AT_SYMLINK_NOFOLLOW) != 0) {
+        throw FileSystemException("Could not get file status");
+    }
+    return toStatus(st);
+}
+
+bool DirHandle::existsAt(std::string_view name) const {
+    struct stat st;
+    return ::fstatat(m_fd, CName(name).c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0;
+}
+
+void DirHandle::mkdirAt(std::string_view name, mode_t mode) const {
+    if (::mkdirat(m_fd, CName(name).c_str(), mode) != 0 && errno != EEXIST) {
+        throw FileSystemException("Could not create directory");
+    }
+}
+
+void DirHandle::unlinkAt(std::string_view name) const {
+    if (::unlinkat(m_fd, CName(name).c_str(), 0) != 0) {
+        throw FileSystemException("Could not delete file");
+    }
+}
+
+void DirHandle::removeDirectoryAt(std::string_view name) const {
+    if (::unlinkat(m_fd, CName(name).c_str(), AT_REMOVEDIR) != 0) {
+        throw FileSystemException("Could not remove directory");
+    }
+}
+
+void DirHandle::renameAt(std::string_view name, const DirHandle& target, std::string_view newName) const {
+    if (::renameat(m_fd, CName(name).c_str(), target.m_fd, CName(newName).c_str()) != 0) {
+        throw FileSystemException("Could not move file");
+    }
+}
+
+std::vector<std::string> DirHandle::list() const {
+    std::vector<std::string> names;
+
+    // fdopendir takes ownership of its descriptor, so give it a duplicate
+    int fd = ::openat(m_fd, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        throw FileSystemException("Could not open directory");
+    }
+    DIR* dir = ::fdopendir(fd);
+    if (dir == nullptr) {
+        ::close(fd);
+        throw FileSystemException("Could not open directory");
+    }
+
+    while (struct dirent* entry = ::readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+        names.emplace_back(name);
+    }
+    ::closedir(dir);
+    return names;
+}
+
+void DirHandle::removeTreeAt(std::string_view name) const {
+    if (!statAt(name).isDirectory()) {
+        unlinkAt(name);
+        return;
+    }
+    {
+        DirHandle child = openDirectory(name);
+        for (const std::string& entry : child.list()) {
+            child.removeTreeAt(entry);
+        }
+    }
+    removeDirectoryAt(name);
+}
+
+// DirHandleCache implementation
+DirHandleCache::DirHandleCache(size_t capacity) : m_capacity(capacity) {
+    if (m_capacity == 0) {
+        struct rlimit limit;
+        rlim_t soft = 1024;
+        if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+            soft = limit.rlim_cur;
+        }
+        m_capacity = std::max<size_t>(static_cast<size_t>(soft / 4), 1);
+    }
+}
+
+std::shared_ptr<const DirHandle> DirHandleCache::get(const Path& directory) {
+    std::string_view key = directory.view();
+    std::shared_ptr<const DirHandle> parent;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto found = m_index.find(key);
+        if (found != m_index.end()) {
+            m_lru.splice(m_lru.begin(), m_lru, found->second);
+            return found->second->second;
+        }
+        auto parentFound = m_index.find(directory.parent().view());
+        if (parentFound != m_index.end()) {
+            parent = parentFound->second->second;
+        }
+    }
+
+    // Open outside the lock; a racing open of the same path is harmless
+    std::shared_ptr<const DirHandle> handle;
+    std::string name = directory.filename();
+    if (parent && !name.empty() && name != "." && name != "..") {
+        handle = std::make_shared<const DirHandle>(parent->openDirectory(name));
+    } else {
+        handle = std::make_shared<const DirHandle>(directory);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto found = m_index.find(key);
+    if (found != m_index.end()) {
+        m_lru.splice(m_lru.begin(), m_lru, found->second);
+        return found->second->second;
+    }
+    m_lru.emplace_front(directory.toString(), handle);
+    m_index.emplace(m_lru.front().first, m_lru.begin());
+    while (m_lru.size() > m_capacity) {
+        m_index.erase(m_lru.back().first);
+        m_lru.pop_back();
+    }
+    return handle;
+}
+
+size_t DirHandleCache::size() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_lru.size();
+}
+
+void DirHandleCache::clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_index.clear();
+    m_lru.clear();
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
@@ -0,0 +1,83 @@
+#include "file_id.hpp"
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+bool isZero(const FileId& id) {
+    return id.device == 0 && id.inode == 0;
+}
+
+uint64_t mix(const FileId& id) {
+    // Inode numbers are often sequential: fold the device in, then avalanche
+    uint64_t h = id.inode ^ (id.device * 0x9E3779B97F4A7C15ULL);
+    h ^= h >> 33;
+    h *= 0xFF51AFD7ED558CCDULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+size_t FileIdSet::slotFor(const FileId& id) const {
+    size_t mask = m_slots.size() - 1;
+    size_t slot = static_cast<size_t>(mix(id)) & mask;
+    while (!isZero(m_slots[slot]) && m_slots[slot] != id) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+bool FileIdSet::insert(const FileId& id) {
+    if (isZero(id)) {
+        if (m_hasZero) {
+            return false;
+        }
+        m_hasZero = true;
+        ++m_size;
+        return true;
+    }
+
+    // Keep the load factor at or below one half
+    if ((m_size + 1) * 2 > m_slots.size()) {
+        grow();
+    }
+    size_t slot = slotFor(id);
+    if (!isZero(m_slots[slot])) {
+        return false;
+    }
+    m_slots[slot] = id;
+    ++m_size;
+    return true;
+}
+
+bool FileIdSet::contains(const FileId& id) const {
+    if (isZero(id)) {
+        return m_hasZero;
+    }
+    if (m_slots.empty()) {
+        return false;
+    }
+    return !isZero(m_slots[slotFor(id)]);
+}
+
+void FileIdSet::clear() {
+    m_slots.clear();
+    m_size = 0;
+    m_hasZero = false;
+}
+
+void FileIdSet::grow() {
+    std::vector<FileId> previous;
+    previous.swap(m_slots);
+    m_slots.assign(previous.empty() ? 64 : previous.size() * 2, FileId());
+    for (const FileId& id : previous) {
+        if (!isZero(id)) {
+            m_slots[slotFor(id)] = id;
+        }
+    }
+}
+
+} // namespace fs
+} // namespace crossdev
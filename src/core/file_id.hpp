@@ -0,0 +1,56 @@
+#ifndef CROSSDEV_FILE_ID_HPP
+#define CROSSDEV_FILE_ID_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Identity of a file on its device: (st_dev, st_ino) on POSIX,
+ * (volume serial, file index) on Windows
+ */
+struct FileId {
+    uint64_t device = 0;
+    uint64_t inode = 0;
+
+    bool operator==(const FileId& other) const { return device == other.device && inode == other.inode; }
+    bool operator!=(const FileId& other) const { return !(*this == other); }
+};
+
+/**
+ * Open-addressing hash set of FileIds used to detect directories that
+ * have already been visited.
+ *
+ * Keys live inline in one flat table probed linearly, so a membership
+ * test touches a single cache line in the common case and the set costs
+ * 16 bytes per slot with no per-entry allocation.
+ */
+class FileIdSet {
+public:
+    FileIdSet() = default;
+
+    /** Add id; returns false if it was already present */
+    bool insert(const FileId& id);
+    bool contains(const FileId& id) const;
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    void clear();
+
+private:
+    size_t slotFor(const FileId& id) const;
+    void grow();
+
+    // (0, 0) marks an empty slot; a real (0, 0) id is tracked separately
+    std::vector<FileId> m_slots;
+    size_t m_size = 0;
+    bool m_hasZero = false;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_FILE_ID_HPP
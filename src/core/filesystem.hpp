@@ -2,11 +2,18 @@
 #define CROSSDEV_FILESYSTEM_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 #include <memory>
+#include <cstdint>
+#include <iterator>
+#include <system_error>
 
 namespace crossdev {
+
+class ThreadPool;
+
 namespace fs {
 
 /**
@@ -22,26 +29,245 @@ public:
  */
 class Path {
 public:
+    class ComponentIterator;
+    class ComponentRange;
+
     Path(const std::string& path);
+    /** Adopts the string's buffer; separators are normalized in place */
+    Path(std::string&& path);
+    Path(std::string_view path);
+    Path(const char* path);
     
     std::string toString() const;
     std::string getNative() const;
+    /** The stored path without a copy; valid while the Path is unchanged */
+    std::string_view view() const { return m_path; }
     bool exists() const;
     bool isDirectory() const;
     bool isFile() const;
+    bool isAbsolute() const;
     Path parent() const;
     std::string filename() const;
     std::string extension() const;
-    
+
+    /**
+     * Append a component in place, inserting a separator when needed.
+     * An absolute component replaces the whole path.
+     */
+    Path& append(std::string_view component);
+    Path& operator/=(std::string_view component) { return append(component); }
+
+    /** Collapse ".", ".." and repeated separators in place, lexically */
+    Path& normalize();
+    Path lexicallyNormal() const;
+
+    /**
+     * This path expressed relative to base, lexically (no filesystem
+     * access). Empty when one path is absolute and the other is not.
+     * The second form writes into a caller-owned buffer so its capacity
+     * can be reused.
+     */
+    Path relativeTo(const Path& base) const;
+    void relativeTo(const Path& base, std::string& out) const;
+
+    /**
+     * Range over the components as string_views into this path. An
+     * absolute path yields its root first; empty components are skipped.
+     */
+    ComponentRange components() const;
+
     static Path tempDirectory();
     static Path homeDirectory();
     static Path currentDirectory();
     static char separator();
+
+    friend Path operator/(const Path& lhs, std::string_view rhs);
+    friend Path operator/(Path&& lhs, std::string_view rhs);
     
 private:
+    struct NativeTag {};
+    // Adopts a string that is already in native form
+    Path(std::string&& native, NativeTag) : m_path(std::move(native)) {}
+
+    // Convert separators to the native form and trim a trailing separator
+    void canonicalize();
+
     std::string m_path;
 };
 
+class Path::ComponentIterator {
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::string_view;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const std::string_view*;
+    using reference = const std::string_view&;
+
+    ComponentIterator() = default;
+
+    reference operator*() const { return m_current; }
+    pointer operator->() const { return &m_current; }
+    ComponentIterator& operator++();
+    ComponentIterator operator++(int) {
+        ComponentIterator previous = *this;
+        ++*this;
+        return previous;
+    }
+
+    bool operator==(const ComponentIterator& other) const { return m_current.data() == other.m_current.data(); }
+    bool operator!=(const ComponentIterator& other) const { return !(*this == other); }
+
+private:
+    friend class Path::ComponentRange;
+    ComponentIterator(std::string_view path, size_t position);
+
+    std::string_view m_path;
+    std::string_view m_current;
+};
+
+class Path::ComponentRange {
+public:
+    explicit ComponentRange(std::string_view path) : m_path(path) {}
+
+    ComponentIterator begin() const { return ComponentIterator(m_path, 0); }
+    ComponentIterator end() const { return ComponentIterator(m_path, m_path.size()); }
+
+private:
+    std::string_view m_path;
+};
+
+Path operator/(const Path& lhs, std::string_view rhs);
+Path operator/(Path&& lhs, std::string_view rhs);
+
+/**
+ * How bulk transfers interact with the OS page cache.
+ *
+ * Direct bypasses the cache (O_DIRECT / F_NOCACHE) so that large streaming
+ * jobs do not evict data other processes rely on. Where the filesystem
+ * does not support it (e.g. tmpfs) the transfer silently falls back to
+ * buffered I/O.
+ */
+enum class IoMode {
+    Buffered,
+    Direct
+};
+
+/**
+ * Expected access pattern, passed to the kernel as advice.
+ *
+ * Sequential and Random tune read-ahead, WillNeed prefetches into the page
+ * cache, and DontNeed evicts pages that will not be touched again.
+ */
+enum class AccessHint {
+    Normal,
+    Sequential,
+    Random,
+    WillNeed,
+    DontNeed
+};
+
+/**
+ * Single-pass range over the lines of a file.
+ *
+ * Lines are yielded as string_views into a sliding read buffer, without
+ * their "\n" or "\r\n" terminator. A view stays valid until the iterator
+ * is advanced. Lines longer than the buffer grow it, so they are always
+ * delivered intact.
+ */
+class LineRange {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::string_view*;
+        using reference = const std::string_view&;
+
+        iterator() = default;
+
+        reference operator*() const { return m_line; }
+        pointer operator->() const { return &m_line; }
+        iterator& operator++();
+        void operator++(int) { ++*this; }
+
+        bool operator==(const iterator& other) const { return m_range == other.m_range; }
+        bool operator!=(const iterator& other) const { return m_range != other.m_range; }
+
+    private:
+        friend class LineRange;
+        explicit iterator(LineRange* range);
+
+        LineRange* m_range = nullptr;
+        std::string_view m_line;
+    };
+
+    LineRange(const Path& path, size_t bufferSize);
+    ~LineRange();
+
+    LineRange(LineRange&& other) noexcept;
+    LineRange& operator=(LineRange&& other) noexcept;
+    LineRange(const LineRange&) = delete;
+    LineRange& operator=(const LineRange&) = delete;
+
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+
+    /** Read the next line into line; false at end of file */
+    bool next(std::string_view& line);
+
+private:
+    bool refill();
+
+    struct State;
+    std::unique_ptr<State> m_state;
+};
+
+/**
+ * Outcome for one file of File::readMany()
+ */
+struct ReadResult {
+    /** Contents, viewing the batch's arena; empty on error */
+    std::string_view data;
+    /** Why the file could not be read; false (no error) on success */
+    std::error_code error;
+};
+
+/**
+ * Contents of many files held in one arena allocation, in request order.
+ * Views stay valid for the lifetime of the batch.
+ */
+class ReadBatch {
+public:
+    size_t size() const { return m_results.size(); }
+    const ReadResult& operator[](size_t index) const { return m_results[index]; }
+    std::vector<ReadResult>::const_iterator begin() const { return m_results.begin(); }
+    std::vector<ReadResult>::const_iterator end() const { return m_results.end(); }
+
+    /** Bytes allocated for the contents */
+    size_t arenaSize() const { return m_arenaSize; }
+    /** True if the batch was read through io_uring rather than the thread pool */
+    bool usedIoUring() const { return m_usedIoUring; }
+
+private:
+    friend class File;
+
+    std::unique_ptr<char[]> m_arena;
+    size_t m_arenaSize = 0;
+    std::vector<ReadResult> m_results;
+    bool m_usedIoUring = false;
+};
+
+/**
+ * Tuning for File::readMany()
+ */
+struct ReadManyOptions {
+    /** Use io_uring where the kernel supports it; otherwise the pool */
+    bool allowIoUring = true;
+    /** Pool for the fallback path; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
 /**
  * File operations
  */
@@ -53,14 +279,63 @@ public:
     size_t size() const;
     std::string readAsText() const;
     std::vector<uint8_t> readAsBinary() const;
+    LineRange lines(size_t bufferSize = 64 * 1024) const;
     void writeText(const std::string& content);
     void writeBinary(const std::vector<uint8_t>& content);
     void copy(const Path& destination);
     void move(const Path& destination);
     void remove();
+
+    /**
+     * Preallocate disk space for the first bytes of the file, creating it
+     * if needed. With keepSize the reported length is left unchanged.
+     * writeBinary() and copy() already preallocate on their own.
+     * Throws if the device does not have enough space; filesystems that
+     * cannot preallocate ignore the request.
+     */
+    void reserve(uint64_t bytes, bool keepSize = false);
+
+    /**
+     * Read many whole files at once into a single arena.
+     *
+     * All sizes are looked up first, on a thread pool, so the arena is
+     * allocated once; then every file is opened, read and closed. On
+     * Linux that runs as linked open -> read -> close chains on one
+     * io_uring, one syscall per hundred files; elsewhere, when io_uring
+     * is unavailable, or when the ring fails part-way, it is spread over
+     * the pool as well. A file that grows in between is read up to its
+     * size at lookup. Failures are reported per file and never thrown.
+     */
+    static ReadBatch readMany(const std::vector<Path>& paths, ReadManyOptions options = ReadManyOptions());
+
+    /**
+     * I/O mode used by readAsBinary() and writeBinary(). On Windows those
+     * stay buffered (see FileWriter), and Direct makes copy() unbuffered
+     * instead.
+     */
+    void setIoMode(IoMode mode) { m_ioMode = mode; }
+    IoMode ioMode() const { return m_ioMode; }
+
+    /**
+     * Advise the kernel about [offset, offset + length) of this file right
+     * now; length 0 means to the end. Useful for WillNeed (prefetch) and
+     * DontNeed (evict).
+     */
+    void advise(AccessHint hint, uint64_t offset = 0, uint64_t length = 0) const;
+
+    /**
+     * Hint applied by readAsBinary(), writeBinary() and copy() to the
+     * descriptors they open. DontNeed drops pages from the cache as soon
+     * as they have been read or written out. POSIX only, except that on
+     * Windows DontNeed makes copy() unbuffered.
+     */
+    void setAccessHint(AccessHint hint) { m_accessHint = hint; }
+    AccessHint accessHint() const { return m_accessHint; }
     
 private:
     Path m_path;
+    IoMode m_ioMode = IoMode::Buffered;
+    AccessHint m_accessHint = AccessHint::Normal;
 };
 
 /**
@@ -1,10 +1,17 @@
 #include "filesystem.hpp"
+#include "dir_handle.hpp"
+#include "file_id.hpp"
+#include "simd.hpp"
+#include "stream.hpp"
+#include "unix_io.hpp"
 
 #if defined(__unix__) || defined(__APPLE__)
 
 #include <sys/stat.h>
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <cerrno>
 #include <fstream>
 #include <sstream>
 #include <cstdlib>
@@ -15,10 +22,71 @@
 namespace crossdev {
 namespace fs {
 
+namespace {
+
+using detail::FileDescriptor;
+
+const size_t kCopyBufferSize = 1 << 20;
+
+// Copy [offset, offset + length) between descriptors at the same offsets.
+// The destination range is preallocated first so a large copy fails fast
+// on a full device. With dropBehind set, source pages are evicted once
+// read and destination pages once written out.
+void copyRange(int in, int out, off_t offset, off_t length, std::vector<char>& buffer,
+               detail::DropBehind* dropBehind) {
+    if (detail::preallocate(out, offset, length, true) == ENOSPC) {
+        throw FileSystemException("No space left on device");
+    }
+    while (length > 0) {
+        size_t chunk = static_cast<size_t>(std::min<off_t>(length, static_cast<off_t>(buffer.size())));
+        ssize_t got = pread(in, buffer.data(), chunk, offset);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            throw FileSystemException("Could not read source file for copying");
+        }
+        for (ssize_t written = 0; written < got;) {
+            ssize_t put = pwrite(out, buffer.data() + written, static_cast<size_t>(got - written), offset + written);
+            if (put < 0 && errno == EINTR) {
+                continue;
+            }
+            if (put <= 0) {
+                throw FileSystemException("Could not write destination file for copying");
+            }
+            written += put;
+        }
+        if (dropBehind != nullptr) {
+            detail::adviseDescriptor(in, AccessHint::DontNeed, offset, got);
+            dropBehind->written(offset, got);
+        }
+        offset += got;
+        length -= got;
+    }
+}
+
+} // namespace
+
 // Path implementation
 Path::Path(const std::string& path) : m_path(path) {
+    canonicalize();
+}
+
+Path::Path(std::string&& path) : m_path(std::move(path)) {
+    canonicalize();
+}
+
+Path::Path(std::string_view path) : m_path(path) {
+    canonicalize();
+}
+
+Path::Path(const char* path) : m_path(path) {
+    canonicalize();
+}
+
+void Path::canonicalize() {
     // Replace Windows backslashes with Unix forward slashes
-    std::replace(m_path.begin(), m_path.end(), '\\', '/');
+    simd::replaceByte(&m_path[0], m_path.size(), '\\', '/');
     
     // Remove trailing slash if not root
     if (m_path.size() > 1 && m_path.back() == '/') {
@@ -143,18 +211,21 @@ std::string File::readAsText() const {
 }
 
 std::vector<uint8_t> File::readAsBinary() const {
-    std::ifstream file(m_path.toString(), std::ios::binary);
-    if (!file.is_open()) {
-        throw FileSystemException("Could not open file for reading");
+    FileReader reader(m_path, m_ioMode);
+    if (m_accessHint != AccessHint::Normal) {
+        reader.advise(m_accessHint);
     }
-    
-    file.seekg(0, std::ios::end);
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::vector<uint8_t> buffer(size);
-    file.read(reinterpret_cast<char*>(buffer.data()), size);
-    
+
+    std::vector<uint8_t> buffer(static_cast<size_t>(reader.size()));
+    size_t filled = 0;
+    while (filled < buffer.size()) {
+        size_t got = reader.read(buffer.data() + filled, buffer.size() - filled);
+        if (got == 0) {
+            break;
+        }
+        filled += got;
+    }
+    buffer.resize(filled);
     return buffer;
 }
 
@@ -167,25 +238,75 @@ void File::writeText(const std::string& content) {
 }
 
 void File::writeBinary(const std::vector<uint8_t>& content) {
-    std::ofstream file(m_path.toString(), std::ios::binary);
-    if (!file.is_open()) {
-        throw FileSystemException("Could not open file for writing");
+    FileWriter writer(m_path, m_ioMode);
+    if (m_accessHint != AccessHint::Normal) {
+        writer.advise(m_accessHint);
     }
-    file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    writer.reserve(content.size());
+    writer.write(content.data(), content.size());
+    writer.close();
 }
 
 void File::copy(const Path& destination) {
-    std::ifstream src(m_path.toString(), std::ios::binary);
-    if (!src) {
+    FileDescriptor src(::open(m_path.toString().c_str(), O_RDONLY | O_CLOEXEC));
+    if (!src.valid()) {
         throw FileSystemException("Could not open source file for copying");
     }
-    
-    std::ofstream dst(destination.toString(), std::ios::binary);
-    if (!dst) {
+
+    struct stat st;
+    if (fstat(src.get(), &st) != 0) {
+        throw FileSystemException("Could not get file size");
+    }
+
+    FileDescriptor dst(::open(destination.toString().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666));
+    if (!dst.valid()) {
         throw FileSystemException("Could not open destination file for copying");
     }
-    
-    dst << src.rdbuf();
+
+    const off_t size = st.st_size;
+    std::vector<char> buffer(static_cast<size_t>(std::min<off_t>(size, kCopyBufferSize)));
+    bool dense = true;
+
+    std::unique_ptr<detail::DropBehind> dropBehind;
+    if (m_accessHint != AccessHint::Normal) {
+        detail::adviseDescriptor(src.get(), m_accessHint, 0, 0);
+    }
+    if (m_accessHint == AccessHint::DontNeed) {
+        dropBehind.reset(new detail::DropBehind(dst.get()));
+    }
+
+#ifdef SEEK_DATA
+    // Copy only the data extents; the holes between them are recreated by
+    // leaving those ranges of the freshly truncated destination unwritten
+    dense = false;
+    for (off_t offset = 0; offset < size;) {
+        off_t data = lseek(src.get(), offset, SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO) {
+                break; // Only a trailing hole remains
+            }
+            // Filesystem cannot report extents; copy everything not yet copied
+            copyRange(src.get(), dst.get(), offset, size - offset, buffer, dropBehind.get());
+            break;
+        }
+        off_t hole = lseek(src.get(), data, SEEK_HOLE);
+        if (hole < 0 || hole > size) {
+            hole = size;
+        }
+        copyRange(src.get(), dst.get(), data, hole - data, buffer, dropBehind.get());
+        offset = hole;
+    }
+#endif
+
+    if (dense) {
+        copyRange(src.get(), dst.get(), 0, size, buffer, dropBehind.get());
+    }
+    dropBehind.reset();
+
+    // Extends the destination over a trailing hole without allocating it
+    if (ftruncate(dst.get(), size) != 0) {
+        throw FileSystemException("Could not set destination file size");
+    }
 }
 
 void File::move(const Path& destination) {
@@ -196,6 +317,37 @@ void File::move(const Path& destination) {
     }
 }
 
+void File::reserve(uint64_t bytes, bool keepSize) {
+    FileDescriptor fd(::open(m_path.toString().c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+    if (!fd.valid()) {
+        throw FileSystemException("Could not open file for writing");
+    }
+    int error = detail::preallocate(fd.get(), 0, static_cast<off_t>(bytes), keepSize);
+    if (error == ENOSPC) {
+        throw FileSystemException("No space left on device");
+    }
+    if (error != 0) {
+        throw FileSystemException("Could not reserve file space");
+    }
+}
+
+void File::advise(AccessHint hint, uint64_t offset, uint64_t length) const {
+    FileDescriptor fd(::open(m_path.toString().c_str(), O_RDONLY | O_CLOEXEC));
+    if (!fd.valid()) {
+        throw FileSystemException("Could not open file");
+    }
+#if defined(__linux__)
+    // readahead() populates the cache synchronously, so the data is resident on return
+    if (hint == AccessHint::WillNeed) {
+        size_t count = length > 0 ? static_cast<size_t>(length) : File(m_path).size();
+        if (readahead(fd.get(), static_cast<off64_t>(offset), count) == 0) {
+            return;
+        }
+    }
+#endif
+    detail::adviseDescriptor(fd.get(), hint, static_cast<off_t>(offset), static_cast<off_t>(length));
+}
+
 void File::remove() {
     if (::unlink(m_path.toString().c_str()) != 0) {
         throw FileSystemException("Could not delete file");
@@ -217,14 +369,11 @@ void Directory::create() {
 
 void Directory::remove(bool recursive) {
     if (recursive) {
-        // First remove contents
-        std::vector<Path> contents = list(false);
-        for (const Path& entry : contents) {
-            if (entry.isDirectory()) {
-                Directory(entry).remove(true);
-            } else {
-                File(entry).remove();
-            }
+        // Remove contents relative to an open handle so each entry costs a
+        // single-component lookup; symlinks are unlinked, never followed
+        DirHandle handle(m_path);
+        for (const std::string& name : handle.list()) {
+            handle.removeTreeAt(name);
         }
     }
     
@@ -233,34 +382,52 @@ void Directory::remove(bool recursive) {
     }
 }
 
-std::vector<Path> Directory::list(bool recursive) const {
-    std::vector<Path> result;
-    
-    DIR* dir = opendir(m_path.toString().c_str());
+namespace {
+
+// Recursion follows symlinked directories, but visited guarantees every
+// physical directory is listed once, so link and bind-mount loops terminate
+void listInto(const Path& directory, bool recursive, FileIdSet& visited, std::vector<Path>& result) {
+    DIR* dir = opendir(directory.toString().c_str());
     if (!dir) {
-        return result;
+        return;
     }
     
     struct dirent* entry;
     while ((entry = readdir(dir)) != nullptr) {
-        std::string name = entry->d_name;
+        const char* name = entry->d_name;
         
         // Skip . and .. entries
-        if (name == "." || name == "..") {
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
             continue;
         }
         
-        Path fullPath(m_path.toString() + "/" + name);
-        result.push_back(fullPath);
+        result.push_back(directory / name);
         
-        // Recursively process directories if requested
-        if (recursive && fullPath.isDirectory()) {
-            std::vector<Path> subDirContents = Directory(fullPath).list(true);
-            result.insert(result.end(), subDirContents.begin(), subDirContents.end());
+        // Recursively process directories if requested. Stat relative to
+        // the open directory instead of resolving the full path again.
+        if (recursive && (entry->d_type == DT_DIR || entry->d_type == DT_LNK || entry->d_type == DT_UNKNOWN)) {
+            struct stat st;
+            if (fstatat(dirfd(dir), name, &st, 0) == 0 && S_ISDIR(st.st_mode) &&
+                visited.insert({static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)})) {
+                Path child = result.back();
+                listInto(child, true, visited, result);
+            }
         }
     }
     
     closedir(dir);
+}
+
+} // namespace
+
+std::vector<Path> Directory::list(bool recursive) const {
+    std::vector<Path> result;
+    FileIdSet visited;
+    struct stat st;
+    if (recursive && stat(m_path.toString().c_str(), &st) == 0) {
+        visited.insert({static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)});
+    }
+    listInto(m_path, recursive, visited, result);
     return result;
 }
 
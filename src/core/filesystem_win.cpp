@@ -1,4 +1,6 @@
 #include "filesystem.hpp"
+#include "simd.hpp"
+#include "stream.hpp"
 
 #ifdef _WIN32
 
@@ -14,8 +16,24 @@ namespace fs {
 
 // Path implementation
 Path::Path(const std::string& path) : m_path(path) {
+    canonicalize();
+}
+
+Path::Path(std::string&& path) : m_path(std::move(path)) {
+    canonicalize();
+}
+
+Path::Path(std::string_view path) : m_path(path) {
+    canonicalize();
+}
+
+Path::Path(const char* path) : m_path(path) {
+    canonicalize();
+}
+
+void Path::canonicalize() {
     // Normalize path separators to Windows style
-    std::replace(m_path.begin(), m_path.end(), '/', '\\');
+    simd::replaceByte(&m_path[0], m_path.size(), '/', '\\');
 }
 
 std::string Path::toString() const {
@@ -124,18 +142,18 @@ std::string File::readAsText() const {
 }
 
 std::vector<uint8_t> File::readAsBinary() const {
-    std::ifstream file(m_path.toString(), std::ios::binary);
-    if (!file.is_open()) {
-        throw FileSystemException("Could not open file for reading");
+    // Same path as on POSIX; the Win32 streams open cached, sequential-scan handles
+    FileReader reader(m_path, m_ioMode);
+    std::vector<uint8_t> buffer(static_cast<size_t>(reader.size()));
+    size_t filled = 0;
+    while (filled < buffer.size()) {
+        size_t got = reader.read(buffer.data() + filled, buffer.size() - filled);
+        if (got == 0) {
+            break;
+        }
+        filled += got;
     }
-    
-    file.seekg(0, std::ios::end);
-    size_t size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    
-    std::vector<uint8_t> buffer(size);
-    file.read(reinterpret_cast<char*>(buffer.data()), size);
-    
+    buffer.resize(filled);
     return buffer;
 }
 
@@ -148,15 +166,19 @@ void File::writeText(const std::string& content) {
 }
 
 void File::writeBinary(const std::vector<uint8_t>& content) {
-    std::ofstream file(m_path.toString(), std::ios::binary);
-    if (!file.is_open()) {
-        throw FileSystemException("Could not open file for writing");
-    }
-    file.write(reinterpret_cast<const char*>(content.data()), content.size());
+    FileWriter writer(m_path, m_ioMode);
+    writer.reserve(content.size());
+    writer.write(content.data(), content.size());
+    writer.close();
 }
 
 void File::copy(const Path& destination) {
-    if (!CopyFileA(m_path.toString().c_str(), destination.toString().c_str(), FALSE)) {
+    // CopyFileEx sizes the destination up front; unbuffered, it also leaves the cache alone
+    DWORD flags = 0;
+    if (m_ioMode == IoMode::Direct || m_accessHint == AccessHint::DontNeed) {
+        flags |= COPY_FILE_NO_BUFFERING;
+    }
+    if (!CopyFileExA(m_path.toString().c_str(), destination.toString().c_str(), NULL, NULL, NULL, flags)) {
         throw FileSystemException("Could not copy file");
     }
 }
@@ -167,6 +189,42 @@ void File::move(const Path& destination) {
     }
 }
 
+void File::advise(AccessHint, uint64_t, uint64_t) const {
+    // Windows takes access hints as CreateFile flags when a handle is opened
+    // and has no call to advise an existing file; nothing to do here
+}
+
+void File::reserve(uint64_t bytes, bool keepSize) {
+    HANDLE handle = CreateFileA(m_path.toString().c_str(), GENERIC_WRITE, 0, NULL, OPEN_ALWAYS,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        throw FileSystemException("Could not open file for writing");
+    }
+
+    FILE_ALLOCATION_INFO allocation;
+    allocation.AllocationSize.QuadPart = static_cast<LONGLONG>(bytes);
+    BOOL ok = SetFileInformationByHandle(handle, FileAllocationInfo, &allocation, sizeof(allocation));
+    DWORD error = ok ? ERROR_SUCCESS : GetLastError();
+
+    if (ok && !keepSize) {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(handle, &size) && static_cast<uint64_t>(size.QuadPart) < bytes) {
+            FILE_END_OF_FILE_INFO end;
+            end.EndOfFile.QuadPart = static_cast<LONGLONG>(bytes);
+            ok = SetFileInformationByHandle(handle, FileEndOfFileInfo, &end, sizeof(end));
+            error = ok ? ERROR_SUCCESS : GetLastError();
+        }
+    }
+    CloseHandle(handle);
+
+    if (error == ERROR_DISK_FULL) {
+        throw FileSystemException("No space left on device");
+    }
+    if (error != ERROR_SUCCESS) {
+        throw FileSystemException("Could not reserve file space");
+    }
+}
+
 void File::remove() {
     if (!DeleteFileA(m_path.toString().c_str())) {
         throw FileSystemException("Could not delete file");
@@ -220,11 +278,13 @@ std::vector<Path> Directory::list(bool recursive) const {
                 continue;
             }
             
-            Path fullPath(m_path.toString() + "\\" + name);
+            Path fullPath = m_path / name;
             result.push_back(fullPath);
             
-            // Recursively process directories if requested
-            if (recursive && (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+            // Recursively process directories if requested. Junctions and
+            // directory symlinks are not entered, so they cannot form loops.
+            if (recursive && (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) &&
+                !(findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT)) {
                 std::vector<Path> subDirContents = Directory(fullPath).list(true);
                 result.insert(result.end(), subDirContents.begin(), subDirContents.end());
             }
@@ -0,0 +1,328 @@
+#include "fuzzy_match.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr size_t kChunk = 1 << 14;
+
+constexpr int32_t kScoreMatch = 16;
+constexpr int32_t kBonusSeparator = 9;
+constexpr int32_t kBonusBoundary = 8;
+constexpr int32_t kBonusCamel = 7;
+constexpr int32_t kBonusConsecutive = 4;
+constexpr int32_t kPenaltyGapStart = -3;
+constexpr int32_t kPenaltyGapExtend = -1;
+constexpr int32_t kUnreachable = -(1 << 29);
+
+inline char fold(char c) {
+    return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Letters and digits get a bit each; everything else shares the rest
+inline uint64_t maskBit(char c) {
+    c = fold(c);
+    if (c >= 'a' && c <= 'z') {
+        return uint64_t(1) << (c - 'a');
+    }
+    if (c >= '0' && c <= '9') {
+        return uint64_t(1) << (26 + (c - '0'));
+    }
+    return uint64_t(1) << (36 + static_cast<uint8_t>(c) % 28);
+}
+
+uint64_t maskOf(std::string_view text) {
+    uint64_t mask = 0;
+    for (char c : text) {
+        mask |= maskBit(c);
+    }
+    return mask;
+}
+
+int32_t bonusAt(std::string_view text, size_t position) {
+    if (position == 0) {
+        return kBonusBoundary;
+    }
+    char previous = text[position - 1];
+    char current = text[position];
+    if (previous == '/' || previous == '\\') {
+        return kBonusSeparator;
+    }
+    if (previous == '_' || previous == '-' || previous == '.' || previous == ' ') {
+        return kBonusBoundary;
+    }
+    if ((previous >= 'a' && previous <= 'z' && current >= 'A' && current <= 'Z') ||
+        (!(previous >= '0' && previous <= '9') && current >= '0' && current <= '9')) {
+        return kBonusCamel;
+    }
+    return 0;
+}
+
+// Scratch space reused across candidates by one worker
+struct ScoreScratch {
+    std::vector<char> text;
+    std::vector<int32_t> bonus;
+    std::vector<int32_t> rows;
+    std::vector<size_t> first;
+    std::vector<size_t> last;
+};
+
+// query is already folded and non-empty
+int32_t scoreFolded(const std::string& query, std::string_view text, ScoreScratch& scratch) {
+    const size_t m = query.size();
+    if (m == 1) {
+        // A single character is its best-placed occurrence; no alignment to search
+        int32_t best = kUnreachable;
+        for (size_t j = 0; j < text.size(); ++j) {
+            if (fold(text[j]) == query[0]) {
+                best = std::max(best, kScoreMatch + 2 * bonusAt(text, j));
+            }
+        }
+        return best > kUnreachable / 2 ? best : FuzzyMatcher::kNoMatch;
+    }
+    scratch.first.resize(m);
+    scratch.last.resize(m);
+
+    // Greedy forward pass: the earliest position each query character can take
+    size_t q = 0;
+    for (size_t j = 0; j < text.size() && q < m; ++j) {
+        if (fold(text[j]) == query[q]) {
+            scratch.first[q++] = j;
+        }
+    }
+    if (q < m) {
+        return FuzzyMatcher::kNoMatch;
+    }
+    // Backward pass: the latest position each can take
+    size_t j = text.size();
+    for (size_t i = m; i-- > 0;) {
+        do {
+            --j;
+        } while (fold(text[j]) != query[i]);
+        scratch.last[i] = j;
+    }
+
+    // Work on the window the match can occupy, with case folded and bonuses precomputed
+    const size_t low = scratch.first[0];
+    const size_t width = scratch.last[m - 1] + 1 - low;
+    scratch.text.resize(width);
+    scratch.bonus.resize(width);
+    for (size_t k = 0; k < width; ++k) {
+        scratch.text[k] = fold(text[low + k]);
+        scratch.bonus[k] = bonusAt(text, low + k);
+    }
+    const char* window = scratch.text.data();
+    const int32_t* bonus = scratch.bonus.data();
+    scratch.rows.resize(2 * width);
+    int32_t* previous = scratch.rows.data();
+    int32_t* current = scratch.rows.data() + width;
+
+    // Row i is only reachable in [first[i], last[i]]; cells outside are never read
+    for (size_t k = 0; k <= scratch.last[0] - low; ++k) {
+        // The first character's boundary bonus counts double
+        current[k] = window[k] == query[0] ? kScoreMatch + 2 * bonus[k] : kUnreachable;
+    }
+
+    for (size_t i = 1; i < m; ++i) {
+        std::swap(previous, current);
+        const size_t previousLow = scratch.first[i - 1] - low;
+        const size_t previousHigh = scratch.last[i - 1] - low;
+        const size_t high = scratch.last[i] - low;
+        int32_t gapBest = kUnreachable;
+        for (size_t k = previousLow + 1; k <= high; ++k) {
+            // Best way to arrive with a gap of at least one character
+            gapBest += kPenaltyGapExtend;
+            if (k >= previousLow + 2 && k - 2 <= previousHigh) {
+                gapBest = std::max(gapBest, previous[k - 2] + kPenaltyGapStart);
+            }
+            int32_t diagonal = k - 1 <= previousHigh ? previous[k - 1] + kBonusConsecutive : kUnreachable;
+            int32_t best = std::max(diagonal, gapBest);
+            current[k] = window[k] == query[i] && best > kUnreachable / 2 ? best + kScoreMatch + bonus[k]
+                                                                         : kUnreachable;
+        }
+    }
+
+    int32_t result = kUnreachable;
+    for (size_t k = scratch.first[m - 1] - low; k < width; ++k) {
+        result = std::max(result, current[k]);
+    }
+    return result > kUnreachable / 2 ? result : FuzzyMatcher::kNoMatch;
+}
+
+std::string foldQuery(std::string_view query) {
+    std::string folded(query.substr(0, FuzzyMatcher::kMaxQuery));
+    for (char& c : folded) {
+        c = fold(c);
+    }
+    return folded;
+}
+
+} // namespace
+
+FuzzyMatcher::FuzzyMatcher(const std::vector<std::string>& candidates) : m_offsets(1, 0) {
+    m_masks.reserve(candidates.size());
+    for (const std::string& candidate : candidates) {
+        append(candidate);
+    }
+}
+
+FuzzyMatcher::FuzzyMatcher(const PathList& entries) : m_offsets(1, 0) {
+    m_masks.reserve(entries.size());
+    std::string path;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries.relativePathInto(i, path);
+        append(path);
+    }
+}
+
+void FuzzyMatcher::append(std::string_view candidate) {
+    if (m_text.size() + candidate.size() > UINT32_MAX) {
+        throw std::length_error("Too much text for a fuzzy matcher");
+    }
+    m_text.append(candidate.data(), candidate.size());
+    m_offsets.push_back(static_cast<uint32_t>(m_text.size()));
+    m_masks.push_back(maskOf(candidate));
+}
+
+int32_t FuzzyMatcher::score(std::string_view query, std::string_view candidate) {
+    std::string folded = foldQuery(query);
+    if (folded.empty()) {
+        return 0;
+    }
+    ScoreScratch scratch;
+    return scoreFolded(folded, candidate, scratch);
+}
+
+std::vector<FuzzyMatch> FuzzyMatcher::match(std::string_view query, size_t limit, ThreadPool* pool) const {
+    if (limit == 0) {
+        return {};
+    }
+    return rank(foldQuery(query), limit, pool, nullptr, nullptr);
+}
+
+std::vector<FuzzyMatch> FuzzyMatcher::rank(const std::string& folded, size_t limit, ThreadPool* pool,
+                                           const std::vector<uint32_t>* subset,
+                                           std::vector<uint32_t>* survivors) const {
+    const uint64_t queryMask = maskOf(folded);
+
+    // Heap order: the worst kept match sits at the front
+    auto better = [this](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        size_t lengthA = m_offsets[a.index + 1] - m_offsets[a.index];
+        size_t lengthB = m_offsets[b.index + 1] - m_offsets[b.index];
+        if (lengthA != lengthB) {
+            return lengthA < lengthB;
+        }
+        return a.index < b.index;
+    };
+
+    const size_t count = subset ? subset->size() : size();
+    const size_t chunks = (count + kChunk - 1) / kChunk;
+    std::vector<std::vector<FuzzyMatch>> heaps(chunks);
+    std::vector<std::vector<uint32_t>> matched(survivors ? chunks : 0);
+    ThreadPool& workers = pool ? *pool : ThreadPool::io();
+
+    workers.parallelFor(chunks, [&](size_t chunk) {
+        const size_t begin = chunk * kChunk;
+        const size_t end = std::min(count, begin + kChunk);
+
+        // Bitmask prefilter: a branch-free pass over the mask column
+        std::vector<uint8_t> pass(end - begin);
+        if (subset) {
+            const uint32_t* indices = subset->data() + begin;
+            for (size_t i = 0; i < end - begin; ++i) {
+                pass[i] = (m_masks[indices[i]] & queryMask) == queryMask;
+            }
+        } else {
+            const uint64_t* masks = m_masks.data() + begin;
+            for (size_t i = 0; i < end - begin; ++i) {
+                pass[i] = (masks[i] & queryMask) == queryMask;
+            }
+        }
+
+        std::vector<FuzzyMatch>& heap = heaps[chunk];
+        ScoreScratch scratch;
+        for (size_t i = 0; i < end - begin; ++i) {
+            if (!pass[i]) {
+                continue;
+            }
+            uint32_t index = subset ? (*subset)[begin + i] : static_cast<uint32_t>(begin + i);
+            int32_t value = folded.empty() ? 0 : scoreFolded(folded, candidate(index), scratch);
+            if (value == kNoMatch) {
+                continue;
+            }
+            if (survivors) {
+                matched[chunk].push_back(index);
+            }
+            FuzzyMatch found{index, value};
+            if (heap.size() < limit) {
+                heap.push_back(found);
+                std::push_heap(heap.begin(), heap.end(), better);
+            } else if (!heap.empty() && better(found, heap.front())) {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = found;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+        }
+    });
+
+    if (survivors) {
+        // Chunks cover ascending ranges, so the survivors stay in index order
+        survivors->clear();
+        for (const auto& part : matched) {
+            survivors->insert(survivors->end(), part.begin(), part.end());
+        }
+    }
+
+    std::vector<FuzzyMatch> result;
+    for (const auto& heap : heaps) {
+        result.insert(result.end(), heap.begin(), heap.end());
+    }
+    std::sort(result.begin(), result.end(), better);
+    if (result.size() > limit) {
+        result.resize(limit);
+    }
+    return result;
+}
+
+FuzzySession::FuzzySession(const FuzzyMatcher& matcher, ThreadPool* pool) : m_matcher(matcher), m_pool(pool) {}
+
+std::vector<FuzzyMatch> FuzzySession::match(std::string_view query, size_t limit) {
+    std::string folded = foldQuery(query);
+    if (folded.empty()) {
+        // Everything matches; the next keystroke scans the full set anyway
+        reset();
+        return m_matcher.match(query, limit, m_pool);
+    }
+
+    // A candidate matching the new query also matches any prefix of it
+    const bool narrows = m_narrowing && folded.compare(0, m_query.size(), m_query) == 0 &&
+                         m_survivors.size() < m_matcher.size();
+    std::vector<uint32_t> survivors;
+    std::vector<FuzzyMatch> result =
+        m_matcher.rank(folded, limit, m_pool, narrows ? &m_survivors : nullptr, &survivors);
+    m_survivors = std::move(survivors);
+    m_query = std::move(folded);
+    m_narrowing = true;
+    return result;
+}
+
+size_t FuzzySession::survivors() const {
+    return m_narrowing ? m_survivors.size() : m_matcher.size();
+}
+
+void FuzzySession::reset() {
+    m_query.clear();
+    m_survivors.clear();
+    m_narrowing = false;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,121 @@
+#ifndef CROSSDEV_FUZZY_MATCH_HPP
+#define CROSSDEV_FUZZY_MATCH_HPP
+
+#include "path_list.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * One ranked candidate
+ */
+struct FuzzyMatch {
+    uint32_t index;
+    int32_t score;
+};
+
+/**
+ * fzf-style fuzzy matcher over a fixed set of paths.
+ *
+ * A candidate matches when the query's characters appear in it in order,
+ * ignoring ASCII case. Matching runs in three steps:
+ *
+ * 1. Each candidate's character-class bitmask, computed once up front, is
+ *    compared against the query's in a tight loop the compiler vectorises;
+ *    candidates lacking any query character are dropped.
+ * 2. A greedy forward and backward scan confirms the order and narrows
+ *    the window the match can occupy.
+ * 3. A dynamic program over that window scores the best alignment,
+ *    rewarding consecutive characters and matches at word boundaries
+ *    (after '/', '_', '-', '.', or a lower-to-upper case change), and
+ *    penalising gaps.
+ *
+ * Candidates are scored in parallel chunks that each keep a bounded
+ * min-heap; only the overall top results are returned. Queries longer
+ * than kMaxQuery characters are truncated. Interactive callers should go
+ * through FuzzySession, which rescores only the survivors of the previous
+ * keystroke.
+ */
+class FuzzyMatcher {
+public:
+    static constexpr int32_t kNoMatch = std::numeric_limits<int32_t>::min();
+    static constexpr size_t kMaxQuery = 64;
+
+    explicit FuzzyMatcher(const std::vector<std::string>& candidates);
+    /** Match against the entries' paths relative to the list root */
+    explicit FuzzyMatcher(const PathList& entries);
+
+    size_t size() const { return m_offsets.size() - 1; }
+    std::string_view candidate(size_t index) const {
+        return std::string_view(m_text.data() + m_offsets[index], m_offsets[index + 1] - m_offsets[index]);
+    }
+
+    /** Best matches, highest score first; ties go to the shorter candidate */
+    std::vector<FuzzyMatch> match(std::string_view query, size_t limit = 50, ThreadPool* pool = nullptr) const;
+
+    /** Score one candidate, or kNoMatch */
+    static int32_t score(std::string_view query, std::string_view candidate);
+
+private:
+    friend class FuzzySession;
+
+    void append(std::string_view candidate);
+    /**
+     * Rank folded against every candidate, or only those in subset (in
+     * index order). When survivors is given it receives every matching
+     * index, in index order.
+     */
+    std::vector<FuzzyMatch> rank(const std::string& folded, size_t limit, ThreadPool* pool,
+                                 const std::vector<uint32_t>* subset, std::vector<uint32_t>* survivors) const;
+
+    std::string m_text;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint64_t> m_masks;
+};
+
+/**
+ * Matches a query as it is typed, one keystroke at a time.
+ *
+ * Every candidate that matches a query also matches each of its
+ * prefixes, so when a query extends the previous one only that query's
+ * survivors are rescored and a keystroke costs in proportion to what
+ * still matches. Any other edit rescans the whole set. The first
+ * keystroke of a query therefore still visits every candidate once;
+ * single characters take a cheap path that skips the alignment program.
+ * A session is not thread-safe: keep one per input.
+ */
+class FuzzySession {
+public:
+    explicit FuzzySession(const FuzzyMatcher& matcher, ThreadPool* pool = nullptr);
+
+    /** Same results as FuzzyMatcher::match() for the same query */
+    std::vector<FuzzyMatch> match(std::string_view query, size_t limit = 50);
+
+    /** Candidates the next extending query will rescore */
+    size_t survivors() const;
+
+    /** Forget the previous query; the next match() scans everything */
+    void reset();
+
+private:
+    const FuzzyMatcher& m_matcher;
+    ThreadPool* m_pool;
+    std::string m_query;
+    std::vector<uint32_t> m_survivors;
+    bool m_narrowing = false;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_FUZZY_MATCH_HPP
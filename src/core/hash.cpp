@@ -0,0 +1,145 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+namespace crossdev {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kPrime4 = 0x85EBCA77C2B2AE63ULL;
+constexpr uint64_t kPrime5 = 0x27D4EB2F165667C5ULL;
+
+inline uint64_t rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t read64(const unsigned char* p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint32_t read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline uint64_t mixRound(uint64_t acc, uint64_t input) {
+    acc += input * kPrime2;
+    acc = rotl(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t mergeRound(uint64_t acc, uint64_t value) {
+    acc ^= mixRound(0, value);
+    return acc * kPrime1 + kPrime4;
+}
+
+uint64_t finalize(uint64_t h, const unsigned char* p, size_t length) {
+    while (length >= 8) {
+        h ^= mixRound(0, read64(p));
+        h = rotl(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+        length -= 8;
+    }
+    if (length >= 4) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+        length -= 4;
+    }
+    while (length > 0) {
+        h ^= (*p) * kPrime5;
+        h = rotl(h, 11) * kPrime1;
+        ++p;
+        --length;
+    }
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+uint64_t mergeAccumulators(const uint64_t acc[4]) {
+    uint64_t h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+    for (int i = 0; i < 4; ++i) {
+        h = mergeRound(h, acc[i]);
+    }
+    return h;
+}
+
+} // namespace
+
+uint64_t hash64(const void* data, size_t length, uint64_t seed) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* end = p + length;
+    uint64_t h;
+
+    if (length >= 32) {
+        uint64_t acc[4] = {seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1};
+        const unsigned char* limit = end - 32;
+        do {
+            acc[0] = mixRound(acc[0], read64(p));
+            acc[1] = mixRound(acc[1], read64(p + 8));
+            acc[2] = mixRound(acc[2], read64(p + 16));
+            acc[3] = mixRound(acc[3], read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+        h = mergeAccumulators(acc);
+    } else {
+        h = seed + kPrime5;
+    }
+
+    h += static_cast<uint64_t>(length);
+    return finalize(h, p, static_cast<size_t>(end - p));
+}
+
+Hasher64::Hasher64(uint64_t seed)
+    : m_acc{seed + kPrime1 + kPrime2, seed + kPrime2, seed, seed - kPrime1}, m_seed(seed) {}
+
+void Hasher64::update(const void* data, size_t length) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    m_total += length;
+
+    if (m_buffered + length < 32) {
+        std::memcpy(m_buffer + m_buffered, p, length);
+        m_buffered += length;
+        return;
+    }
+
+    if (m_buffered > 0) {
+        size_t fill = 32 - m_buffered;
+        std::memcpy(m_buffer + m_buffered, p, fill);
+        for (int i = 0; i < 4; ++i) {
+            m_acc[i] = mixRound(m_acc[i], read64(m_buffer + i * 8));
+        }
+        p += fill;
+        length -= fill;
+        m_buffered = 0;
+    }
+
+    while (length >= 32) {
+        for (int i = 0; i < 4; ++i) {
+            m_acc[i] = mixRound(m_acc[i], read64(p + i * 8));
+        }
+        p += 32;
+        length -= 32;
+    }
+
+    std::memcpy(m_buffer, p, length);
+    m_buffered = length;
+}
+
+uint64_t Hasher64::digest() const {
+    uint64_t h = m_total >= 32 ? mergeAccumulators(m_acc) : m_seed + kPrime5;
+    h += m_total;
+    return finalize(h, m_buffer, m_buffered);
+}
+
+} // namespace crossdev
@@ -0,0 +1,38 @@
+#ifndef CROSSDEV_HASH_HPP
+#define CROSSDEV_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crossdev {
+
+/**
+ * 64-bit non-cryptographic content hash (XXH64).
+ *
+ * Fast enough to run at memory bandwidth; suitable for deduplication,
+ * ETags and index lookups, not for security decisions.
+ */
+uint64_t hash64(const void* data, size_t length, uint64_t seed = 0);
+
+/**
+ * Incremental form of hash64() for content that arrives in chunks.
+ * Feeding the same bytes in any chunking yields the same digest.
+ */
+class Hasher64 {
+public:
+    explicit Hasher64(uint64_t seed = 0);
+
+    void update(const void* data, size_t length);
+    uint64_t digest() const;
+
+private:
+    uint64_t m_acc[4];
+    uint64_t m_seed;
+    uint64_t m_total = 0;
+    unsigned char m_buffer[32];
+    size_t m_buffered = 0;
+};
+
+} // namespace crossdev
+
+#endif // CROSSDEV_HASH_HPP
@@ -0,0 +1,326 @@
+#include "incremental_scan.hpp"
+#include "file_id.hpp"
+#include "index_format.hpp"
+#include "thread_pool.hpp"
+#include "walker_detail.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'D', 'X', 'S', 'C', 'A', 'N', '1'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kNoPrevious = PathList::kRoot - 1;
+constexpr int64_t kInvalidTime = std::numeric_limits<int64_t>::min();
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// One directory of the breadth-first rescan
+struct Job {
+    Job(uint32_t index, uint32_t previous, std::string path)
+        : index(index), previous(previous), path(std::move(path)) {}
+
+    uint32_t index;
+    uint32_t previous;
+    std::string path;
+
+    bool ok = false;
+    bool reused = false;
+    FileId id;
+    int64_t mtimeNs = 0;
+    int64_t ctimeNs = 0;
+    size_t restated = 0;
+    std::vector<detail::RawEntry> entries;
+    // Index of each entry in the previous listing, or kNoPrevious
+    std::vector<uint32_t> previousChild;
+};
+
+// Native-endian column writer/reader for the state file
+template <typename T>
+void put(std::string& out, const T& value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void putColumn(std::string& out, const std::vector<T>& column) {
+    out.append(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(T));
+}
+
+class StateReader {
+public:
+    explicit StateReader(std::string_view data) : m_data(data) {}
+
+    template <typename T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void getColumn(std::vector<T>& column, size_t count) {
+        if (count > m_data.size() / sizeof(T)) {
+            fail();
+        }
+        column.resize(count);
+        std::memcpy(column.data(), take(count * sizeof(T)), count * sizeof(T));
+    }
+
+    std::string_view bytes(size_t count) { return std::string_view(take(count), count); }
+
+    [[noreturn]] static void fail() { throw FileSystemException("Invalid scan state file"); }
+
+private:
+    const char* take(size_t count) {
+        if (count > m_data.size() - m_position) {
+            fail();
+        }
+        const char* result = m_data.data() + m_position;
+        m_position += count;
+        return result;
+    }
+
+    std::string_view m_data;
+    size_t m_position = 0;
+};
+
+} // namespace
+
+IncrementalScanner::IncrementalScanner(const Path& root, IncrementalOptions options)
+    : m_options(options), m_entries(root) {}
+
+const PathList& IncrementalScanner::scan() {
+    ThreadPool& pool = m_options.pool ? *m_options.pool : ThreadPool::io();
+    m_stats = IncrementalStats();
+    const int64_t racyAfter = nowNs() - m_options.racyWindowNs;
+
+    PathList previous = std::move(m_entries);
+    std::unordered_map<uint32_t, Stamp> previousStamps = std::move(m_stamps);
+    m_entries = PathList(previous.root());
+    m_stamps.clear();
+
+    // Children of every previous directory, grouped by parent (the root last)
+    const size_t count = previous.size();
+    auto slotOf = [count](uint32_t parent) { return parent == PathList::kRoot ? count : parent; };
+    std::vector<uint32_t> childStart(count + 2, 0);
+    for (size_t i = 0; i < count; ++i) {
+        ++childStart[slotOf(previous.parent(i)) + 1];
+    }
+    for (size_t i = 1; i < childStart.size(); ++i) {
+        childStart[i] += childStart[i - 1];
+    }
+    std::vector<uint32_t> children(count);
+    {
+        std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            children[cursor[slotOf(previous.parent(i))]++] = static_cast<uint32_t>(i);
+        }
+    }
+
+    const char separator = Path::separator();
+    detail::ReadOptions readOptions;
+
+    auto process = [&](Job& job) {
+        job.ok = detail::stampDirectory(job.path, job.id, job.mtimeNs, job.ctimeNs);
+        if (!job.ok) {
+            return;
+        }
+        auto found = job.previous == kNoPrevious ? previousStamps.end() : previousStamps.find(job.previous);
+        size_t first = 0;
+        size_t last = 0;
+        if (job.previous != kNoPrevious) {
+            first = childStart[slotOf(job.previous)];
+            last = childStart[slotOf(job.previous) + 1];
+        }
+
+        if (found != previousStamps.end() && found->second.mtimeNs == job.mtimeNs &&
+            found->second.ctimeNs == job.ctimeNs) {
+            job.reused = true;
+            for (size_t c = first; c < last; ++c) {
+                uint32_t child = children[c];
+                detail::RawEntry raw;
+                raw.name = previous.name(child);
+                raw.type = previous.type(child);
+                raw.size = previous.fileSize(child);
+                raw.mtimeNs = previous.mtime(child);
+                job.entries.push_back(std::move(raw));
+                job.previousChild.push_back(child);
+            }
+            if (m_options.restatFiles) {
+                job.restated = detail::restatEntries(job.path, job.entries);
+            }
+            return;
+        }
+
+        detail::readDirectory(job.path, readOptions, job.entries);
+        // Match subdirectories to their previous listing so deeper levels can be reused
+        std::unordered_map<std::string_view, uint32_t> byName;
+        byName.reserve(last - first);
+        for (size_t c = first; c < last; ++c) {
+            byName.emplace(previous.name(children[c]), children[c]);
+        }
+        job.previousChild.reserve(job.entries.size());
+        for (const detail::RawEntry& entry : job.entries) {
+            auto match = byName.find(entry.name);
+            job.previousChild.push_back(match == byName.end() ? kNoPrevious : match->second);
+        }
+    };
+
+    FileIdSet visited;
+    FileId rootId;
+    std::vector<Job> level;
+    level.emplace_back(PathList::kRoot, PathList::kRoot, previous.root().getNative());
+    if (previousStamps.find(PathList::kRoot) == previousStamps.end()) {
+        level.front().previous = kNoPrevious;
+    }
+
+    while (!level.empty()) {
+        pool.parallelFor(level.size(), [&](size_t i) { process(level[i]); });
+
+        std::vector<Job> next;
+        for (Job& job : level) {
+            if (!job.ok) {
+                continue;
+            }
+            if (job.index == PathList::kRoot) {
+                rootId = job.id;
+            }
+            if (!visited.insert(job.id) || (m_options.oneFileSystem && job.id.device != rootId.device)) {
+                continue;
+            }
+
+            bool racy = job.mtimeNs >= racyAfter || job.ctimeNs >= racyAfter;
+            m_stamps[job.index] = racy ? Stamp{kInvalidTime, kInvalidTime} : Stamp{job.mtimeNs, job.ctimeNs};
+            if (job.reused) {
+                ++m_stats.directoriesReused;
+            } else {
+                ++m_stats.directoriesRead;
+            }
+            m_stats.filesRestated += job.restated;
+
+            for (size_t k = 0; k < job.entries.size(); ++k) {
+                const detail::RawEntry& entry = job.entries[k];
+                uint32_t index = m_entries.add(job.index, entry.name, entry.type, entry.size, entry.mtimeNs);
+                if (!m_options.recursive || entry.type != EntryType::Directory) {
+                    continue;
+                }
+                std::string child;
+                child.reserve(job.path.size() + 1 + entry.name.size());
+                child.append(job.path);
+                if (child.back() != separator) {
+                    child.push_back(separator);
+                }
+                child.append(entry.name);
+                next.emplace_back(index, job.previousChild[k], std::move(child));
+            }
+        }
+        level.swap(next);
+    }
+
+    return m_entries;
+}
+
+void IncrementalScanner::save(const Path& file) const {
+    const std::string root = m_entries.root().toString();
+    const size_t count = m_entries.size();
+
+    std::string out;
+    out.reserve(64 + root.size() + m_entries.memoryUsage() + m_stamps.size() * 24);
+    out.append(kMagic, sizeof(kMagic));
+    put(out, kVersion);
+    put(out, static_cast<uint64_t>(root.size()));
+    out.append(root);
+    put(out, static_cast<uint64_t>(count));
+    put(out, static_cast<uint64_t>(m_entries.nameArena().size()));
+    putColumn(out, m_entries.nameOffsets());
+    out.append(m_entries.nameArena().data(), m_entries.nameArena().size());
+    putColumn(out, m_entries.parents());
+    putColumn(out, m_entries.types());
+    putColumn(out, m_entries.sizes());
+    putColumn(out, m_entries.mtimes());
+    put(out, static_cast<uint64_t>(m_stamps.size()));
+    for (const auto& stamp : m_stamps) {
+        put(out, stamp.first);
+        put(out, stamp.second.mtimeNs);
+        put(out, stamp.second.ctimeNs);
+    }
+
+    detail::writeFileAtomically(file, out);
+}
+
+void IncrementalScanner::load(const Path& file) {
+    std::ifstream stream(file.toString(), std::ios::binary);
+    if (!stream) {
+        throw FileSystemException("Could not open scan state: " + file.toString());
+    }
+    std::string data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+    StateReader reader(data);
+
+    if (reader.bytes(sizeof(kMagic)) != std::string_view(kMagic, sizeof(kMagic)) ||
+        reader.get<uint32_t>() != kVersion) {
+        StateReader::fail();
+    }
+    std::string_view root = reader.bytes(static_cast<size_t>(reader.get<uint64_t>()));
+    if (root != m_entries.root().toString()) {
+        throw FileSystemException("Scan state belongs to another root: " + std::string(root));
+    }
+
+    size_t count = static_cast<size_t>(reader.get<uint64_t>());
+    size_t nameBytes = static_cast<size_t>(reader.get<uint64_t>());
+    if (count >= PathList::kRoot - 1) {
+        StateReader::fail();
+    }
+    std::vector<uint32_t> offsets;
+    reader.getColumn(offsets, count + 1);
+    std::string_view names = reader.bytes(nameBytes);
+    std::vector<uint32_t> parents;
+    std::vector<EntryType> types;
+    std::vector<uint64_t> sizes;
+    std::vector<int64_t> mtimes;
+    reader.getColumn(parents, count);
+    reader.getColumn(types, count);
+    reader.getColumn(sizes, count);
+    reader.getColumn(mtimes, count);
+
+    PathList entries(m_entries.root());
+    entries.reserve(count, nameBytes);
+    for (size_t i = 0; i < count; ++i) {
+        if (offsets[i] > offsets[i + 1] || offsets[i + 1] > nameBytes ||
+            (parents[i] != PathList::kRoot && parents[i] >= i) || types[i] > EntryType::Other) {
+            StateReader::fail();
+        }
+        entries.add(parents[i], names.substr(offsets[i], offsets[i + 1] - offsets[i]), types[i], sizes[i],
+                    mtimes[i]);
+    }
+
+    std::unordered_map<uint32_t, Stamp> stamps;
+    size_t stampCount = static_cast<size_t>(reader.get<uint64_t>());
+    if (stampCount > count + 1) {
+        StateReader::fail();
+    }
+    for (size_t i = 0; i < stampCount; ++i) {
+        uint32_t index = reader.get<uint32_t>();
+        Stamp stamp;
+        stamp.mtimeNs = reader.get<int64_t>();
+        stamp.ctimeNs = reader.get<int64_t>();
+        stamps[index] = stamp;
+    }
+
+    m_entries = std::move(entries);
+    m_stamps = std::move(stamps);
+}
+
+} // namespace fs
+} // namespace crossdev
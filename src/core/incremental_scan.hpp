@@ -0,0 +1,91 @@
+#ifndef CROSSDEV_INCREMENTAL_SCAN_HPP
+#define CROSSDEV_INCREMENTAL_SCAN_HPP
+
+#include "filesystem.hpp"
+#include "path_list.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Tuning for IncrementalScanner
+ */
+struct IncrementalOptions {
+    bool recursive = true;
+    /** Do not descend into directories on another device (mount points) */
+    bool oneFileSystem = false;
+    /**
+     * Refresh size and mtime of entries in unchanged directories. A file
+     * rewritten in place does not touch its directory, so without this
+     * its metadata is the one recorded by the last read of the directory.
+     */
+    bool restatFiles = false;
+    /**
+     * Directories changed less than this long before a scan are re-read
+     * by the next one, since coarse timestamps cannot order such changes
+     * against the scan
+     */
+    int64_t racyWindowNs = 2000000000;
+    /** Pool used to stat and read directories; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+/**
+ * Counters describing how much work the last scan() did
+ */
+struct IncrementalStats {
+    size_t directoriesRead = 0;
+    size_t directoriesReused = 0;
+    size_t filesRestated = 0;
+};
+
+/**
+ * Tree scanner that only re-reads directories that changed.
+ *
+ * Each directory's mtime and ctime are recorded with its listing. On the
+ * next scan() every directory is stat-ed once; when both times match, its
+ * previous listing is reused instead of being read and its entries
+ * stat-ed again. Subdirectories are always checked, since their changes
+ * do not propagate to the parent. The state can be saved to a file and
+ * loaded by a later process.
+ *
+ * Symlinks are not followed, and each physical directory is scanned once.
+ */
+class IncrementalScanner {
+public:
+    explicit IncrementalScanner(const Path& root, IncrementalOptions options = IncrementalOptions());
+
+    /** Bring the listing up to date and return it */
+    const PathList& scan();
+    const PathList& entries() const { return m_entries; }
+    const IncrementalStats& stats() const { return m_stats; }
+
+    /** Persist the current listing and directory times */
+    void save(const Path& file) const;
+    /** Restore state saved for the same root; throws if the file is invalid */
+    void load(const Path& file);
+
+private:
+    struct Stamp {
+        int64_t mtimeNs = 0;
+        int64_t ctimeNs = 0;
+    };
+
+    IncrementalOptions m_options;
+    PathList m_entries;
+    // Keyed by directory entry index; PathList::kRoot for the root itself
+    std::unordered_map<uint32_t, Stamp> m_stamps;
+    IncrementalStats m_stats;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_INCREMENTAL_SCAN_HPP
@@ -0,0 +1,247 @@
+#ifndef CROSSDEV_INDEX_FORMAT_HPP
+#define CROSSDEV_INDEX_FORMAT_HPP
+
+// Internal helpers shared by the memory-mappable index files (tree index,
+// name index, content index, packs). Not installed.
+//
+// Every file starts with a fixed header followed by 8-byte aligned
+// sections, so fixed-width columns can be used in place from the mapping.
+// Files are native-endian and carry a byte-order mark.
+
+#include "filesystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+namespace detail {
+
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct Section {
+    uint64_t offset;
+    uint64_t length;
+};
+
+/** Append a section padded to 8 bytes and record where it landed */
+inline Section appendSection(std::string& out, const void* data, size_t length) {
+    Section section{out.size(), length};
+    out.append(static_cast<const char*>(data), length);
+    out.resize((out.size() + 7) & ~size_t(7), '\0');
+    return section;
+}
+
+template <typename T>
+Section appendColumn(std::string& out, const std::vector<T>& column) {
+    return appendSection(out, column.data(), column.size() * sizeof(T));
+}
+
+/**
+ * Pointer to a section after checking that it is aligned, lies inside
+ * the file and, unless expectedLength is SIZE_MAX, has that length.
+ * Returns nullptr when the section is invalid.
+ */
+inline const char* sectionData(const char* base, uint64_t fileSize, const Section& section,
+                               uint64_t expectedLength = UINT64_MAX) {
+    if (section.offset % 8 != 0 || section.offset > fileSize || section.length > fileSize - section.offset ||
+        (expectedLength != UINT64_MAX && section.length != expectedLength)) {
+        return nullptr;
+    }
+    return base + section.offset;
+}
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+/** Decode one LEB128 value; returns nullptr if it runs past end */
+inline const uint8_t* getVarint(const uint8_t* position, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (unsigned shift = 0; shift < 64 && position != end; shift += 7) {
+        uint8_t byte = *position++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return position;
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Name beside file to write it under before renaming it into place:
+ * "<file>.<process token>-<sequence>.tmp", so concurrent writers of the
+ * same target, in this process or another, never share a temporary
+ */
+inline Path temporaryPathFor(const Path& file) {
+    static const uint64_t token = []() {
+        std::random_device device;
+        return (static_cast<uint64_t>(device()) << 32) ^ device();
+    }();
+    static std::atomic<uint64_t> sequence{0};
+    char suffix[48];
+    std::snprintf(suffix, sizeof(suffix), ".%016llx-%llu.tmp", static_cast<unsigned long long>(token),
+                  static_cast<unsigned long long>(sequence++));
+    return Path(file.toString() + suffix);
+}
+
+/**
+ * Write data beside file and rename it into place, so readers that still
+ * map the old file keep a consistent view and a crash never leaves a
+ * torn file
+ */
+inline void writeFileAtomically(const Path& file, const std::string& data) {
+    Path temporary = temporaryPathFor(file);
+    try {
+        {
+            std::ofstream stream(temporary.toString(), std::ios::binary | std::ios::trunc);
+            if (!stream.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+                throw FileSystemException("Could not write file: " + temporary.toString());
+            }
+        }
+        File(temporary).move(file);
+    } catch (...) {
+        if (temporary.exists()) {
+            File(temporary).remove();
+        }
+        throw;
+    }
+}
+
+/**
+ * Trigram table entry of the name and content indexes: the trigram, the
+ * length of its posting list and where that list starts
+ */
+struct TrigramEntry {
+    uint32_t trigram;
+    uint32_t count;
+    uint64_t offset;
+};
+
+static_assert(sizeof(TrigramEntry) == 16, "trigram table entries are stored as-is");
+
+/** Posting lists built by one shard of ids, keyed by trigram */
+using TrigramShard = std::unordered_map<uint32_t, std::vector<uint32_t>>;
+
+/**
+ * Distinct trigrams of short text such as a query, sorted, after passing
+ * every byte through map
+ */
+template <typename Map>
+void trigramsOf(std::string_view text, std::vector<uint32_t>& out, Map map) {
+    out.clear();
+    if (text.size() < 3) {
+        return;
+    }
+    uint32_t key = (static_cast<uint32_t>(map(text[0])) << 8) | map(text[1]);
+    for (size_t i = 2; i < text.size(); ++i) {
+        key = ((key << 8) | map(text[i])) & 0xFFFFFF;
+        out.push_back(key);
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+}
+
+/**
+ * Merge the shards' posting lists into one table sorted by trigram.
+ * Shards cover ascending id ranges, so appending them in order keeps
+ * every list sorted. emit(ids) stores one list and returns its offset.
+ */
+template <typename Emit>
+std::vector<TrigramEntry> mergeTrigramShards(const std::vector<TrigramShard>& shards, Emit emit) {
+    std::vector<uint32_t> keys;
+    for (const TrigramShard& shard : shards) {
+        for (const auto& entry : shard) {
+            keys.push_back(entry.first);
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+    std::vector<TrigramEntry> table;
+    table.reserve(keys.size());
+    std::vector<uint32_t> ids;
+    for (uint32_t key : keys) {
+        ids.clear();
+        for (const TrigramShard& shard : shards) {
+            auto found = shard.find(key);
+            if (found != shard.end()) {
+                ids.insert(ids.end(), found->second.begin(), found->second.end());
+            }
+        }
+        uint64_t offset = emit(ids);
+        table.push_back({key, static_cast<uint32_t>(ids.size()), offset});
+    }
+    return table;
+}
+
+/**
+ * Ids present in the posting list of every trigram, or none if any
+ * trigram is absent. find(trigram) returns the table entry or nullptr;
+ * load(entry, scratch) returns a pointer to the entry's count ids,
+ * decoding them into scratch if they are not stored as-is.
+ */
+template <typename Find, typename Load>
+std::vector<uint32_t> intersectTrigrams(const std::vector<uint32_t>& trigrams, Find find, Load load) {
+    std::vector<const TrigramEntry*> lists;
+    for (uint32_t trigram : trigrams) {
+        const TrigramEntry* entry = find(trigram);
+        if (entry == nullptr) {
+            return {};
+        }
+        lists.push_back(entry);
+    }
+    if (lists.empty()) {
+        return {};
+    }
+    // Shortest list first keeps every intersection step small
+    std::sort(lists.begin(), lists.end(),
+              [](const TrigramEntry* a, const TrigramEntry* b) { return a->count < b->count; });
+
+    std::vector<uint32_t> scratch;
+    const uint32_t* first = load(*lists.front(), scratch);
+    std::vector<uint32_t> ids(first, first + lists.front()->count);
+    for (size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+        const uint32_t* position = load(*lists[i], scratch);
+        const uint32_t* end = position + lists[i]->count;
+        size_t kept = 0;
+        for (uint32_t id : ids) {
+            position = std::lower_bound(position, end, id);
+            if (position == end) {
+                break;
+            }
+            if (*position == id) {
+                ids[kept++] = id;
+            }
+        }
+        ids.resize(kept);
+    }
+    return ids;
+}
+
+inline void lowerAsciiInPlace(std::string& text) {
+    for (char& c : text) {
+        if (c >= 'A' && c <= 'Z') {
+            c = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+}
+
+} // namespace detail
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_INDEX_FORMAT_HPP
@@ -0,0 +1,119 @@
+#include "filesystem.hpp"
+#include "simd.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+namespace crossdev {
+namespace fs {
+
+struct LineRange::State {
+    std::FILE* file = nullptr;
+    std::vector<char> buffer;
+    size_t begin = 0;   // Start of the unread data
+    size_t scanned = 0; // Data before this offset is known to hold no newline
+    size_t end = 0;     // End of the valid data
+    bool eof = false;
+
+    ~State() {
+        if (file != nullptr) {
+            std::fclose(file);
+        }
+    }
+};
+
+LineRange::LineRange(const Path& path, size_t bufferSize) : m_state(new State) {
+    m_state->file = std::fopen(path.toString().c_str(), "rb");
+    if (m_state->file == nullptr) {
+        throw FileSystemException("Could not open file for reading");
+    }
+    // The range does its own buffering; a second stdio buffer would only add a copy
+    std::setvbuf(m_state->file, nullptr, _IONBF, 0);
+    m_state->buffer.resize(bufferSize < 16 ? 16 : bufferSize);
+}
+
+LineRange::~LineRange() = default;
+LineRange::LineRange(LineRange&& other) noexcept = default;
+LineRange& LineRange::operator=(LineRange&& other) noexcept = default;
+
+bool LineRange::refill() {
+    State& state = *m_state;
+    if (state.eof) {
+        return false;
+    }
+
+    // Slide the partial line to the front, growing the buffer if it is full
+    size_t pending = state.end - state.begin;
+    if (state.begin > 0) {
+        std::memmove(state.buffer.data(), state.buffer.data() + state.begin, pending);
+        state.scanned -= state.begin;
+        state.begin = 0;
+        state.end = pending;
+    } else if (pending == state.buffer.size()) {
+        state.buffer.resize(state.buffer.size() * 2);
+    }
+
+    size_t read = std::fread(state.buffer.data() + state.end, 1, state.buffer.size() - state.end, state.file);
+    if (read == 0) {
+        if (std::ferror(state.file)) {
+            throw FileSystemException("Could not read file");
+        }
+        state.eof = true;
+        return false;
+    }
+    state.end += read;
+    return true;
+}
+
+bool LineRange::next(std::string_view& line) {
+    State& state = *m_state;
+    for (;;) {
+        const char* data = state.buffer.data();
+        const char* newline = simd::findByte(data + state.scanned, data + state.end, '\n');
+        if (newline != data + state.end) {
+            size_t length = static_cast<size_t>(newline - (data + state.begin));
+            if (length > 0 && newline[-1] == '\r') {
+                --length;
+            }
+            line = std::string_view(data + state.begin, length);
+            state.begin = static_cast<size_t>(newline - data) + 1;
+            state.scanned = state.begin;
+            return true;
+        }
+        state.scanned = state.end;
+
+        if (!refill()) {
+            if (state.begin == state.end) {
+                return false;
+            }
+            // Final line without a terminator
+            data = state.buffer.data();
+            size_t length = state.end - state.begin;
+            if (data[state.end - 1] == '\r') {
+                --length;
+            }
+            line = std::string_view(data + state.begin, length);
+            state.begin = state.end;
+            return true;
+        }
+    }
+}
+
+LineRange::iterator::iterator(LineRange* range) : m_range(range) {
+    ++*this;
+}
+
+LineRange::iterator& LineRange::iterator::operator++() {
+    if (m_range != nullptr && !m_range->next(m_line)) {
+        m_range = nullptr;
+        m_line = std::string_view();
+    }
+    return *this;
+}
+
+LineRange File::lines(size_t bufferSize) const {
+    return LineRange(m_path, bufferSize);
+}
+
+} // namespace fs
+} // namespace crossdev
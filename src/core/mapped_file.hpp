@@ -0,0 +1,45 @@
+#ifndef CROSSDEV_MAPPED_FILE_HPP
+#define CROSSDEV_MAPPED_FILE_HPP
+
+#include "filesystem.hpp"
+
+#include <cstddef>
+#include <string_view>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Read-only memory mapping of a whole file.
+ *
+ * The mapping stays valid for the lifetime of the object. Empty files map
+ * to an empty view without a kernel mapping.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const Path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return m_data; }
+    size_t size() const { return m_size; }
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+
+    /** Advise the kernel how the mapping will be accessed (madvise) */
+    void advise(AccessHint hint) const;
+
+private:
+    void release();
+
+    const char* m_data = nullptr;
+    size_t m_size = 0;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_MAPPED_FILE_HPP
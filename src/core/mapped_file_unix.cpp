@@ -0,0 +1,73 @@
+#include "mapped_file.hpp"
+#include "unix_io.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+MappedFile::MappedFile(const Path& path) {
+    int fd = ::open(path.toString().c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw FileSystemException("Could not open file for mapping");
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw FileSystemException("Could not get file size");
+    }
+
+    m_size = static_cast<size_t>(st.st_size);
+    if (m_size > 0) {
+        void* address = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+            ::close(fd);
+            throw FileSystemException("Could not map file");
+        }
+        m_data = static_cast<const char*>(address);
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::advise(AccessHint hint) const {
+    if (m_data != nullptr) {
+        detail::adviseMemory(m_data, m_size, hint);
+    }
+}
+
+void MappedFile::release() {
+    if (m_data != nullptr) {
+        munmap(const_cast<char*>(m_data), m_size);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
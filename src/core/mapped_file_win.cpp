@@ -0,0 +1,79 @@
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+
+#include <Windows.h>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+MappedFile::MappedFile(const Path& path) {
+    HANDLE file = CreateFileA(path.toString().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                              NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw FileSystemException("Could not open file for mapping");
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw FileSystemException("Could not get file size");
+    }
+
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL) {
+            CloseHandle(file);
+            throw FileSystemException("Could not map file");
+        }
+        void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (address == NULL) {
+            CloseHandle(file);
+            throw FileSystemException("Could not map file");
+        }
+        m_data = static_cast<const char*>(address);
+    }
+    CloseHandle(file);
+}
+
+MappedFile::~MappedFile() {
+    release();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_data(std::exchange(other.m_data, nullptr)),
+      m_size(std::exchange(other.m_size, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        release();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+    }
+    return *this;
+}
+
+void MappedFile::advise(AccessHint hint) const {
+    if (m_data != nullptr && hint == AccessHint::WillNeed) {
+        WIN32_MEMORY_RANGE_ENTRY range;
+        range.VirtualAddress = const_cast<char*>(m_data);
+        range.NumberOfBytes = m_size;
+        PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+}
+
+void MappedFile::release() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+        m_data = nullptr;
+        m_size = 0;
+    }
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // _WIN32
@@ -0,0 +1,328 @@
+#include "name_index.hpp"
+#include "index_format.hpp"
+#include "mapped_file.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'D', 'X', 'N', 'A', 'M', 'E', '\0'};
+constexpr uint32_t kVersion = 1;
+// Paths handled by one build task
+constexpr size_t kShardSize = 1 << 14;
+
+using detail::Section;
+using detail::TrigramEntry;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t pathCount;
+    uint64_t trigramCount;
+    Section pathOffsets;
+    Section pathBytes;
+    Section trigrams;
+    Section postings;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "sections after the header must stay 8-byte aligned");
+
+[[noreturn]] void corrupt() {
+    throw FileSystemException("Corrupt name index");
+}
+
+inline uint8_t fold(char c) {
+    return static_cast<uint8_t>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+}
+
+// Distinct case-folded trigrams of text, sorted
+void trigramsOf(std::string_view text, std::vector<uint32_t>& out) {
+    detail::trigramsOf(text, out, fold);
+}
+
+// Case-insensitive check; needle must already be folded
+bool containsFolded(std::string_view haystack, const std::string& needle, std::string& scratch) {
+    scratch.assign(haystack.data(), haystack.size());
+    detail::lowerAsciiInPlace(scratch);
+    const char* end = scratch.data() + scratch.size();
+    return simd::findLiteral(scratch.data(), end, needle.data(), needle.size()) != end;
+}
+
+// Serialise sorted, distinct paths into the on-disk layout
+std::string serialize(const std::vector<std::string>& paths, ThreadPool& pool) {
+    const size_t count = paths.size();
+    if (count >= UINT32_MAX) {
+        throw FileSystemException("Too many paths for a name index");
+    }
+
+    // Each shard covers a contiguous id range
+    size_t shards = (count + kShardSize - 1) / kShardSize;
+    std::vector<detail::TrigramShard> partial(shards);
+    pool.parallelFor(shards, [&](size_t shard) {
+        std::vector<uint32_t> trigrams;
+        auto& postings = partial[shard];
+        size_t end = std::min(count, (shard + 1) * kShardSize);
+        for (size_t id = shard * kShardSize; id < end; ++id) {
+            trigramsOf(paths[id], trigrams);
+            for (uint32_t trigram : trigrams) {
+                postings[trigram].push_back(static_cast<uint32_t>(id));
+            }
+        }
+    });
+
+    std::vector<uint32_t> postings;
+    std::vector<TrigramEntry> table = detail::mergeTrigramShards(partial, [&](const std::vector<uint32_t>& ids) {
+        uint64_t offset = postings.size();
+        postings.insert(postings.end(), ids.begin(), ids.end());
+        return offset;
+    });
+
+    std::vector<uint64_t> offsets{0};
+    std::string bytes;
+    for (const std::string& path : paths) {
+        bytes += path;
+        offsets.push_back(bytes.size());
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = detail::kByteOrderMark;
+    header.pathCount = count;
+    header.trigramCount = table.size();
+
+    std::string out(sizeof(Header), '\0');
+    header.pathOffsets = detail::appendColumn(out, offsets);
+    header.pathBytes = detail::appendSection(out, bytes.data(), bytes.size());
+    header.trigrams = detail::appendColumn(out, table);
+    header.postings = detail::appendColumn(out, postings);
+    std::memcpy(&out[0], &header, sizeof(header));
+    return out;
+}
+
+} // namespace
+
+struct NameIndex::Base {
+    std::string owned;
+    std::unique_ptr<MappedFile> mapped;
+    const char* data = nullptr;
+    size_t length = 0;
+
+    size_t pathCount = 0;
+    const uint64_t* pathOffsets = nullptr;
+    const char* pathBytes = nullptr;
+    uint64_t pathBytesLength = 0;
+    size_t trigramCount = 0;
+    const TrigramEntry* trigrams = nullptr;
+    const uint32_t* postings = nullptr;
+    uint64_t postingCount = 0;
+
+    void attach(const char* bytes, size_t size) {
+        data = bytes;
+        length = size;
+        if (size < sizeof(Header)) {
+            corrupt();
+        }
+        Header header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            header.byteOrder != detail::kByteOrderMark || header.pathCount >= size ||
+            header.trigramCount > size) {
+            corrupt();
+        }
+        auto check = [&](const Section& section, uint64_t expected = UINT64_MAX) {
+            const char* result = detail::sectionData(bytes, size, section, expected);
+            if (result == nullptr) {
+                corrupt();
+            }
+            return result;
+        };
+        pathCount = static_cast<size_t>(header.pathCount);
+        pathOffsets = reinterpret_cast<const uint64_t*>(check(header.pathOffsets, (header.pathCount + 1) * 8));
+        pathBytes = check(header.pathBytes);
+        pathBytesLength = header.pathBytes.length;
+        trigramCount = static_cast<size_t>(header.trigramCount);
+        trigrams = reinterpret_cast<const TrigramEntry*>(check(header.trigrams, header.trigramCount * 16));
+        postings = reinterpret_cast<const uint32_t*>(check(header.postings));
+        postingCount = header.postings.length / 4;
+    }
+
+    std::string_view path(size_t id) const {
+        uint64_t begin = pathOffsets[id];
+        uint64_t end = pathOffsets[id + 1];
+        if (begin > end || end > pathBytesLength) {
+            corrupt();
+        }
+        return std::string_view(pathBytes + begin, static_cast<size_t>(end - begin));
+    }
+
+    const TrigramEntry* find(uint32_t trigram) const {
+        const TrigramEntry* end = trigrams + trigramCount;
+        const TrigramEntry* found = std::lower_bound(
+            trigrams, end, trigram, [](const TrigramEntry& entry, uint32_t key) { return entry.trigram < key; });
+        if (found == end || found->trigram != trigram) {
+            return nullptr;
+        }
+        if (found->offset > postingCount || found->count > postingCount - found->offset) {
+            corrupt();
+        }
+        return found;
+    }
+};
+
+NameIndex::NameIndex() : m_base(new Base()) {}
+NameIndex::NameIndex(NameIndex&&) noexcept = default;
+NameIndex& NameIndex::operator=(NameIndex&&) noexcept = default;
+NameIndex::~NameIndex() = default;
+
+NameIndex NameIndex::build(const PathList& entries, ThreadPool* pool) {
+    ThreadPool& workers = pool ? *pool : ThreadPool::io();
+    std::vector<std::string> paths(entries.size());
+    size_t chunks = (paths.size() + kShardSize - 1) / kShardSize;
+    workers.parallelFor(chunks, [&](size_t chunk) {
+        size_t end = std::min(paths.size(), (chunk + 1) * kShardSize);
+        for (size_t i = chunk * kShardSize; i < end; ++i) {
+            entries.relativePathInto(i, paths[i]);
+        }
+    });
+    return build(std::move(paths), &workers);
+}
+
+NameIndex NameIndex::build(std::vector<std::string> paths, ThreadPool* pool) {
+    std::sort(paths.begin(), paths.end());
+    paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+
+    NameIndex index;
+    index.m_base->owned = serialize(paths, pool ? *pool : ThreadPool::io());
+    index.m_base->attach(index.m_base->owned.data(), index.m_base->owned.size());
+    index.m_removed.assign(index.m_base->pathCount, false);
+    return index;
+}
+
+NameIndex NameIndex::open(const Path& file) {
+    NameIndex index;
+    index.m_base->mapped = std::make_unique<MappedFile>(file);
+    index.m_base->attach(index.m_base->mapped->data(), index.m_base->mapped->size());
+    index.m_removed.assign(index.m_base->pathCount, false);
+    return index;
+}
+
+void NameIndex::save(const Path& file, ThreadPool* pool) const {
+    if (m_added.empty() && m_removedCount == 0) {
+        detail::writeFileAtomically(file, std::string(m_base->data, m_base->length));
+        return;
+    }
+    detail::writeFileAtomically(file, serialize(livePaths(), pool ? *pool : ThreadPool::io()));
+}
+
+size_t NameIndex::findBase(std::string_view path) const {
+    size_t low = 0;
+    size_t high = m_base->pathCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (m_base->path(middle) < path) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < m_base->pathCount && m_base->path(low) == path ? low : SIZE_MAX;
+}
+
+void NameIndex::add(std::string_view path) {
+    size_t id = findBase(path);
+    if (id == SIZE_MAX) {
+        m_added.emplace(path);
+    } else if (m_removed[id]) {
+        m_removed[id] = false;
+        --m_removedCount;
+    }
+}
+
+void NameIndex::remove(std::string_view path) {
+    auto added = m_added.find(path);
+    if (added != m_added.end()) {
+        m_added.erase(added);
+        return;
+    }
+    size_t id = findBase(path);
+    if (id != SIZE_MAX && !m_removed[id]) {
+        m_removed[id] = true;
+        ++m_removedCount;
+    }
+}
+
+size_t NameIndex::size() const {
+    return m_base->pathCount - m_removedCount + m_added.size();
+}
+
+std::vector<std::string> NameIndex::livePaths() const {
+    std::vector<std::string> paths;
+    paths.reserve(size());
+    for (size_t id = 0; id < m_base->pathCount; ++id) {
+        if (!m_removed[id]) {
+            paths.emplace_back(m_base->path(id));
+        }
+    }
+    paths.insert(paths.end(), m_added.begin(), m_added.end());
+    return paths;
+}
+
+std::vector<std::string> NameIndex::search(std::string_view text, size_t limit) const {
+    std::string needle(text);
+    detail::lowerAsciiInPlace(needle);
+    std::vector<std::string> result;
+    std::string scratch;
+    if (limit == 0) {
+        return result;
+    }
+
+    auto consider = [&](std::string_view path) {
+        if (containsFolded(path, needle, scratch)) {
+            result.emplace_back(path);
+        }
+        return result.size() < limit;
+    };
+
+    std::vector<uint32_t> trigrams;
+    trigramsOf(needle, trigrams);
+    if (trigrams.empty()) {
+        // Too short to index: check every live path
+        for (size_t id = 0; id < m_base->pathCount; ++id) {
+            if (!m_removed[id] && !consider(m_base->path(id))) {
+                return result;
+            }
+        }
+    } else {
+        std::vector<uint32_t> candidates = detail::intersectTrigrams(
+            trigrams, [&](uint32_t trigram) { return m_base->find(trigram); },
+            [&](const TrigramEntry& entry, std::vector<uint32_t>&) { return m_base->postings + entry.offset; });
+        // Trigrams do not encode order, so every candidate is confirmed
+        for (uint32_t id : candidates) {
+            if (id >= m_base->pathCount) {
+                corrupt();
+            }
+            if (!m_removed[id] && !consider(m_base->path(id))) {
+                return result;
+            }
+        }
+    }
+
+    for (const std::string& path : m_added) {
+        if (!consider(path)) {
+            break;
+        }
+    }
+    return result;
+}
+
+} // namespace fs
+} // namespace crossdev
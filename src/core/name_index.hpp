@@ -0,0 +1,82 @@
+#ifndef CROSSDEV_NAME_INDEX_HPP
+#define CROSSDEV_NAME_INDEX_HPP
+
+#include "filesystem.hpp"
+#include "path_list.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Trigram index over relative paths for locate-style substring search.
+ *
+ * Every path is broken into overlapping 3-byte sequences (ASCII letters
+ * folded to lower case). For each trigram the index keeps the sorted ids
+ * of the paths that contain it. A query intersects the posting lists of
+ * its own trigrams, starting with the shortest, and confirms the few
+ * remaining candidates with a substring check. Queries shorter than three
+ * bytes fall back to checking every path. Matching is case-insensitive
+ * for ASCII.
+ *
+ * The built index is a single memory-mappable block: save() writes it and
+ * open() maps it back without parsing. add() and remove() record changes
+ * in a small in-memory overlay that queries merge in; save() folds the
+ * overlay into a fresh base.
+ */
+class NameIndex {
+public:
+    /** Build from the entries of a walk, in parallel on pool (default ThreadPool::io()) */
+    static NameIndex build(const PathList& entries, ThreadPool* pool = nullptr);
+    static NameIndex build(std::vector<std::string> paths, ThreadPool* pool = nullptr);
+
+    /** Map an index written by save() */
+    static NameIndex open(const Path& file);
+
+    /** Write base and overlay as one index; the file is replaced atomically */
+    void save(const Path& file, ThreadPool* pool = nullptr) const;
+
+    void add(std::string_view path);
+    void remove(std::string_view path);
+
+    /** Number of live paths, overlay included */
+    size_t size() const;
+
+    /** Paths containing text; base matches come in sorted order, then added paths */
+    std::vector<std::string> search(std::string_view text,
+                                    size_t limit = std::numeric_limits<size_t>::max()) const;
+
+    NameIndex(NameIndex&&) noexcept;
+    NameIndex& operator=(NameIndex&&) noexcept;
+    ~NameIndex();
+
+private:
+    struct Base;
+
+    NameIndex();
+
+    // Index of path in the base, or SIZE_MAX
+    size_t findBase(std::string_view path) const;
+    std::vector<std::string> livePaths() const;
+
+    std::unique_ptr<Base> m_base;
+    std::set<std::string, std::less<>> m_added;
+    std::vector<bool> m_removed;
+    size_t m_removedCount = 0;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_NAME_INDEX_HPP
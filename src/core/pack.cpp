@@ -0,0 +1,292 @@
+#include "pack.hpp"
+#include "hash.hpp"
+#include "index_format.hpp"
+#include "mapped_file.hpp"
+#include "stream.hpp"
+#include "thread_pool.hpp"
+#include "walker.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'D', 'X', 'P', 'A', 'C', 'K', '\0'};
+constexpr uint32_t kVersion = 1;
+// Files mapped per batch at most, whatever their size
+constexpr size_t kMaxBatchFiles = 4096;
+
+using detail::Section;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileCount;
+    uint64_t slotCount;
+    Section pathOffsets;
+    Section pathBytes;
+    Section slots;
+    Section data;
+    Section entries;
+};
+
+struct StoredEntry {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t hash;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "sections after the header must stay 8-byte aligned");
+static_assert(sizeof(StoredEntry) == 24, "entries are stored as-is");
+
+[[noreturn]] void corrupt() {
+    throw FileSystemException("Corrupt pack file");
+}
+
+// Slots hold (id + 1) in the low half and the path hash's high half
+// above it, so most mismatching probes are rejected without a compare
+uint64_t makeSlot(size_t id, uint64_t pathHash) {
+    return (pathHash & 0xFFFFFFFF00000000ull) | (static_cast<uint64_t>(id) + 1);
+}
+
+struct PlannedFile {
+    std::string path;
+    uint64_t size;
+};
+
+} // namespace
+
+struct Pack::Mapping {
+    MappedFile file;
+    size_t count = 0;
+    const uint64_t* pathOffsets = nullptr;
+    const char* pathBytes = nullptr;
+    uint64_t pathBytesLength = 0;
+    const uint64_t* slots = nullptr;
+    uint64_t slotMask = 0;
+    const char* data = nullptr;
+    uint64_t dataLength = 0;
+    const StoredEntry* entries = nullptr;
+
+    explicit Mapping(const Path& path) : file(path) {
+        const char* bytes = file.data();
+        size_t size = file.size();
+        if (size < sizeof(Header)) {
+            corrupt();
+        }
+        Header header;
+        std::memcpy(&header, bytes, sizeof(header));
+        // The slot count is a power of two above the file count, so lookups always hit an empty slot
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+            header.byteOrder != detail::kByteOrderMark || header.fileCount >= size || header.slotCount > size ||
+            header.slotCount <= header.fileCount || (header.slotCount & (header.slotCount - 1)) != 0) {
+            corrupt();
+        }
+        auto check = [&](const Section& section, uint64_t expected = UINT64_MAX) {
+            const char* result = detail::sectionData(bytes, size, section, expected);
+            if (result == nullptr) {
+                corrupt();
+            }
+            return result;
+        };
+        const uint64_t n = header.fileCount;
+        count = static_cast<size_t>(n);
+        pathOffsets = reinterpret_cast<const uint64_t*>(check(header.pathOffsets, (n + 1) * 8));
+        pathBytes = check(header.pathBytes);
+        pathBytesLength = header.pathBytes.length;
+        slots = reinterpret_cast<const uint64_t*>(check(header.slots, header.slotCount * 8));
+        slotMask = header.slotCount - 1;
+        data = check(header.data);
+        dataLength = header.data.length;
+        entries = reinterpret_cast<const StoredEntry*>(check(header.entries, n * sizeof(StoredEntry)));
+    }
+
+    std::string_view path(size_t index) const {
+        uint64_t begin = pathOffsets[index];
+        uint64_t end = pathOffsets[index + 1];
+        if (begin > end || end > pathBytesLength) {
+            corrupt();
+        }
+        return std::string_view(pathBytes + begin, static_cast<size_t>(end - begin));
+    }
+
+    PackEntry entry(size_t index) const {
+        const StoredEntry& stored = entries[index];
+        if (stored.offset > dataLength || stored.length > dataLength - stored.offset) {
+            corrupt();
+        }
+        return {std::string_view(data + stored.offset, static_cast<size_t>(stored.length)), stored.hash};
+    }
+};
+
+Pack::Pack(std::unique_ptr<Mapping> mapping) : m_mapping(std::move(mapping)) {}
+Pack::Pack(Pack&&) noexcept = default;
+Pack& Pack::operator=(Pack&&) noexcept = default;
+Pack::~Pack() = default;
+
+Pack Pack::open(const Path& file) {
+    return Pack(std::make_unique<Mapping>(file));
+}
+
+size_t Pack::size() const {
+    return m_mapping->count;
+}
+
+std::string_view Pack::path(size_t index) const {
+    return m_mapping->path(index);
+}
+
+PackEntry Pack::entry(size_t index) const {
+    return m_mapping->entry(index);
+}
+
+bool Pack::find(std::string_view path, PackEntry& entry) const {
+    const Mapping& mapping = *m_mapping;
+    uint64_t pathHash = hash64(path.data(), path.size());
+    uint64_t tag = pathHash & 0xFFFFFFFF00000000ull;
+    // A valid table always has an empty slot; a corrupt one may not, so never probe more than once round
+    uint64_t slot = pathHash & mapping.slotMask;
+    for (uint64_t probe = 0; probe <= mapping.slotMask; ++probe, slot = (slot + 1) & mapping.slotMask) {
+        uint64_t value = mapping.slots[slot];
+        if (value == 0) {
+            return false;
+        }
+        uint64_t id = (value & 0xFFFFFFFF) - 1;
+        if ((value & 0xFFFFFFFF00000000ull) == tag && id < mapping.count && mapping.path(id) == path) {
+            entry = mapping.entry(id);
+            return true;
+        }
+    }
+    return false;
+}
+
+PackStats Pack::build(const Path& root, const Path& file, PackOptions options) {
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::io();
+
+    WalkOptions walkOptions;
+    walkOptions.pool = &pool;
+    PathList entries = Walker(walkOptions).scan(root);
+
+    std::vector<PlannedFile> files;
+    std::string relative;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries.type(i) == EntryType::File) {
+            entries.relativePathInto(i, relative);
+            if (Path::separator() != '/') {
+                std::replace(relative.begin(), relative.end(), Path::separator(), '/');
+            }
+            files.push_back({relative, entries.fileSize(i)});
+        }
+    }
+    std::sort(files.begin(), files.end(),
+              [](const PlannedFile& a, const PlannedFile& b) { return a.path < b.path; });
+    const size_t count = files.size();
+    if (count >= UINT32_MAX) {
+        throw FileSystemException("Too many files for a pack: " + root.toString());
+    }
+
+    // Everything but the contents and their hashes is known from the walk
+    std::vector<uint64_t> pathOffsets{0};
+    std::string pathBytes;
+    std::vector<StoredEntry> stored(count);
+    uint64_t dataLength = 0;
+    for (size_t i = 0; i < count; ++i) {
+        pathBytes += files[i].path;
+        pathOffsets.push_back(pathBytes.size());
+        stored[i].offset = dataLength;
+        stored[i].length = files[i].size;
+        dataLength += files[i].size;
+    }
+
+    uint64_t slotCount = 2;
+    while (slotCount < count * 2) {
+        slotCount <<= 1;
+    }
+    std::vector<uint64_t> slots(slotCount, 0);
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t pathHash = hash64(files[i].path.data(), files[i].path.size());
+        uint64_t slot = pathHash & (slotCount - 1);
+        while (slots[slot] != 0) {
+            slot = (slot + 1) & (slotCount - 1);
+        }
+        slots[slot] = makeSlot(i, pathHash);
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = detail::kByteOrderMark;
+    header.fileCount = count;
+    header.slotCount = slotCount;
+
+    std::string index(sizeof(Header), '\0');
+    header.pathOffsets = detail::appendColumn(index, pathOffsets);
+    header.pathBytes = detail::appendSection(index, pathBytes.data(), pathBytes.size());
+    header.slots = detail::appendColumn(index, slots);
+    header.data = {index.size(), dataLength};
+    uint64_t dataEnd = (index.size() + dataLength + 7) & ~uint64_t(7);
+    header.entries = {dataEnd, count * sizeof(StoredEntry)};
+    std::memcpy(&index[0], &header, sizeof(header));
+
+    Path temporary = detail::temporaryPathFor(file);
+    try {
+        FileWriter writer(temporary);
+        writer.reserve(header.entries.offset + header.entries.length);
+        writer.write(index.data(), index.size());
+
+        // Map and hash one batch in parallel, then stream it out in order
+        std::vector<std::unique_ptr<MappedFile>> batch;
+        for (size_t first = 0; first < count;) {
+            size_t last = first;
+            uint64_t batchBytes = 0;
+            while (last < count && last - first < kMaxBatchFiles &&
+                   (last == first || batchBytes + files[last].size <= options.batchBytes)) {
+                batchBytes += files[last].size;
+                ++last;
+            }
+
+            batch.clear();
+            batch.resize(last - first);
+            pool.parallelFor(last - first, [&](size_t k) {
+                const PlannedFile& planned = files[first + k];
+                auto mapped = std::make_unique<MappedFile>(root / planned.path);
+                if (mapped->size() != planned.size) {
+                    throw FileSystemException("File changed while packing: " + (root / planned.path).toString());
+                }
+                mapped->advise(AccessHint::Sequential);
+                stored[first + k].hash = hash64(mapped->data(), mapped->size());
+                batch[k] = std::move(mapped);
+            });
+            for (const auto& mapped : batch) {
+                writer.write(mapped->data(), mapped->size());
+            }
+            first = last;
+        }
+
+        static const char padding[8] = {};
+        writer.write(padding, static_cast<size_t>(dataEnd - (index.size() + dataLength)));
+        writer.write(stored.data(), stored.size() * sizeof(StoredEntry));
+        writer.close();
+        File(temporary).move(file);
+    } catch (...) {
+        // A file that changed or vanished mid-build must not leave a partial pack behind
+        if (temporary.exists()) {
+            File(temporary).remove();
+        }
+        throw;
+    }
+
+    PackStats stats;
+    stats.files = count;
+    stats.bytes = dataLength;
+    return stats;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,89 @@
+#ifndef CROSSDEV_PACK_HPP
+#define CROSSDEV_PACK_HPP
+
+#include "filesystem.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Tuning for Pack::build()
+ */
+struct PackOptions {
+    /** Contents mapped and hashed ahead of the writer, at most */
+    size_t batchBytes = 64 * 1024 * 1024;
+    /** Pool that reads and hashes files; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+struct PackStats {
+    size_t files = 0;
+    uint64_t bytes = 0;
+};
+
+/**
+ * A file stored in a pack: a view into the mapping plus the XXH64 hash
+ * of its contents
+ */
+struct PackEntry {
+    std::string_view data;
+    uint64_t hash = 0;
+};
+
+/**
+ * Read-only archive of many small files, for serving without per-file
+ * open/read/close.
+ *
+ * A pack is one file holding the contents of every regular file below a
+ * directory back to back, plus a sorted path table, an (offset, length,
+ * hash) column and an open-addressing hash table over the paths. open()
+ * maps it; find() costs one hash of the path, usually one probe and one
+ * comparison, and returns a view into the mapping without copying.
+ *
+ * Paths are relative to the packed root and always use '/' separators.
+ */
+class Pack {
+public:
+    /**
+     * Pack every regular file below root into file, replacing it
+     * atomically. Files are mapped and hashed in parallel batches and
+     * streamed to disk in path order. Throws if a file changes size
+     * while it is being packed.
+     */
+    static PackStats build(const Path& root, const Path& file, PackOptions options = PackOptions());
+
+    /** Map a pack written by build(); throws if the file is invalid */
+    static Pack open(const Path& file);
+
+    Pack(Pack&&) noexcept;
+    Pack& operator=(Pack&&) noexcept;
+    ~Pack();
+
+    size_t size() const;
+    /** Path of the i-th file, in sorted order */
+    std::string_view path(size_t index) const;
+    PackEntry entry(size_t index) const;
+
+    /** Look a file up by relative path; false if the pack does not hold it */
+    bool find(std::string_view path, PackEntry& entry) const;
+
+private:
+    struct Mapping;
+
+    explicit Pack(std::unique_ptr<Mapping> mapping);
+
+    std::unique_ptr<Mapping> m_mapping;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_PACK_HPP
@@ -0,0 +1,248 @@
+#include "filesystem.hpp"
+
+#include <cctype>
+#include <cstring>
+
+// Lexical (string-only) Path operations shared by every platform. None of
+// these touch the filesystem, and none allocate beyond growing the result.
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+inline bool isSeparator(char c) {
+    return c == '/' || c == Path::separator();
+}
+
+// Length of the root prefix: "/" on POSIX, "C:\" or "\" on Windows
+size_t rootLength(std::string_view path) {
+    if (Path::separator() == '\\' && path.size() >= 2 && std::isalpha(static_cast<unsigned char>(path[0])) &&
+        path[1] == ':') {
+        return path.size() > 2 && isSeparator(path[2]) ? 3 : 2;
+    }
+    return !path.empty() && isSeparator(path[0]) ? 1 : 0;
+}
+
+bool isAbsolutePath(std::string_view path) {
+    size_t root = rootLength(path);
+    return root > 0 && isSeparator(path[root - 1]);
+}
+
+// Rewrite foreign separators in [from, end) and drop a trailing separator
+void canonicalizeTail(std::string& path, size_t from) {
+    const char native = Path::separator();
+    for (size_t i = from; i < path.size(); ++i) {
+        if (isSeparator(path[i])) {
+            path[i] = native;
+        }
+    }
+    size_t root = rootLength(path);
+    while (path.size() > root && path.back() == native) {
+        path.pop_back();
+    }
+}
+
+} // namespace
+
+bool Path::isAbsolute() const {
+    return isAbsolutePath(m_path);
+}
+
+Path& Path::append(std::string_view component) {
+    if (component.empty()) {
+        return *this;
+    }
+    if (isAbsolutePath(component)) {
+        m_path.assign(component.data(), component.size());
+        canonicalizeTail(m_path, 0);
+        return *this;
+    }
+
+    if (!m_path.empty() && !isSeparator(m_path.back())) {
+        m_path.push_back(separator());
+    }
+    size_t from = m_path.size();
+    m_path.append(component.data(), component.size());
+    canonicalizeTail(m_path, from);
+    return *this;
+}
+
+Path& Path::normalize() {
+    const char native = separator();
+    const size_t root = rootLength(m_path);
+    const bool absolute = isAbsolutePath(m_path);
+    const size_t size = m_path.size();
+    char* p = &m_path[0];
+
+    for (size_t i = 0; i < root; ++i) {
+        if (isSeparator(p[i])) {
+            p[i] = native;
+        }
+    }
+
+    // The output never outgrows the input read so far, so this rewrites
+    // the string in place with a trailing write cursor
+    size_t write = root;
+    size_t read = root;
+    while (read < size) {
+        while (read < size && isSeparator(p[read])) {
+            ++read;
+        }
+        if (read >= size) {
+            break;
+        }
+        size_t end = read;
+        while (end < size && !isSeparator(p[end])) {
+            ++end;
+        }
+        size_t length = end - read;
+
+        if (length == 1 && p[read] == '.') {
+            read = end;
+            continue;
+        }
+        if (length == 2 && p[read] == '.' && p[read + 1] == '.') {
+            size_t last = write;
+            while (last > root && p[last - 1] != native) {
+                --last;
+            }
+            bool lastIsParent = write - last == 2 && p[last] == '.' && p[last + 1] == '.';
+            if (write > root && !lastIsParent) {
+                // Drop the previous component together with its separator
+                write = last > root ? last - 1 : root;
+                read = end;
+                continue;
+            }
+            if (absolute) {
+                // ".." at the root stays at the root
+                read = end;
+                continue;
+            }
+        }
+
+        if (write > root) {
+            p[write++] = native;
+        }
+        std::memmove(p + write, p + read, length);
+        write += length;
+        read = end;
+    }
+
+    m_path.resize(write);
+    if (m_path.empty()) {
+        m_path = ".";
+    }
+    return *this;
+}
+
+Path Path::lexicallyNormal() const {
+    Path result(*this);
+    result.normalize();
+    return result;
+}
+
+void Path::relativeTo(const Path& base, std::string& out) const {
+    out.clear();
+    std::string_view self = m_path;
+    std::string_view other = base.m_path;
+    if (isAbsolutePath(self) != isAbsolutePath(other)) {
+        return;
+    }
+
+    ComponentRange selfComponents = components();
+    ComponentRange baseComponents = base.components();
+    ComponentIterator a = selfComponents.begin();
+    ComponentIterator b = baseComponents.begin();
+    const ComponentIterator aEnd = selfComponents.end();
+    const ComponentIterator bEnd = baseComponents.end();
+
+    bool first = true;
+    while (a != aEnd && b != bEnd && *a == *b) {
+        ++a;
+        ++b;
+        first = false;
+    }
+    // Different roots (e.g. another drive) have no relative form
+    if (first && rootLength(self) > 0) {
+        return;
+    }
+
+    const char native = separator();
+    for (; b != bEnd; ++b) {
+        if (*b == ".") {
+            continue;
+        }
+        if (*b == "..") {
+            // Climbing out of an unknown parent cannot be expressed
+            out.clear();
+            return;
+        }
+        out.append("..");
+        out.push_back(native);
+    }
+    for (; a != aEnd; ++a) {
+        out.append(a->data(), a->size());
+        out.push_back(native);
+    }
+
+    if (out.empty()) {
+        out = ".";
+    } else {
+        out.pop_back();
+    }
+}
+
+Path Path::relativeTo(const Path& base) const {
+    std::string result;
+    relativeTo(base, result);
+    return Path(std::move(result), NativeTag{});
+}
+
+Path::ComponentRange Path::components() const {
+    return ComponentRange(m_path);
+}
+
+Path::ComponentIterator::ComponentIterator(std::string_view path, size_t position) : m_path(path) {
+    if (position == 0) {
+        size_t root = rootLength(path);
+        if (root > 0) {
+            m_current = path.substr(0, root);
+            return;
+        }
+    }
+    m_current = path.substr(position, 0);
+    if (position < path.size()) {
+        ++*this;
+    }
+}
+
+Path::ComponentIterator& Path::ComponentIterator::operator++() {
+    size_t position = static_cast<size_t>(m_current.data() - m_path.data()) + m_current.size();
+    while (position < m_path.size() && isSeparator(m_path[position])) {
+        ++position;
+    }
+    size_t end = position;
+    while (end < m_path.size() && !isSeparator(m_path[end])) {
+        ++end;
+    }
+    m_current = m_path.substr(position, end - position);
+    return *this;
+}
+
+Path operator/(const Path& lhs, std::string_view rhs) {
+    std::string joined;
+    joined.reserve(lhs.m_path.size() + 1 + rhs.size());
+    joined.assign(lhs.m_path);
+    Path result(std::move(joined), Path::NativeTag{});
+    result.append(rhs);
+    return result;
+}
+
+Path operator/(Path&& lhs, std::string_view rhs) {
+    lhs.append(rhs);
+    return std::move(lhs);
+}
+
+} // namespace fs
+} // namespace crossdev
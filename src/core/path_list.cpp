@@ -0,0 +1,86 @@
+#include "path_list.hpp"
+
+#include <limits>
+
+namespace crossdev {
+namespace fs {
+
+PathList::PathList(const Path& root) : m_root(root), m_nameOffsets(1, 0) {}
+
+uint32_t PathList::add(uint32_t parent, std::string_view name, EntryType type, uint64_t size, int64_t mtimeNs) {
+    if (m_names.size() + name.size() > std::numeric_limits<uint32_t>::max() ||
+        m_parents.size() >= std::numeric_limits<uint32_t>::max() - 1) {
+        throw FileSystemException("Path list is full");
+    }
+    uint32_t index = static_cast<uint32_t>(m_parents.size());
+    m_names.insert(m_names.end(), name.begin(), name.end());
+    m_nameOffsets.push_back(static_cast<uint32_t>(m_names.size()));
+    m_parents.push_back(parent);
+    m_types.push_back(type);
+    m_sizes.push_back(size);
+    m_mtimes.push_back(mtimeNs);
+    return index;
+}
+
+void PathList::reserve(size_t entries, size_t nameBytes) {
+    m_names.reserve(nameBytes > 0 ? nameBytes : entries * 16);
+    m_nameOffsets.reserve(entries + 1);
+    m_parents.reserve(entries);
+    m_types.reserve(entries);
+    m_sizes.reserve(entries);
+    m_mtimes.reserve(entries);
+}
+
+void PathList::buildPath(size_t index, std::string& out, bool withRoot) const {
+    const char separator = Path::separator();
+    std::string_view root = withRoot ? m_root.view() : std::string_view();
+    size_t prefix = root.size();
+    if (!root.empty() && root.back() != '/' && root.back() != separator) {
+        ++prefix;
+    }
+
+    // Measure first so the components can be written back to front
+    size_t length = 0;
+    for (uint32_t i = static_cast<uint32_t>(index); i != kRoot; i = m_parents[i]) {
+        length += name(i).size() + 1;
+    }
+    out.resize(prefix + length - 1);
+    out.replace(0, root.size(), root.data(), root.size());
+    if (prefix > root.size()) {
+        out[root.size()] = separator;
+    }
+
+    size_t end = out.size();
+    for (uint32_t i = static_cast<uint32_t>(index); i != kRoot; i = m_parents[i]) {
+        std::string_view component = name(i);
+        end -= component.size();
+        out.replace(end, component.size(), component.data(), component.size());
+        if (end > prefix) {
+            out[--end] = separator;
+        }
+    }
+}
+
+void PathList::pathInto(size_t index, std::string& out) const {
+    buildPath(index, out, true);
+}
+
+void PathList::relativePathInto(size_t index, std::string& out) const {
+    buildPath(index, out, false);
+}
+
+Path PathList::path(size_t index) const {
+    std::string result;
+    result.reserve(m_root.view().size() + 64);
+    pathInto(index, result);
+    return Path(std::move(result));
+}
+
+size_t PathList::memoryUsage() const {
+    return m_names.capacity() + m_nameOffsets.capacity() * sizeof(uint32_t) +
+           m_parents.capacity() * sizeof(uint32_t) + m_types.capacity() * sizeof(EntryType) +
+           m_sizes.capacity() * sizeof(uint64_t) + m_mtimes.capacity() * sizeof(int64_t);
+}
+
+} // namespace fs
+} // namespace crossdev
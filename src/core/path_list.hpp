@@ -0,0 +1,101 @@
+#ifndef CROSSDEV_PATH_LIST_HPP
+#define CROSSDEV_PATH_LIST_HPP
+
+#include "filesystem.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Kind of a directory entry as reported by the walker
+ */
+enum class EntryType : uint8_t {
+    Unknown,
+    File,
+    Directory,
+    Symlink,
+    Other
+};
+
+/**
+ * Extension of a file name including the dot, as Path::extension()
+ * reports it, as a view into name
+ */
+inline std::string_view extensionOf(std::string_view name) {
+    size_t dot = name.find_last_of('.');
+    return dot == std::string_view::npos ? std::string_view() : name.substr(dot);
+}
+
+/**
+ * Compact, structure-of-arrays list of the entries below a root directory.
+ *
+ * Each entry stores only its own name (in a shared character arena) and
+ * the index of its parent directory entry, plus type, size and mtime in
+ * parallel columns. Full paths are built on demand, so a large scan costs
+ * a few dozen bytes per entry instead of one heap string per path.
+ *
+ * Views returned by name() stay valid until the next add().
+ */
+class PathList {
+public:
+    /** Parent index of entries that sit directly in the root */
+    static constexpr uint32_t kRoot = UINT32_MAX;
+
+    explicit PathList(const Path& root);
+
+    uint32_t add(uint32_t parent, std::string_view name, EntryType type, uint64_t size = 0, int64_t mtimeNs = 0);
+    void reserve(size_t entries, size_t nameBytes = 0);
+
+    const Path& root() const { return m_root; }
+    size_t size() const { return m_parents.size(); }
+    bool empty() const { return m_parents.empty(); }
+
+    std::string_view name(size_t index) const {
+        return std::string_view(m_names.data() + m_nameOffsets[index],
+                                m_nameOffsets[index + 1] - m_nameOffsets[index]);
+    }
+    uint32_t parent(size_t index) const { return m_parents[index]; }
+    EntryType type(size_t index) const { return m_types[index]; }
+    uint64_t fileSize(size_t index) const { return m_sizes[index]; }
+    int64_t mtime(size_t index) const { return m_mtimes[index]; }
+
+    /** Full path of an entry (root included) */
+    Path path(size_t index) const;
+    /** Same, written into a caller-owned buffer to reuse its capacity */
+    void pathInto(size_t index, std::string& out) const;
+    /** Path of an entry relative to the root, written into out */
+    void relativePathInto(size_t index, std::string& out) const;
+
+    /** Column access for bulk scans over every entry */
+    const std::vector<uint32_t>& parents() const { return m_parents; }
+    const std::vector<EntryType>& types() const { return m_types; }
+    const std::vector<uint64_t>& sizes() const { return m_sizes; }
+    const std::vector<int64_t>& mtimes() const { return m_mtimes; }
+    /** Every name back to back; entry i spans [nameOffsets()[i], nameOffsets()[i + 1]) */
+    std::string_view nameArena() const { return std::string_view(m_names.data(), m_names.size()); }
+    const std::vector<uint32_t>& nameOffsets() const { return m_nameOffsets; }
+
+    /** Approximate heap bytes used by the list */
+    size_t memoryUsage() const;
+
+private:
+    void buildPath(size_t index, std::string& out, bool withRoot) const;
+
+    Path m_root;
+    std::vector<char> m_names;
+    std::vector<uint32_t> m_nameOffsets;
+    std::vector<uint32_t> m_parents;
+    std::vector<EntryType> m_types;
+    std::vector<uint64_t> m_sizes;
+    std::vector<int64_t> m_mtimes;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_PATH_LIST_HPP
@@ -0,0 +1,319 @@
+#include "precompress.hpp"
+#include "buffer_pool.hpp"
+#include "index_format.hpp"
+#include "path_list.hpp"
+#include "stream.hpp"
+#include "thread_pool.hpp"
+#include "walker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#if defined(CROSSDEV_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kSuffix[] = ".gz";
+constexpr size_t kSuffixLength = sizeof(kSuffix) - 1;
+
+// A variant sits in the same directory as its source, so (parent, name) identifies it
+std::string siblingKey(uint32_t parent, std::string_view name) {
+    std::string key(reinterpret_cast<const char*>(&parent), sizeof(parent));
+    key.append(name.data(), name.size());
+    return key;
+}
+
+/**
+ * Stream source through a gzip deflate into destination and return the
+ * compressed size. destination gets the source's mtime, which is how
+ * run() recognises a variant written from the current content.
+ */
+uint64_t gzipTo(const Path& source, const Path& destination, int level) {
+#if defined(CROSSDEV_HAVE_ZLIB)
+    AlignedBufferPool& pool = AlignedBufferPool::shared();
+    AlignedBufferPool::Buffer input = pool.acquire();
+    AlignedBufferPool::Buffer output = pool.acquire();
+
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // windowBits 15 + 16 selects the gzip wrapper; its mtime stays 0 so output is reproducible
+    if (deflateInit2(&stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw FileSystemException("Failed to initialise zlib for " + source.toString());
+    }
+    struct StreamGuard {
+        z_stream& stream;
+        ~StreamGuard() { deflateEnd(&stream); }
+    } guard{stream};
+
+    FileReader reader(source);
+    FileWriter writer(destination);
+    int flush = Z_NO_FLUSH;
+    while (flush != Z_FINISH) {
+        size_t got = reader.read(input.data(), input.size());
+        flush = got == 0 ? Z_FINISH : Z_NO_FLUSH;
+        stream.next_in = reinterpret_cast<Bytef*>(input.data());
+        stream.avail_in = static_cast<uInt>(got);
+        int status;
+        do {
+            stream.next_out = reinterpret_cast<Bytef*>(output.data());
+            stream.avail_out = static_cast<uInt>(output.size());
+            status = deflate(&stream, flush);
+            if (status == Z_STREAM_ERROR) {
+                throw FileSystemException("zlib failed while compressing " + source.toString());
+            }
+            writer.write(output.data(), output.size() - stream.avail_out);
+        } while (stream.avail_out == 0);
+    }
+    writer.setMtime(reader.mtimeNs());
+    writer.close();
+    return writer.written();
+#else
+    (void)destination;
+    (void)level;
+    throw FileSystemException("Built without zlib; cannot compress " + source.toString());
+#endif
+}
+
+/**
+ * gzip source into a temporary beside destination and rename it over
+ * destination, unless the result is larger than limit, in which case
+ * nothing is written. Returns the compressed size; no temporary outlives
+ * a failure.
+ */
+uint64_t replaceWithGzip(const Path& source, const Path& destination, int level, uint64_t limit) {
+    Path temporary = detail::temporaryPathFor(destination);
+    try {
+        uint64_t written = gzipTo(source, temporary, level);
+        if (written > limit) {
+            File(temporary).remove();
+        } else {
+            File(temporary).move(destination);
+        }
+        return written;
+    } catch (...) {
+        if (temporary.exists()) {
+            File(temporary).remove();
+        }
+        throw;
+    }
+}
+
+struct SkipEntry {
+    uint64_t size;
+    int64_t mtimeNs;
+};
+
+/**
+ * Skip list: a header naming the settings the verdicts were reached with,
+ * then one "size mtime path" line per file
+ */
+std::string skipListHeader(int level, double maxRatio) {
+    char header[96];
+    std::snprintf(header, sizeof(header), "crossdev-precompress-skip 1 %d %.6f\n", level, maxRatio);
+    return header;
+}
+
+// Verdicts reached with other settings, or an unreadable list, are dropped as a whole
+std::unordered_map<std::string, SkipEntry> parseSkipList(const std::string& text, const std::string& header) {
+    std::unordered_map<std::string, SkipEntry> entries;
+    if (text.compare(0, header.size(), header) != 0) {
+        return entries;
+    }
+    for (size_t start = header.size(); start < text.size();) {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos) {
+            return {};
+        }
+        unsigned long long size;
+        long long mtimeNs;
+        int consumed = 0;
+        std::string line = text.substr(start, end - start);
+        if (std::sscanf(line.c_str(), "%llu %lld %n", &size, &mtimeNs, &consumed) != 2 || consumed == 0) {
+            return {};
+        }
+        entries[line.substr(static_cast<size_t>(consumed))] = {size, mtimeNs};
+        start = end + 1;
+    }
+    return entries;
+}
+
+} // namespace
+
+Precompressor::Precompressor(PrecompressOptions options) : m_options(std::move(options)) {
+    for (std::string& extension : m_options.extensions) {
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    }
+}
+
+bool Precompressor::available() {
+#if defined(CROSSDEV_HAVE_ZLIB)
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool Precompressor::eligible(std::string_view name, uint64_t size) const {
+    if (size < m_options.minSize) {
+        return false;
+    }
+    std::string_view extension = extensionOf(name);
+    return std::any_of(m_options.extensions.begin(), m_options.extensions.end(), [extension](const std::string& e) {
+        return e.size() == extension.size() &&
+               std::equal(e.begin(), e.end(), extension.begin(), [](char a, char b) {
+                   return a == std::tolower(static_cast<unsigned char>(b));
+               });
+    });
+}
+
+uint64_t Precompressor::compressFile(const Path& source, const Path& destination) const {
+    return replaceWithGzip(source, destination, m_options.level, UINT64_MAX);
+}
+
+PrecompressStats Precompressor::run(const Path& root) const {
+    PrecompressStats stats;
+    if (!available()) {
+        stats.supported = false;
+        return stats;
+    }
+    ThreadPool& pool = m_options.pool ? *m_options.pool : ThreadPool::io();
+
+    WalkOptions walkOptions;
+    walkOptions.pool = &pool;
+    PathList entries = Walker(walkOptions).scan(root);
+
+    std::unordered_map<std::string, int64_t> variants;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string_view name = entries.name(i);
+        if (entries.type(i) == EntryType::File && name.size() > kSuffixLength &&
+            name.compare(name.size() - kSuffixLength, kSuffixLength, kSuffix) == 0) {
+            variants.emplace(siblingKey(entries.parent(i), name.substr(0, name.size() - kSuffixLength)),
+                             entries.mtime(i));
+        }
+    }
+
+    Path skipListPath = root / m_options.skipListName;
+    std::string header = skipListHeader(m_options.level, m_options.maxRatio);
+    std::string oldSkipList;
+    if (!m_options.skipListName.empty()) {
+        std::ifstream stream(skipListPath.toString(), std::ios::binary);
+        oldSkipList.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    std::unordered_map<std::string, SkipEntry> skipList = parseSkipList(oldSkipList, header);
+
+    // A variant carries the mtime of the content it was written from; "newer" would miss older replacements
+    std::vector<uint32_t> work;
+    std::vector<bool> hasVariant;
+    std::vector<uint32_t> stillSkipped;
+    std::string relative;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries.type(i) != EntryType::File || !eligible(entries.name(i), entries.fileSize(i))) {
+            continue;
+        }
+        ++stats.eligible;
+        auto variant = variants.find(siblingKey(entries.parent(i), entries.name(i)));
+        if (variant != variants.end() && variant->second == entries.mtime(i)) {
+            ++stats.upToDate;
+            continue;
+        }
+        if (variant == variants.end() && !skipList.empty()) {
+            entries.relativePathInto(i, relative);
+            auto skipped = skipList.find(relative);
+            if (skipped != skipList.end() && skipped->second.size == entries.fileSize(i) &&
+                skipped->second.mtimeNs == entries.mtime(i)) {
+                ++stats.upToDate;
+                stillSkipped.push_back(static_cast<uint32_t>(i));
+                continue;
+            }
+        }
+        work.push_back(static_cast<uint32_t>(i));
+        hasVariant.push_back(variant != variants.end());
+    }
+
+    std::atomic<size_t> compressed{0};
+    std::atomic<size_t> incompressible{0};
+    std::atomic<size_t> failed{0};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    std::vector<char> rejected(work.size(), 0);
+    pool.parallelFor(work.size(), [&](size_t k) {
+        Path source = entries.path(work[k]);
+        Path variant(source.toString() + kSuffix);
+        try {
+            uint64_t original = entries.fileSize(work[k]);
+            // written > original * maxRatio exactly when written > its floor, as written is whole
+            double ratioLimit = std::min(static_cast<double>(original) * m_options.maxRatio, 1.8e19);
+            auto limit = static_cast<uint64_t>(std::max(ratioLimit, 0.0));
+            uint64_t written = replaceWithGzip(source, variant, m_options.level, limit);
+            if (written > limit) {
+                if (hasVariant[k]) {
+                    File(variant).remove(); // Stale, and a fresh one would not pay off
+                }
+                rejected[k] = 1;
+                ++incompressible;
+                return;
+            }
+            ++compressed;
+            bytesIn += original;
+            bytesOut += written;
+        } catch (const FileSystemException&) {
+            // The tree may change under a deploy; report the file and carry on
+            ++failed;
+        }
+    });
+
+    if (!m_options.skipListName.empty()) {
+        for (size_t k = 0; k < work.size(); ++k) {
+            if (rejected[k]) {
+                stillSkipped.push_back(work[k]);
+            }
+        }
+        std::vector<std::string> lines;
+        for (uint32_t i : stillSkipped) {
+            entries.relativePathInto(i, relative);
+            if (relative.find('\n') == std::string::npos) {
+                lines.push_back(std::to_string(entries.fileSize(i)) + " " + std::to_string(entries.mtime(i)) + " " +
+                                relative + "\n");
+            }
+        }
+        std::sort(lines.begin(), lines.end());
+        std::string skipListText = lines.empty() ? std::string() : header;
+        for (const std::string& line : lines) {
+            skipListText += line;
+        }
+        // Only rewritten when a verdict changed, so a steady tree is left untouched
+        if (skipListText != oldSkipList) {
+            try {
+                if (skipListText.empty()) {
+                    File(skipListPath).remove();
+                } else {
+                    detail::writeFileAtomically(skipListPath, skipListText);
+                }
+            } catch (const FileSystemException&) {
+                // Only an optimisation: the next run compresses those files again
+            }
+        }
+    }
+
+    stats.compressed = compressed;
+    stats.incompressible = incompressible;
+    stats.failed = failed;
+    stats.bytesIn = bytesIn;
+    stats.bytesOut = bytesOut;
+    return stats;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,103 @@
+#ifndef CROSSDEV_PRECOMPRESS_HPP
+#define CROSSDEV_PRECOMPRESS_HPP
+
+#include "filesystem.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Tuning for Precompressor
+ */
+struct PrecompressOptions {
+    /** Extensions (lowercase, with the dot) of the files worth compressing */
+    std::vector<std::string> extensions = {".html", ".htm", ".css", ".js",  ".mjs", ".json",
+                                           ".map",  ".svg", ".txt", ".xml", ".wasm"};
+    /** Smaller files are left alone; the gzip framing alone is 18 bytes */
+    uint64_t minSize = 1024;
+    /** zlib level, 1 (fastest) to 9 (smallest) */
+    int level = 9;
+    /** A variant is kept only if it is at most this fraction of the original */
+    double maxRatio = 0.9;
+    /**
+     * File directly below the root where run() records the files that did
+     * not compress below maxRatio, with their size and mtime, so later
+     * runs skip them until they change. Empty disables the record.
+     */
+    std::string skipListName = ".precompress-skip";
+    /** Pool that compresses files concurrently; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+struct PrecompressStats {
+    /** False if the library was built without zlib; nothing was done */
+    bool supported = true;
+    /** Files matching the extension and size filters */
+    size_t eligible = 0;
+    /** Variants written by this run */
+    size_t compressed = 0;
+    /**
+     * Files whose variant already carried the file's mtime, or that an
+     * earlier run found incompressible at their current size and mtime
+     */
+    size_t upToDate = 0;
+    /** Files that did not shrink below maxRatio; no variant is kept */
+    size_t incompressible = 0;
+    /** Files that could not be read or written */
+    size_t failed = 0;
+    /** Sizes of the compressed files before and after */
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+/**
+ * Writes a gzip variant ("name.gz") next to every eligible file below a
+ * directory, for servers that send precompressed content.
+ *
+ * The tree is scanned in parallel. Each variant is stamped with its
+ * source's mtime, and a file whose variant's mtime matches its own
+ * exactly is skipped, so a deploy that brings in older files still
+ * refreshes their variants. The remaining files are compressed
+ * concurrently. Each is streamed through zlib in chunks borrowed from
+ * AlignedBufferPool::shared(), written to a temporary file and renamed
+ * over the variant, so a reader never sees a partial one. A variant that
+ * would not pay off is not written, a stale one is removed, and the file
+ * is listed in the skip list so it is not compressed again for nothing.
+ *
+ * zlib is optional: without it available() is false, run() reports
+ * supported == false and compressFile() throws.
+ */
+class Precompressor {
+public:
+    explicit Precompressor(PrecompressOptions options = PrecompressOptions());
+
+    /** True if the library was built with zlib */
+    static bool available();
+
+    PrecompressStats run(const Path& root) const;
+
+    /**
+     * gzip source into destination, replacing it atomically, and give it
+     * the source's mtime; returns the compressed size. Throws
+     * FileSystemException on I/O errors.
+     */
+    uint64_t compressFile(const Path& source, const Path& destination) const;
+
+private:
+    bool eligible(std::string_view name, uint64_t size) const;
+
+    PrecompressOptions m_options;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_PRECOMPRESS_HPP
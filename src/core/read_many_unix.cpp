@@ -0,0 +1,431 @@
+#include "filesystem.hpp"
+#include "thread_pool.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "unix_io.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define CROSSDEV_HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Files stat-ed or read per thread pool task
+constexpr size_t kFilesPerTask = 32;
+
+std::error_code errnoCode(int error) {
+    return std::error_code(error, std::generic_category());
+}
+
+// Regular files only: opening a FIFO or device could block or never end
+std::error_code checkType(mode_t mode) {
+    if (S_ISREG(mode)) {
+        return std::error_code();
+    }
+    return std::make_error_code(S_ISDIR(mode) ? std::errc::is_a_directory : std::errc::operation_not_supported);
+}
+
+void layoutArena(const std::vector<uint64_t>& sizes, std::vector<ReadResult>& results,
+                 std::unique_ptr<char[]>& arena, size_t& arenaSize, std::vector<size_t>& offsets) {
+    arenaSize = 0;
+    offsets.assign(sizes.size(), 0);
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        if (!results[i].error) {
+            offsets[i] = arenaSize;
+            arenaSize += static_cast<size_t>(sizes[i]);
+        }
+    }
+    arena.reset(new char[arenaSize + 1]);
+}
+
+// Sizes of every file, in parallel; failures are recorded in results
+std::vector<uint64_t> statAll(const std::vector<std::string>& paths, ThreadPool& pool,
+                              std::vector<ReadResult>& results) {
+    const size_t count = paths.size();
+    std::vector<uint64_t> sizes(count, 0);
+    pool.parallelFor((count + kFilesPerTask - 1) / kFilesPerTask, [&](size_t task) {
+        size_t end = std::min(count, (task + 1) * kFilesPerTask);
+        for (size_t i = task * kFilesPerTask; i < end; ++i) {
+            struct stat st;
+            if (::stat(paths[i].c_str(), &st) != 0) {
+                results[i].error = errnoCode(errno);
+            } else if (!(results[i].error = checkType(st.st_mode))) {
+                sizes[i] = static_cast<uint64_t>(st.st_size);
+            }
+        }
+    });
+    return sizes;
+}
+
+// Read the listed files into their arena slots, in parallel
+void readOnPool(const std::vector<std::string>& paths, const std::vector<uint64_t>& sizes,
+                const std::vector<size_t>& indices, const std::vector<size_t>& offsets, char* base, ThreadPool& pool,
+                std::vector<ReadResult>& results) {
+    const size_t count = indices.size();
+    pool.parallelFor((count + kFilesPerTask - 1) / kFilesPerTask, [&](size_t task) {
+        size_t end = std::min(count, (task + 1) * kFilesPerTask);
+        for (size_t k = task * kFilesPerTask; k < end; ++k) {
+            size_t i = indices[k];
+            detail::FileDescriptor fd(::open(paths[i].c_str(), O_RDONLY | O_CLOEXEC));
+            if (!fd.valid()) {
+                results[i].error = errnoCode(errno);
+                continue;
+            }
+            char* buffer = base + offsets[i];
+            size_t done = 0;
+            while (done < sizes[i]) {
+                ssize_t got = ::pread(fd.get(), buffer + done, static_cast<size_t>(sizes[i]) - done,
+                                      static_cast<off_t>(done));
+                if (got < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (got < 0) {
+                    results[i].error = errnoCode(errno);
+                    break;
+                }
+                if (got == 0) {
+                    break; // Shrunk since the stat
+                }
+                done += static_cast<size_t>(got);
+            }
+            if (!results[i].error) {
+                results[i].data = std::string_view(buffer, done);
+            }
+        }
+    });
+}
+
+void readWithPool(const std::vector<std::string>& paths, const std::vector<uint64_t>& sizes, ThreadPool& pool,
+                  std::unique_ptr<char[]>& arena, size_t& arenaSize, std::vector<ReadResult>& results) {
+    std::vector<size_t> offsets;
+    layoutArena(sizes, results, arena, arenaSize, offsets);
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!results[i].error) {
+            indices.push_back(i);
+        }
+    }
+    readOnPool(paths, sizes, indices, offsets, arena.get(), pool, results);
+}
+
+#ifdef CROSSDEV_HAVE_IO_URING
+
+// Files per submission; each takes three entries (open, read, close)
+constexpr unsigned kFilesPerRound = 128;
+constexpr unsigned kRingEntries = 4 * kFilesPerRound;
+
+enum Operation : uint64_t {
+    kOpen = 0,
+    kRead = 1,
+    kClose = 2
+};
+
+uint64_t tag(size_t index, Operation operation) {
+    return (static_cast<uint64_t>(index) << 2) | operation;
+}
+
+/**
+ * Minimal io_uring instance driven through the raw system calls, with a
+ * sparse table of kFilesPerRound direct descriptors so that open, read
+ * and close of one file can be linked without returning to user space.
+ */
+class Ring {
+public:
+    Ring() = default;
+    ~Ring() {
+        if (m_sqes != nullptr) {
+            ::munmap(m_sqes, m_sqesSize);
+        }
+        if (m_cqRing != nullptr && m_cqRing != m_sqRing) {
+            ::munmap(m_cqRing, m_cqRingSize);
+        }
+        if (m_sqRing != nullptr) {
+            ::munmap(m_sqRing, m_sqRingSize);
+        }
+    }
+    Ring(const Ring&) = delete;
+    Ring& operator=(const Ring&) = delete;
+
+    // False if the kernel lacks io_uring or any feature the batch needs
+    bool setup() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        int fd = static_cast<int>(::syscall(__NR_io_uring_setup, kRingEntries, &params));
+        if (fd < 0) {
+            return false;
+        }
+        m_fd.reset(fd);
+        // CQE_SKIP arrived in 5.17, after direct descriptors (5.15), so it
+        // stands in for the features the probe cannot see
+        if (!(params.features & IORING_FEAT_CQE_SKIP) || !supports({IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE})) {
+            return false;
+        }
+
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        if (params.features & IORING_FEAT_SINGLE_MMAP) {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+        m_sqRing = map(m_sqRingSize, IORING_OFF_SQ_RING);
+        if (m_sqRing == nullptr) {
+            return false;
+        }
+        m_cqRing = (params.features & IORING_FEAT_SINGLE_MMAP) ? m_sqRing : map(m_cqRingSize, IORING_OFF_CQ_RING);
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = map(m_sqesSize, IORING_OFF_SQES);
+        if (m_cqRing == nullptr || sqes == nullptr) {
+            return false;
+        }
+        m_sqes = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(m_sqRing);
+        m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        char* cq = static_cast<char*>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        m_localTail = *m_sqTail;
+
+        std::vector<int> slots(kFilesPerRound, -1);
+        return ::syscall(__NR_io_uring_register, m_fd.get(), IORING_REGISTER_FILES, slots.data(),
+                         static_cast<unsigned>(slots.size())) == 0;
+    }
+
+    io_uring_sqe& prepare(uint8_t opcode, uint64_t userData) {
+        unsigned index = m_localTail & m_sqMask;
+        io_uring_sqe& sqe = m_sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.user_data = userData;
+        m_sqArray[index] = index;
+        ++m_localTail;
+        ++m_queued;
+        return sqe;
+    }
+
+    /**
+     * Submit everything prepared and hand each completion to handle.
+     * If the kernel stops taking submissions, the requests it already
+     * took are still reaped so none of them lands in a buffer later, and
+     * false is returned; the ring must not be used again after that.
+     */
+    template <typename Handle>
+    bool run(Handle handle) {
+        __atomic_store_n(m_sqTail, m_localTail, __ATOMIC_RELEASE);
+        unsigned pending = m_queued;
+        unsigned toSubmit = m_queued;
+        m_queued = 0;
+        bool failed = false;
+        // Once failed, the entries never submitted will never complete
+        while (pending > (failed ? toSubmit : 0)) {
+            long entered = ::syscall(__NR_io_uring_enter, m_fd.get(), failed ? 0 : toSubmit, 1,
+                                     IORING_ENTER_GETEVENTS, nullptr, 0);
+            if (entered < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (failed) {
+                    break; // Nothing more can be reaped
+                }
+                failed = true;
+                continue;
+            }
+            if (failed) {
+                entered = 0;
+            }
+            toSubmit -= std::min(toSubmit, static_cast<unsigned>(entered));
+            unsigned head = *m_cqHead;
+            unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head, --pending) {
+                const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+                handle(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+        }
+        return !failed;
+    }
+
+private:
+    bool supports(std::initializer_list<uint8_t> opcodes) {
+        size_t size = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        std::unique_ptr<char[]> buffer(new char[size]());
+        io_uring_probe* probe = reinterpret_cast<io_uring_probe*>(buffer.get());
+        if (::syscall(__NR_io_uring_register, m_fd.get(), IORING_REGISTER_PROBE, probe, 256) != 0) {
+            return false;
+        }
+        for (uint8_t opcode : opcodes) {
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void* map(size_t size, off_t offset) {
+        void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd.get(), offset);
+        return memory == MAP_FAILED ? nullptr : memory;
+    }
+
+    detail::FileDescriptor m_fd;
+    void* m_sqRing = nullptr;
+    void* m_cqRing = nullptr;
+    size_t m_sqRingSize = 0;
+    size_t m_cqRingSize = 0;
+    io_uring_sqe* m_sqes = nullptr;
+    size_t m_sqesSize = 0;
+    unsigned* m_sqTail = nullptr;
+    unsigned m_sqMask = 0;
+    unsigned* m_sqArray = nullptr;
+    unsigned* m_cqHead = nullptr;
+    unsigned* m_cqTail = nullptr;
+    unsigned m_cqMask = 0;
+    io_uring_cqe* m_cqes = nullptr;
+    unsigned m_localTail = 0;
+    unsigned m_queued = 0;
+};
+
+// False if io_uring is unusable, before anything was read. If the ring
+// fails mid-batch, the files it did not finish are read on the pool.
+bool readWithRing(const std::vector<std::string>& paths, const std::vector<uint64_t>& sizes, ThreadPool& pool,
+                  std::unique_ptr<char[]>& arena, size_t& arenaSize, std::vector<ReadResult>& results) {
+    Ring ring;
+    if (!ring.setup()) {
+        return false;
+    }
+    const size_t count = paths.size();
+
+    std::vector<size_t> offsets;
+    layoutArena(sizes, results, arena, arenaSize, offsets);
+    char* base = arena.get();
+
+    // Open -> read -> close chains into direct descriptor slots. The
+    // read is hard-linked to the close so a failed read still frees its slot.
+    std::vector<size_t> round;
+    for (size_t first = 0; first < count;) {
+        round.clear();
+        for (; first < count && round.size() < kFilesPerRound; ++first) {
+            if (!results[first].error) {
+                round.push_back(first);
+            }
+        }
+        for (size_t slot = 0; slot < round.size(); ++slot) {
+            size_t i = round[slot];
+            io_uring_sqe& open = ring.prepare(IORING_OP_OPENAT, tag(i, kOpen));
+            open.fd = AT_FDCWD;
+            open.addr = reinterpret_cast<uint64_t>(paths[i].c_str());
+            // Direct descriptors never reach the fd table, so O_CLOEXEC is rejected
+            open.open_flags = O_RDONLY;
+            open.file_index = static_cast<uint32_t>(slot + 1);
+            open.flags = IOSQE_IO_LINK;
+
+            io_uring_sqe& read = ring.prepare(IORING_OP_READ, tag(i, kRead));
+            read.fd = static_cast<int32_t>(slot);
+            read.addr = reinterpret_cast<uint64_t>(base + offsets[i]);
+            read.len = static_cast<uint32_t>(std::min<uint64_t>(sizes[i], UINT32_MAX));
+            read.off = 0;
+            read.flags = IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK;
+
+            io_uring_sqe& close = ring.prepare(IORING_OP_CLOSE, tag(i, kClose));
+            close.file_index = static_cast<uint32_t>(slot + 1);
+        }
+        bool ok = ring.run([&](uint64_t userData, int32_t res) {
+            size_t i = static_cast<size_t>(userData >> 2);
+            Operation operation = static_cast<Operation>(userData & 3);
+            if (operation == kClose || results[i].error) {
+                return;
+            }
+            if (res < 0) {
+                // The open's own error arrives before the read's cancellation
+                results[i].error = errnoCode(-res);
+            } else if (operation == kRead) {
+                results[i].data = std::string_view(base + offsets[i], static_cast<size_t>(res));
+            }
+        });
+        if (!ok) {
+            // The ring's tail no longer matches what was consumed, so
+            // abandon it and finish this round and the rest on the pool
+            std::vector<size_t> unfinished;
+            for (size_t i : round) {
+                if (!results[i].error && results[i].data.data() == nullptr) {
+                    unfinished.push_back(i);
+                }
+            }
+            for (; first < count; ++first) {
+                if (!results[first].error) {
+                    unfinished.push_back(first);
+                }
+            }
+            readOnPool(paths, sizes, unfinished, offsets, base, pool, results);
+            break;
+        }
+    }
+
+    // A read returns at most 2 GiB; finish larger files synchronously
+    for (size_t i = 0; i < count; ++i) {
+        if (results[i].error || results[i].data.size() >= sizes[i] || results[i].data.size() < 0x7ffff000) {
+            continue;
+        }
+        detail::FileDescriptor fd(::open(paths[i].c_str(), O_RDONLY | O_CLOEXEC));
+        size_t done = results[i].data.size();
+        while (fd.valid() && done < sizes[i]) {
+            ssize_t got = ::pread(fd.get(), base + offsets[i] + done, static_cast<size_t>(sizes[i]) - done,
+                                  static_cast<off_t>(done));
+            if (got <= 0 && !(got < 0 && errno == EINTR)) {
+                break;
+            }
+            done += got > 0 ? static_cast<size_t>(got) : 0;
+        }
+        results[i].data = std::string_view(base + offsets[i], done);
+    }
+    return true;
+}
+
+#endif // CROSSDEV_HAVE_IO_URING
+
+} // namespace
+
+ReadBatch File::readMany(const std::vector<Path>& paths, ReadManyOptions options) {
+    std::vector<std::string> native;
+    native.reserve(paths.size());
+    for (const Path& path : paths) {
+        native.push_back(path.getNative());
+    }
+
+    ReadBatch batch;
+    batch.m_results.resize(paths.size());
+    if (paths.empty()) {
+        return batch;
+    }
+    // Path lookups dominate and io_uring would punt every statx to its
+    // workers anyway, so sizes always come from the pool
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::io();
+    std::vector<uint64_t> sizes = statAll(native, pool, batch.m_results);
+#ifdef CROSSDEV_HAVE_IO_URING
+    if (options.allowIoUring &&
+        readWithRing(native, sizes, pool, batch.m_arena, batch.m_arenaSize, batch.m_results)) {
+        batch.m_usedIoUring = true;
+        return batch;
+    }
+#endif
+    readWithPool(native, sizes, pool, batch.m_arena, batch.m_arenaSize, batch.m_results);
+    return batch;
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // defined(__unix__) || defined(__APPLE__)
@@ -0,0 +1,71 @@
+#include "filesystem.hpp"
+#include "thread_pool.hpp"
+
+#ifdef _WIN32
+
+#include <algorithm>
+#include <fstream>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Files sized or read per thread pool task
+constexpr size_t kFilesPerTask = 32;
+
+} // namespace
+
+ReadBatch File::readMany(const std::vector<Path>& paths, ReadManyOptions options) {
+    ThreadPool& pool = options.pool ? *options.pool : ThreadPool::io();
+    const size_t count = paths.size();
+    const size_t tasks = (count + kFilesPerTask - 1) / kFilesPerTask;
+
+    ReadBatch batch;
+    batch.m_results.resize(count);
+    std::vector<uint64_t> sizes(count, 0);
+    pool.parallelFor(tasks, [&](size_t task) {
+        size_t end = std::min(count, (task + 1) * kFilesPerTask);
+        for (size_t i = task * kFilesPerTask; i < end; ++i) {
+            if (!paths[i].isFile()) {
+                batch.m_results[i].error = std::make_error_code(
+                    paths[i].isDirectory() ? std::errc::is_a_directory : std::errc::no_such_file_or_directory);
+                continue;
+            }
+            sizes[i] = File(paths[i]).size();
+        }
+    });
+
+    std::vector<size_t> offsets(count, 0);
+    for (size_t i = 0; i < count; ++i) {
+        if (!batch.m_results[i].error) {
+            offsets[i] = batch.m_arenaSize;
+            batch.m_arenaSize += static_cast<size_t>(sizes[i]);
+        }
+    }
+    batch.m_arena.reset(new char[batch.m_arenaSize + 1]);
+    char* base = batch.m_arena.get();
+
+    pool.parallelFor(tasks, [&](size_t task) {
+        size_t end = std::min(count, (task + 1) * kFilesPerTask);
+        for (size_t i = task * kFilesPerTask; i < end; ++i) {
+            ReadResult& result = batch.m_results[i];
+            if (result.error) {
+                continue;
+            }
+            std::ifstream file(paths[i].toString(), std::ios::binary);
+            if (!file.is_open()) {
+                result.error = std::make_error_code(std::errc::permission_denied);
+                continue;
+            }
+            file.read(base + offsets[i], static_cast<std::streamsize>(sizes[i]));
+            result.data = std::string_view(base + offsets[i], static_cast<size_t>(file.gcount()));
+        }
+    });
+    return batch;
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // _WIN32
@@ -0,0 +1,127 @@
+#include "search.hpp"
+#include "mapped_file.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+ContentSearch::ContentSearch(std::vector<std::string> literals, SearchOptions options)
+    : m_literals(std::move(literals)), m_options(options) {
+    m_literals.erase(std::remove_if(m_literals.begin(), m_literals.end(),
+                                    [](const std::string& literal) { return literal.empty(); }),
+                     m_literals.end());
+}
+
+bool ContentSearch::isBinary(std::string_view content) const {
+    size_t probe = std::min(content.size(), m_options.binaryProbeBytes);
+    return std::memchr(content.data(), '\0', probe) != nullptr;
+}
+
+std::vector<SearchMatch> ContentSearch::searchBuffer(std::string_view content, const Path& origin) const {
+    std::vector<SearchMatch> matches;
+    if (m_literals.empty() || (m_options.skipBinary && isBinary(content))) {
+        return matches;
+    }
+
+    const char* begin = content.data();
+    const char* end = begin + content.size();
+
+    // Collect raw (offset, pattern) hits for every literal
+    std::vector<std::pair<size_t, size_t>> hits;
+    for (size_t pattern = 0; pattern < m_literals.size(); ++pattern) {
+        const std::string& literal = m_literals[pattern];
+        const char* p = begin;
+        size_t found = 0;
+        while (p < end) {
+            const char* hit = simd::findLiteral(p, end, literal.data(), literal.size());
+            if (hit == end) {
+                break;
+            }
+            hits.emplace_back(static_cast<size_t>(hit - begin), pattern);
+            if (m_options.maxMatchesPerFile != 0 && ++found >= m_options.maxMatchesPerFile) {
+                break;
+            }
+            p = hit + 1;
+        }
+    }
+    std::sort(hits.begin(), hits.end());
+    if (m_options.maxMatchesPerFile != 0 && hits.size() > m_options.maxMatchesPerFile) {
+        hits.resize(m_options.maxMatchesPerFile);
+    }
+
+    // Resolve line numbers incrementally; hits are sorted by offset
+    size_t line = 1;
+    const char* lineStart = begin;
+    const char* scanned = begin;
+    matches.reserve(hits.size());
+    for (const auto& hit : hits) {
+        const char* at = begin + hit.first;
+        if (at > scanned) {
+            size_t newlines = simd::countByte(scanned, at, '\n');
+            if (newlines > 0) {
+                line += newlines;
+                // The current line starts after the last newline before the hit
+                const char* q = at;
+                while (q[-1] != '\n') {
+                    --q;
+                }
+                lineStart = q;
+            }
+            scanned = at;
+        }
+
+        SearchMatch match{origin, line, static_cast<size_t>(at - lineStart) + 1, hit.first, hit.second, {}};
+        if (m_options.captureLines) {
+            const char* lineEnd = simd::findByte(at, end, '\n');
+            if (lineEnd > lineStart && lineEnd[-1] == '\r') {
+                --lineEnd;
+            }
+            match.text.assign(lineStart, static_cast<size_t>(std::max(lineEnd, lineStart) - lineStart));
+        }
+        matches.push_back(std::move(match));
+    }
+    return matches;
+}
+
+std::vector<SearchMatch> ContentSearch::searchFile(const Path& path) const {
+    MappedFile mapped(path);
+    return searchBuffer(mapped.view(), path);
+}
+
+std::vector<SearchMatch> ContentSearch::search(const Path& root) const {
+    std::vector<Path> files;
+    for (Path& entry : Directory(root).list(true)) {
+        if (entry.isFile()) {
+            files.push_back(std::move(entry));
+        }
+    }
+    std::sort(files.begin(), files.end(), [](const Path& a, const Path& b) { return a.toString() < b.toString(); });
+    return search(files);
+}
+
+std::vector<SearchMatch> ContentSearch::search(const std::vector<Path>& files) const {
+    ThreadPool& pool = m_options.pool ? *m_options.pool : ThreadPool::io();
+    std::vector<std::vector<SearchMatch>> perFile(files.size());
+
+    pool.parallelFor(files.size(), [&](size_t i) {
+        try {
+            perFile[i] = searchFile(files[i]);
+        } catch (const FileSystemException&) {
+            // Unreadable files are skipped, as grep -s would
+        }
+    });
+
+    std::vector<SearchMatch> matches;
+    for (auto& fileMatches : perFile) {
+        std::move(fileMatches.begin(), fileMatches.end(), std::back_inserter(matches));
+    }
+    return matches;
+}
+
+} // namespace fs
+} // namespace crossdev
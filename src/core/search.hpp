@@ -0,0 +1,76 @@
+#ifndef CROSSDEV_SEARCH_HPP
+#define CROSSDEV_SEARCH_HPP
+
+#include "filesystem.hpp"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * One literal match inside a file
+ */
+struct SearchMatch {
+    Path file;
+    /** 1-based line number */
+    size_t line = 0;
+    /** 1-based byte column within the line */
+    size_t column = 0;
+    /** Byte offset of the match from the start of the file */
+    uint64_t offset = 0;
+    /** Index into the literals passed to ContentSearch */
+    size_t pattern = 0;
+    /** The full line containing the match, without its terminator */
+    std::string text;
+};
+
+/**
+ * Tuning for ContentSearch
+ */
+struct SearchOptions {
+    /** Skip files with a NUL byte in their first binaryProbeBytes */
+    bool skipBinary = true;
+    size_t binaryProbeBytes = 8192;
+    /** Stop scanning a file after this many matches (0 = unlimited) */
+    size_t maxMatchesPerFile = 0;
+    /** Copy the matching line into SearchMatch::text */
+    bool captureLines = true;
+    /** Pool used for the tree search; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+/**
+ * Literal (grep -F style) content search over files and directory trees.
+ *
+ * Files are memory mapped rather than copied, and each literal is located
+ * with a vectorised first/last-byte filter. Directory trees are searched
+ * in parallel; results are ordered by file, then by offset.
+ */
+class ContentSearch {
+public:
+    explicit ContentSearch(std::vector<std::string> literals, SearchOptions options = SearchOptions());
+
+    std::vector<SearchMatch> searchFile(const Path& path) const;
+    std::vector<SearchMatch> searchBuffer(std::string_view content, const Path& origin) const;
+    std::vector<SearchMatch> search(const Path& root) const;
+    std::vector<SearchMatch> search(const std::vector<Path>& files) const;
+
+    /** True if the buffer looks binary under the configured probe size */
+    bool isBinary(std::string_view content) const;
+
+private:
+    std::vector<std::string> m_literals;
+    SearchOptions m_options;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_SEARCH_HPP
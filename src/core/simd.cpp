@@ -0,0 +1,143 @@
+#include "simd.hpp"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define CROSSDEV_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(CROSSDEV_HAVE_SSE2) && (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define CROSSDEV_HAVE_AVX2_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace crossdev {
+namespace simd {
+
+namespace {
+
+using ReplaceFn = bool (*)(char*, size_t, char, char);
+
+bool replaceScalar(char* data, size_t length, char from, char to) {
+    char* hit = static_cast<char*>(std::memchr(data, from, length));
+    if (hit == nullptr) {
+        return false;
+    }
+    for (char* end = data + length; hit < end; ++hit) {
+        if (*hit == from) {
+            *hit = to;
+        }
+    }
+    return true;
+}
+
+#ifdef CROSSDEV_HAVE_SSE2
+bool replaceSse2(char* data, size_t length, char from, char to) {
+    const __m128i needle = _mm_set1_epi8(from);
+    const __m128i replacement = _mm_set1_epi8(to);
+    size_t i = 0;
+
+    // Read-only pass until the first block that needs rewriting
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)) != 0) {
+            break;
+        }
+    }
+    if (i + 16 > length) {
+        return replaceScalar(data + i, length - i, from, to);
+    }
+
+    for (; i + 16 <= length; i += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i mask = _mm_cmpeq_epi8(block, needle);
+        if (_mm_movemask_epi8(mask) != 0) {
+            block = _mm_or_si128(_mm_andnot_si128(mask, block), _mm_and_si128(mask, replacement));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), block);
+        }
+    }
+    replaceScalar(data + i, length - i, from, to);
+    return true;
+}
+#endif
+
+#ifdef CROSSDEV_HAVE_AVX2_DISPATCH
+__attribute__((target("avx2"))) bool replaceAvx2(char* data, size_t length, char from, char to) {
+    const __m256i needle = _mm256_set1_epi8(from);
+    const __m256i replacement = _mm256_set1_epi8(to);
+    size_t i = 0;
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle)) != 0) {
+            break;
+        }
+    }
+    if (i + 32 > length) {
+        return replaceSse2(data + i, length - i, from, to);
+    }
+
+    for (; i + 32 <= length; i += 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i mask = _mm256_cmpeq_epi8(block, needle);
+        if (_mm256_movemask_epi8(mask) != 0) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + i), _mm256_blendv_epi8(block, replacement, mask));
+        }
+    }
+    replaceSse2(data + i, length - i, from, to);
+    return true;
+}
+#endif
+
+#ifdef CROSSDEV_HAVE_NEON
+bool replaceNeon(char* data, size_t length, char from, char to) {
+    const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(from));
+    const uint8x16_t replacement = vdupq_n_u8(static_cast<uint8_t>(to));
+    uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+    size_t i = 0;
+
+    for (; i + 16 <= length; i += 16) {
+        if (vmaxvq_u8(vceqq_u8(vld1q_u8(bytes + i), needle)) != 0) {
+            break;
+        }
+    }
+    if (i + 16 > length) {
+        return replaceScalar(data + i, length - i, from, to);
+    }
+
+    for (; i + 16 <= length; i += 16) {
+        uint8x16_t block = vld1q_u8(bytes + i);
+        uint8x16_t mask = vceqq_u8(block, needle);
+        if (vmaxvq_u8(mask) != 0) {
+            vst1q_u8(bytes + i, vbslq_u8(mask, replacement, block));
+        }
+    }
+    replaceScalar(data + i, length - i, from, to);
+    return true;
+}
+#endif
+
+ReplaceFn selectReplace() {
+#ifdef CROSSDEV_HAVE_AVX2_DISPATCH
+    if (__builtin_cpu_supports("avx2")) {
+        return replaceAvx2;
+    }
+#endif
+#if defined(CROSSDEV_HAVE_SSE2)
+    return replaceSse2;
+#elif defined(CROSSDEV_HAVE_NEON)
+    return replaceNeon;
+#else
+    return replaceScalar;
+#endif
+}
+
+} // namespace
+
+bool replaceByte(char* data, size_t length, char from, char to) {
+    static const ReplaceFn implementation = selectReplace();
+    return implementation(data, length, from, to);
+}
+
+} // namespace simd
+} // namespace crossdev
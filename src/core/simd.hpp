@@ -0,0 +1,134 @@
+#ifndef CROSSDEV_SIMD_HPP
+#define CROSSDEV_SIMD_HPP
+
+// Internal byte-scanning primitives shared by the search, line and path code.
+// Not installed; the SSE2 paths are always available on x86-64 and the
+// scalar fallbacks lean on the C library's own vectorised memchr.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CROSSDEV_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace crossdev {
+namespace simd {
+
+inline int countTrailingZeros(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+inline int popCount(uint32_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+    return static_cast<int>(__popcnt(mask));
+#else
+    return __builtin_popcount(mask);
+#endif
+}
+
+/**
+ * Replace every occurrence of from with to in [data, data + length).
+ *
+ * The buffer is scanned with the widest vector unit the CPU supports
+ * (AVX2, SSE2 or NEON, chosen once at runtime) and nothing is written
+ * until the first occurrence, so already-normal input costs a read-only
+ * pass. Returns true if anything was replaced.
+ */
+bool replaceByte(char* data, size_t length, char from, char to);
+
+/**
+ * First occurrence of byte in [begin, end), or end.
+ */
+inline const char* findByte(const char* begin, const char* end, char byte) {
+    const void* hit = std::memchr(begin, byte, static_cast<size_t>(end - begin));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+/**
+ * Number of occurrences of byte in [begin, end).
+ */
+inline size_t countByte(const char* begin, const char* end, char byte) {
+    size_t count = 0;
+    const char* p = begin;
+#ifdef CROSSDEV_HAVE_SSE2
+    const __m128i needle = _mm_set1_epi8(byte);
+    for (; p + 16 <= end; p += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)));
+        count += static_cast<size_t>(popCount(mask));
+    }
+#endif
+    for (; p < end; ++p) {
+        count += (*p == byte);
+    }
+    return count;
+}
+
+/**
+ * First occurrence of needle in [begin, end), or end.
+ *
+ * Candidate positions are found by comparing the needle's first and last
+ * bytes against 16 haystack positions at once; only positions where both
+ * match are verified with memcmp. This rejects most of the haystack
+ * without a byte-by-byte loop, even for needles with a common first byte.
+ */
+inline const char* findLiteral(const char* begin, const char* end, const char* needle, size_t length) {
+    if (length == 0) {
+        return begin;
+    }
+    if (static_cast<size_t>(end - begin) < length) {
+        return end;
+    }
+    if (length == 1) {
+        return findByte(begin, end, needle[0]);
+    }
+
+    const char* last = end - length; // Last valid starting position
+    const char* p = begin;
+#ifdef CROSSDEV_HAVE_SSE2
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i tail = _mm_set1_epi8(needle[length - 1]);
+    for (; p + 16 <= last + 1; p += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + length - 1));
+        uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, tail))));
+        while (mask != 0) {
+            int bit = countTrailingZeros(mask);
+            if (std::memcmp(p + bit + 1, needle + 1, length - 2) == 0) {
+                return p + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+    while (p <= last) {
+        p = static_cast<const char*>(std::memchr(p, needle[0], static_cast<size_t>(last - p) + 1));
+        if (p == nullptr) {
+            return end;
+        }
+        if (p[length - 1] == needle[length - 1] && std::memcmp(p + 1, needle + 1, length - 2) == 0) {
+            return p;
+        }
+        ++p;
+    }
+    return end;
+}
+
+} // namespace simd
+} // namespace crossdev
+
+#endif // CROSSDEV_SIMD_HPP
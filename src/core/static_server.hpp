@@ -0,0 +1,110 @@
+#ifndef CROSSDEV_STATIC_SERVER_HPP
+#define CROSSDEV_STATIC_SERVER_HPP
+
+#include "filesystem.hpp"
+
+#if defined(__linux__)
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+class AssetCache;
+
+/**
+ * Tuning for StaticServer
+ */
+struct StaticServerOptions {
+    /** IPv4 address to listen on */
+    std::string address = "127.0.0.1";
+    /** 0 picks a free port; see StaticServer::port() */
+    uint16_t port = 0;
+    /** Event loops, each with its own epoll instance and SO_REUSEPORT listener */
+    size_t threads = 1;
+    /** Open files kept in the asset cache */
+    size_t openFileCache = 1024;
+    /** See AssetCacheOptions::revalidateMs */
+    int64_t revalidateMs = 1000;
+    /** Idle keep-alive connections are closed after this */
+    int64_t keepAliveTimeoutMs = 5000;
+    /** Largest accepted request head (request line plus headers) */
+    size_t maxRequestBytes = 8192;
+    /** Served for requests naming a directory */
+    std::string indexFile = "index.html";
+};
+
+/**
+ * Counters since start(), summed over every event loop
+ */
+struct StaticServerStats {
+    uint64_t connections = 0;
+    uint64_t requests = 0;
+    /** Body bytes handed to sendfile() */
+    uint64_t bodyBytes = 0;
+    /** Requests answered from the asset cache without open() */
+    uint64_t cacheHits = 0;
+    uint64_t notModified = 0;
+};
+
+/**
+ * Embeddable HTTP/1.1 server for the files below a root directory.
+ *
+ * Each event loop owns a level-triggered epoll set and a listening
+ * socket bound with SO_REUSEPORT, so the kernel spreads
+ * connections across loops without a shared accept lock. Bodies go from
+ * the page cache to the socket with sendfile(); headers are sent with
+ * MSG_MORE so they share a segment with the first body bytes.
+ *
+ * Supported: GET and HEAD, keep-alive and pipelining, single byte ranges
+ * (Range / If-Range, answered with 206 or 416) and conditional requests
+ * (If-None-Match / If-Modified-Since, answered with 304). Files are
+ * looked up in an AssetCache, which keeps them open together with their
+ * content-hash ETags and preformatted headers, so a conditional request
+ * for a hot file costs no disk I/O. Paths containing ".." segments are
+ * rejected, and symlinks resolving outside the root are answered with
+ * 403 (see AssetCache). Linux only.
+ */
+class StaticServer {
+public:
+    explicit StaticServer(const Path& root, StaticServerOptions options = StaticServerOptions());
+    /** Stops the server if it is still running */
+    ~StaticServer();
+
+    StaticServer(const StaticServer&) = delete;
+    StaticServer& operator=(const StaticServer&) = delete;
+
+    /** Bind, listen and start the event loops; throws if the address cannot be bound */
+    void start();
+    /** Close every connection and join the event loops */
+    void stop();
+
+    bool running() const { return !m_loops.empty(); }
+    /** Port actually bound, once started */
+    uint16_t port() const { return m_port; }
+    StaticServerStats stats() const;
+    /** Files being served; call invalidate() on it from a change watcher */
+    AssetCache& assets() { return *m_assets; }
+
+private:
+    struct Loop;
+
+    StaticServerOptions m_options;
+    uint16_t m_port = 0;
+    std::unique_ptr<AssetCache> m_assets;
+    std::vector<std::unique_ptr<Loop>> m_loops;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __linux__
+
+#endif // CROSSDEV_STATIC_SERVER_HPP
@@ -0,0 +1,761 @@
+#include "static_server.hpp"
+
+#if defined(__linux__)
+
+#include "asset_cache.hpp"
+#include "unix_io.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <string_view>
+#include <unordered_map>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr int kMaxEvents = 64;
+// Bytes read from a socket per recv()
+constexpr size_t kReadChunk = 16 * 1024;
+// Idle connections are swept at this interval
+constexpr int64_t kSweepIntervalMs = 1000;
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/**
+ * Turn a request target into a path relative to the root: the query is
+ * dropped, escapes are decoded, and targets that are not absolute or
+ * that contain NUL or ".." segments are refused.
+ */
+bool decodeTarget(std::string_view target, std::string& relative) {
+    target = target.substr(0, target.find_first_of("?#"));
+    if (target.empty() || target.front() != '/') {
+        return false;
+    }
+    relative.clear();
+    for (size_t i = 1; i < target.size(); ++i) {
+        char c = target[i];
+        if (c == '%') {
+            int high = i + 2 < target.size() ? hexValue(target[i + 1]) : -1;
+            int low = high >= 0 ? hexValue(target[i + 2]) : -1;
+            if (low < 0) {
+                return false;
+            }
+            c = static_cast<char>(high * 16 + low);
+            i += 2;
+        }
+        if (c == '\0') {
+            return false;
+        }
+        // Collapse empty segments so "//etc" cannot become absolute
+        if (c == '/' && (relative.empty() || relative.back() == '/')) {
+            continue;
+        }
+        relative.push_back(c);
+    }
+    for (size_t start = 0; start <= relative.size();) {
+        size_t end = relative.find('/', start);
+        if (end == std::string::npos) {
+            end = relative.size();
+        }
+        std::string_view segment(relative.data() + start, end - start);
+        if (segment == "..") {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
+// Inverse of decodeTarget() for building a Location: escape all but unreserved characters and '/'
+std::string encodePath(std::string_view path) {
+    static const char kHex[] = "0123456789ABCDEF";
+    std::string encoded;
+    encoded.reserve(path.size());
+    for (char c : path) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        bool unreserved = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                          c == '-' || c == '.' || c == '_' || c == '~';
+        if (unreserved || c == '/') {
+            encoded.push_back(c);
+        } else {
+            encoded.push_back('%');
+            encoded.push_back(kHex[byte >> 4]);
+            encoded.push_back(kHex[byte & 15]);
+        }
+    }
+    return encoded;
+}
+
+enum class RangeResult {
+    None,
+    Satisfiable,
+    Unsatisfiable
+};
+
+// Single "bytes=" ranges only; anything else is served in full
+RangeResult parseRange(std::string_view header, uint64_t size, uint64_t& first, uint64_t& last) {
+    if (header.substr(0, 6) != "bytes=" || header.find(',') != std::string_view::npos) {
+        return RangeResult::None;
+    }
+    std::string_view spec = trim(header.substr(6));
+    size_t dash = spec.find('-');
+    if (dash == std::string_view::npos) {
+        return RangeResult::None;
+    }
+    auto number = [](std::string_view digits, uint64_t& value) {
+        if (digits.empty() || digits.size() > 19) {
+            return false;
+        }
+        value = 0;
+        for (char c : digits) {
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            value = value * 10 + static_cast<uint64_t>(c - '0');
+        }
+        return true;
+    };
+    std::string_view from = spec.substr(0, dash);
+    std::string_view to = spec.substr(dash + 1);
+    if (from.empty()) {
+        uint64_t suffix;
+        if (!number(to, suffix)) {
+            return RangeResult::None;
+        }
+        if (suffix == 0 || size == 0) {
+            return RangeResult::Unsatisfiable;
+        }
+        first = size - std::min(suffix, size);
+        last = size - 1;
+        return RangeResult::Satisfiable;
+    }
+    if (!number(from, first) || (!to.empty() && !number(to, last)) || (!to.empty() && last < first)) {
+        return RangeResult::None;
+    }
+    if (first >= size) {
+        return RangeResult::Unsatisfiable;
+    }
+    if (to.empty() || last >= size) {
+        last = size - 1;
+    }
+    return RangeResult::Satisfiable;
+}
+
+const char* statusText(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        default: return "Internal Server Error";
+    }
+}
+
+struct Request {
+    std::string_view method;
+    std::string_view target;
+    bool http10 = false;
+    bool keepAlive = true;
+    bool hasBody = false;
+    std::string_view range;
+    std::string_view ifRange;
+    std::string_view ifNoneMatch;
+    std::string_view ifModifiedSince;
+};
+
+bool parseRequest(std::string_view head, Request& request) {
+    size_t lineEnd = head.find("\r\n");
+    std::string_view line = head.substr(0, lineEnd);
+    size_t space1 = line.find(' ');
+    size_t space2 = line.rfind(' ');
+    if (space1 == std::string_view::npos || space2 == space1) {
+        return false;
+    }
+    request.method = line.substr(0, space1);
+    request.target = line.substr(space1 + 1, space2 - space1 - 1);
+    std::string_view version = line.substr(space2 + 1);
+    if (version == "HTTP/1.0") {
+        request.http10 = true;
+        request.keepAlive = false;
+    } else if (version != "HTTP/1.1") {
+        return false;
+    }
+
+    while (lineEnd != std::string_view::npos) {
+        size_t start = lineEnd + 2;
+        lineEnd = head.find("\r\n", start);
+        std::string_view header = head.substr(start, lineEnd == std::string_view::npos ? std::string_view::npos
+                                                                                         : lineEnd - start);
+        size_t colon = header.find(':');
+        if (colon == std::string_view::npos) {
+            continue;
+        }
+        std::string_view name = header.substr(0, colon);
+        std::string_view value = trim(header.substr(colon + 1));
+        if (equalsIgnoreCase(name, "connection")) {
+            if (equalsIgnoreCase(value, "close")) {
+                request.keepAlive = false;
+            } else if (equalsIgnoreCase(value, "keep-alive")) {
+                request.keepAlive = true;
+            }
+        } else if (equalsIgnoreCase(name, "range")) {
+            request.range = value;
+        } else if (equalsIgnoreCase(name, "if-range")) {
+            request.ifRange = value;
+        } else if (equalsIgnoreCase(name, "if-none-match")) {
+            request.ifNoneMatch = value;
+        } else if (equalsIgnoreCase(name, "if-modified-since")) {
+            request.ifModifiedSince = value;
+        } else if ((equalsIgnoreCase(name, "content-length") && value != "0") ||
+                   equalsIgnoreCase(name, "transfer-encoding")) {
+            request.hasBody = true;
+        }
+    }
+    return true;
+}
+
+struct Connection {
+    detail::FileDescriptor fd;
+    std::string input;
+    std::string output;
+    size_t outputSent = 0;
+    std::shared_ptr<const Asset> file;
+    uint64_t bodyOffset = 0;
+    uint64_t bodyRemaining = 0;
+    bool closeAfterResponse = false;
+    bool peerClosed = false;
+    bool writing = false;
+    int64_t lastActiveMs = 0;
+};
+
+} // namespace
+
+struct StaticServer::Loop {
+    Loop(const StaticServerOptions& options, AssetCache& assets) : options(options), assets(assets) {}
+
+    const StaticServerOptions& options;
+    AssetCache& assets;
+    detail::FileDescriptor epoll;
+    detail::FileDescriptor listener;
+    detail::FileDescriptor wake;
+    // Kept open so it can be given up to accept and shed a connection when descriptors run out
+    detail::FileDescriptor reserve;
+    bool listening = true;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    std::string relative;
+    time_t dateSecond = 0;
+    std::string date;
+
+    std::atomic<uint64_t> connectionCount{0};
+    std::atomic<uint64_t> requestCount{0};
+    std::atomic<uint64_t> bodyBytes{0};
+    std::atomic<uint64_t> cacheHits{0};
+    std::atomic<uint64_t> notModified{0};
+
+    // Inside run(), where nothing may throw; false if the kernel refused
+    bool control(int fd, uint32_t events, int operation) {
+        struct epoll_event event;
+        std::memset(&event, 0, sizeof(event));
+        event.events = events;
+        event.data.fd = fd;
+        return ::epoll_ctl(epoll.get(), operation, fd, &event) == 0;
+    }
+
+    void watch(int fd, uint32_t events, int operation) {
+        if (!control(fd, events, operation)) {
+            throw FileSystemException("epoll_ctl failed: " + std::string(std::strerror(errno)));
+        }
+    }
+
+    void run() {
+        // sendfile() to a reset peer raises SIGPIPE; keep it away from the process
+        sigset_t pipe;
+        sigemptyset(&pipe);
+        sigaddset(&pipe, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipe, nullptr);
+
+        struct epoll_event events[kMaxEvents];
+        int64_t lastSweep = nowMs();
+        for (;;) {
+            int ready = ::epoll_wait(epoll.get(), events, kMaxEvents, static_cast<int>(kSweepIntervalMs));
+            if (ready < 0 && errno != EINTR) {
+                break;
+            }
+            int64_t now = nowMs();
+            for (int i = 0; i < ready; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == wake.get()) {
+                    connections.clear();
+                    return;
+                }
+                if (fd == listener.get()) {
+                    acceptAll(now);
+                    continue;
+                }
+                auto found = connections.find(fd);
+                if (found == connections.end()) {
+                    continue;
+                }
+                Connection& connection = *found->second;
+                connection.lastActiveMs = now;
+                bool open = true;
+                if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                    open = false;
+                } else if (connection.writing) {
+                    open = flush(connection) && serve(connection);
+                } else {
+                    open = receive(connection) && serve(connection);
+                }
+                if (!open) {
+                    connections.erase(found);
+                }
+            }
+            if (now - lastSweep >= kSweepIntervalMs) {
+                sweep(now);
+                lastSweep = now;
+                if (!listening) {
+                    resumeAccepting();
+                }
+            }
+        }
+    }
+
+    void acceptAll(int64_t now) {
+        for (;;) {
+            int fd = ::accept4(listener.get(), nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    shedConnection();
+                }
+                return;
+            }
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            auto connection = std::make_unique<Connection>();
+            connection->fd.reset(fd);
+            connection->lastActiveMs = now;
+            if (!control(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD)) {
+                continue;
+            }
+            connections.emplace(fd, std::move(connection));
+            ++connectionCount;
+        }
+    }
+
+    /**
+     * Out of descriptors or memory: the pending connection stays queued
+     * and the level-triggered listener would fire again at once. Spend
+     * the reserve descriptor to accept and close it; without one, stop
+     * watching the listener until the next sweep.
+     */
+    void shedConnection() {
+        if (reserve.valid()) {
+            reserve.reset();
+            int fd = ::accept4(listener.get(), nullptr, nullptr, SOCK_CLOEXEC);
+            if (fd >= 0) {
+                ::close(fd);
+            }
+            reserve.reset(::open("/dev/null", O_RDONLY | O_CLOEXEC));
+            if (fd >= 0) {
+                return;
+            }
+        }
+        if (listening && control(listener.get(), 0, EPOLL_CTL_DEL)) {
+            listening = false;
+        }
+    }
+
+    void resumeAccepting() {
+        if (!reserve.valid()) {
+            reserve.reset(::open("/dev/null", O_RDONLY | O_CLOEXEC));
+        }
+        listening = control(listener.get(), EPOLLIN, EPOLL_CTL_ADD);
+    }
+
+    void sweep(int64_t now) {
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (now - it->second->lastActiveMs >= options.keepAliveTimeoutMs) {
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Read whatever is available; false once the peer is gone
+    bool receive(Connection& connection) {
+        char buffer[kReadChunk];
+        for (;;) {
+            ssize_t got = ::recv(connection.fd.get(), buffer, sizeof(buffer), 0);
+            if (got > 0) {
+                connection.input.append(buffer, static_cast<size_t>(got));
+                if (connection.input.size() > options.maxRequestBytes * 4) {
+                    return true; // Enough to work on; the rest waits in the socket
+                }
+                continue;
+            }
+            if (got == 0) {
+                // Half-closed: answer what has already arrived, then close
+                connection.peerClosed = true;
+                return !connection.input.empty();
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+    }
+
+    // Answer complete requests until one blocks on output or input runs out
+    bool serve(Connection& connection) {
+        while (!connection.writing) {
+            size_t end = connection.input.find("\r\n\r\n");
+            if (end == std::string::npos) {
+                if (connection.input.size() > options.maxRequestBytes) {
+                    respondError(connection, 431, false);
+                    return flush(connection);
+                }
+                return !connection.peerClosed;
+            }
+            if (end > options.maxRequestBytes) {
+                respondError(connection, 431, false);
+                return flush(connection);
+            }
+            std::string head = connection.input.substr(0, end);
+            connection.input.erase(0, end + 4);
+            ++requestCount;
+            respond(connection, head);
+            if (!flush(connection)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::string& currentDate() {
+        time_t second = std::time(nullptr);
+        if (second != dateSecond) {
+            dateSecond = second;
+            date = httpDate(second);
+        }
+        return date;
+    }
+
+    void beginHeaders(Connection& connection, int status, bool keepAlive) {
+        std::string& out = connection.output;
+        out.clear();
+        connection.outputSent = 0;
+        out += "HTTP/1.1 ";
+        out += std::to_string(status);
+        out += ' ';
+        out += statusText(status);
+        out += "\r\nDate: ";
+        out += currentDate();
+        out += keepAlive ? "\r\nConnection: keep-alive\r\n" : "\r\nConnection: close\r\n";
+        connection.closeAfterResponse = connection.closeAfterResponse || !keepAlive;
+    }
+
+    void respondError(Connection& connection, int status, bool keepAlive, std::string_view location = {}) {
+        beginHeaders(connection, status, keepAlive);
+        std::string body = std::to_string(status) + " " + statusText(status) + "\n";
+        std::string& out = connection.output;
+        if (!location.empty()) {
+            out += "Location: ";
+            out += location;
+            out += "\r\n";
+        }
+        if (status == 405) {
+            out += "Allow: GET, HEAD\r\n";
+        }
+        out += "Content-Type: text/plain; charset=utf-8\r\nContent-Length: ";
+        out += std::to_string(body.size());
+        out += "\r\n\r\n";
+        out += body;
+        connection.file.reset();
+        connection.bodyRemaining = 0;
+    }
+
+    void respond(Connection& connection, std::string_view head) {
+        Request request;
+        if (!parseRequest(head, request) || request.hasBody) {
+            respondError(connection, 400, false);
+            return;
+        }
+        bool keepAlive = request.keepAlive;
+        bool headOnly = request.method == "HEAD";
+        if (!headOnly && request.method != "GET") {
+            respondError(connection, 405, keepAlive);
+            return;
+        }
+        if (!decodeTarget(request.target, relative)) {
+            respondError(connection, 400, keepAlive);
+            return;
+        }
+        if (relative.empty() || relative.back() == '/') {
+            relative += options.indexFile;
+        }
+
+        AssetLookup lookup = assets.lookup(relative);
+        if (!lookup.asset) {
+            if (lookup.status == AssetStatus::Directory) {
+                // From the decoded path, not the raw target, so "//host" cannot become an off-site Location
+                respondError(connection, 301, keepAlive, "/" + encodePath(relative) + "/");
+            } else {
+                respondError(connection, lookup.status == AssetStatus::Forbidden ? 403 : 404, keepAlive);
+            }
+            return;
+        }
+        if (lookup.cached) {
+            ++cacheHits;
+        }
+        const std::shared_ptr<const Asset>& file = lookup.asset;
+
+        // Conditional requests: If-None-Match takes precedence over the date
+        bool unchanged = false;
+        if (!request.ifNoneMatch.empty()) {
+            unchanged = file->matchesETag(request.ifNoneMatch);
+        } else if (!request.ifModifiedSince.empty()) {
+            unchanged = !file->modifiedSince(request.ifModifiedSince);
+        }
+        std::string& out = connection.output;
+        if (unchanged) {
+            ++notModified;
+            beginHeaders(connection, 304, keepAlive);
+            out += "ETag: " + file->etag() + "\r\nLast-Modified: " + file->lastModified() + "\r\n\r\n";
+            connection.file.reset();
+            connection.bodyRemaining = 0;
+            return;
+        }
+
+        uint64_t first = 0;
+        uint64_t last = file->size() == 0 ? 0 : file->size() - 1;
+        RangeResult range = RangeResult::None;
+        if (!request.range.empty() &&
+            (request.ifRange.empty() || request.ifRange == file->etag() || request.ifRange == file->lastModified())) {
+            range = parseRange(request.range, file->size(), first, last);
+        }
+        if (range == RangeResult::Unsatisfiable) {
+            beginHeaders(connection, 416, keepAlive);
+            out += "Content-Range: bytes */" + std::to_string(file->size()) + "\r\nContent-Length: 0\r\n\r\n";
+            connection.file.reset();
+            connection.bodyRemaining = 0;
+            return;
+        }
+
+        uint64_t length = file->size() == 0 ? 0 : last - first + 1;
+        beginHeaders(connection, range == RangeResult::Satisfiable ? 206 : 200, keepAlive);
+        out += file->headers();
+        out += "Content-Length: ";
+        out += std::to_string(length);
+        if (range == RangeResult::Satisfiable) {
+            out += "\r\nContent-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+                   std::to_string(file->size());
+        }
+        out += "\r\n\r\n";
+
+        connection.file = headOnly ? nullptr : file;
+        connection.bodyOffset = first;
+        connection.bodyRemaining = headOnly ? 0 : length;
+    }
+
+    /**
+     * Push the pending head and body; false if the connection is done
+     * (error or Connection: close). When the socket fills up, switch the
+     * connection to EPOLLOUT and resume from here on the next event.
+     */
+    bool flush(Connection& connection) {
+        int fd = connection.fd.get();
+        while (connection.outputSent < connection.output.size()) {
+            int flags = MSG_NOSIGNAL | (connection.bodyRemaining > 0 ? MSG_MORE : 0);
+            ssize_t sent = ::send(fd, connection.output.data() + connection.outputSent,
+                                  connection.output.size() - connection.outputSent, flags);
+            if (sent < 0) {
+                return wouldBlock(connection);
+            }
+            connection.outputSent += static_cast<size_t>(sent);
+        }
+        while (connection.bodyRemaining > 0) {
+            off_t offset = static_cast<off_t>(connection.bodyOffset);
+            size_t chunk = static_cast<size_t>(std::min<uint64_t>(connection.bodyRemaining, 1 << 30));
+            ssize_t sent = ::sendfile(fd, connection.file->fd(), &offset, chunk);
+            if (sent < 0) {
+                return wouldBlock(connection);
+            }
+            if (sent == 0) {
+                return false; // Truncated underneath us; the length promised can no longer be met
+            }
+            connection.bodyOffset += static_cast<uint64_t>(sent);
+            connection.bodyRemaining -= static_cast<uint64_t>(sent);
+            bodyBytes += static_cast<uint64_t>(sent);
+        }
+
+        connection.output.clear();
+        connection.outputSent = 0;
+        connection.file.reset();
+        if (connection.writing) {
+            connection.writing = false;
+            if (!control(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_MOD)) {
+                return false;
+            }
+        }
+        return !connection.closeAfterResponse;
+    }
+
+    bool wouldBlock(Connection& connection) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            return false;
+        }
+        if (!connection.writing) {
+            connection.writing = true;
+            return control(connection.fd.get(), EPOLLOUT, EPOLL_CTL_MOD);
+        }
+        return true;
+    }
+};
+
+StaticServer::StaticServer(const Path& root, StaticServerOptions options) : m_options(std::move(options)) {
+    AssetCacheOptions assets;
+    assets.capacity = m_options.openFileCache;
+    assets.revalidateMs = m_options.revalidateMs;
+    m_assets = std::make_unique<AssetCache>(root, assets);
+}
+
+StaticServer::~StaticServer() {
+    stop();
+}
+
+void StaticServer::start() {
+    if (running()) {
+        return;
+    }
+
+    struct sockaddr_in address;
+    std::memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(m_options.port);
+    if (::inet_pton(AF_INET, m_options.address.c_str(), &address.sin_addr) != 1) {
+        throw FileSystemException("Invalid listen address: " + m_options.address);
+    }
+
+    std::vector<std::unique_ptr<Loop>> loops;
+    for (size_t i = 0; i < std::max<size_t>(m_options.threads, 1); ++i) {
+        auto loop = std::make_unique<Loop>(m_options, *m_assets);
+        loop->listener.reset(::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0));
+        int one = 1;
+        ::setsockopt(loop->listener.get(), SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        ::setsockopt(loop->listener.get(), SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        if (!loop->listener.valid() ||
+            ::bind(loop->listener.get(), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(loop->listener.get(), SOMAXCONN) != 0) {
+            throw FileSystemException("Could not listen on " + m_options.address + ": " + std::strerror(errno));
+        }
+        // Later loops join the port the first one was given
+        socklen_t length = sizeof(address);
+        ::getsockname(loop->listener.get(), reinterpret_cast<sockaddr*>(&address), &length);
+
+        loop->epoll.reset(::epoll_create1(EPOLL_CLOEXEC));
+        loop->wake.reset(::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+        loop->reserve.reset(::open("/dev/null", O_RDONLY | O_CLOEXEC));
+        if (!loop->epoll.valid() || !loop->wake.valid()) {
+            throw FileSystemException("Could not create event loop");
+        }
+        loop->watch(loop->listener.get(), EPOLLIN, EPOLL_CTL_ADD);
+        loop->watch(loop->wake.get(), EPOLLIN, EPOLL_CTL_ADD);
+        loops.push_back(std::move(loop));
+    }
+    m_port = ntohs(address.sin_port);
+
+    m_loops = std::move(loops);
+    for (auto& loop : m_loops) {
+        Loop* raw = loop.get();
+        m_threads.emplace_back([raw]() { raw->run(); });
+    }
+}
+
+void StaticServer::stop() {
+    for (auto& loop : m_loops) {
+        uint64_t one = 1;
+        ssize_t written = ::write(loop->wake.get(), &one, sizeof(one));
+        (void)written;
+    }
+    for (std::thread& thread : m_threads) {
+        thread.join();
+    }
+    m_threads.clear();
+    m_loops.clear();
+}
+
+StaticServerStats StaticServer::stats() const {
+    StaticServerStats stats;
+    for (const auto& loop : m_loops) {
+        stats.connections += loop->connectionCount;
+        stats.requests += loop->requestCount;
+        stats.bodyBytes += loop->bodyBytes;
+        stats.cacheHits += loop->cacheHits;
+        stats.notModified += loop->notModified;
+    }
+    return stats;
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __linux__
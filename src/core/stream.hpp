@@ -0,0 +1,93 @@
+#ifndef CROSSDEV_STREAM_HPP
+#define CROSSDEV_STREAM_HPP
+
+#include "filesystem.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Sequential reader for large files.
+ *
+ * In IoMode::Direct the file is read in whole aligned blocks from
+ * AlignedBufferPool::shared(), bypassing the page cache.
+ */
+class FileReader {
+public:
+    explicit FileReader(const Path& path, IoMode mode = IoMode::Buffered);
+    ~FileReader();
+
+    FileReader(FileReader&& other) noexcept;
+    FileReader& operator=(FileReader&& other) noexcept;
+    FileReader(const FileReader&) = delete;
+    FileReader& operator=(const FileReader&) = delete;
+
+    /** Read up to length bytes; returns 0 at end of file */
+    size_t read(void* buffer, size_t length);
+
+    uint64_t size() const;
+    /** Modification time when the file was opened, in nanoseconds since the epoch */
+    int64_t mtimeNs() const;
+    /** True if the cache is actually being bypassed */
+    bool direct() const;
+    /** Advise the kernel; DontNeed also evicts each chunk once it is read */
+    void advise(AccessHint hint);
+    void close();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+/**
+ * Sequential writer for large files; creates or truncates the target.
+ *
+ * In IoMode::Direct data is staged in aligned blocks and written with the
+ * cache bypassed. The final partial block is written after switching the
+ * descriptor back to buffered mode, so any file length is supported.
+ */
+class FileWriter {
+public:
+    explicit FileWriter(const Path& path, IoMode mode = IoMode::Buffered);
+    /** Closes the file, discarding errors; call close() to observe them */
+    ~FileWriter();
+
+    FileWriter(FileWriter&& other) noexcept;
+    FileWriter& operator=(FileWriter&& other) noexcept;
+    FileWriter(const FileWriter&) = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    void write(const void* data, size_t length);
+
+    /**
+     * Preallocate space for a known final size without changing the file
+     * length. Throws if the device is too full; any unused reservation is
+     * released by close().
+     */
+    void reserve(uint64_t bytes);
+
+    uint64_t written() const;
+    /** True if the cache is actually being bypassed */
+    bool direct() const;
+    /** Advise the kernel; DontNeed also evicts each chunk once it is on disk */
+    void advise(AccessHint hint);
+    /**
+     * Have close() set the file's modification time, in nanoseconds since
+     * the epoch, once the last byte is written
+     */
+    void setMtime(int64_t mtimeNs);
+    void close();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> m_impl;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_STREAM_HPP
@@ -0,0 +1,386 @@
+#include "stream.hpp"
+#include "buffer_pool.hpp"
+#include "unix_io.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Open with the page cache bypassed if the filesystem allows it
+int openFile(const Path& path, int flags, IoMode mode, bool& direct) {
+    direct = false;
+    int fd = -1;
+#ifdef O_DIRECT
+    if (mode == IoMode::Direct) {
+        fd = ::open(path.toString().c_str(), flags | O_DIRECT, 0666);
+        if (fd >= 0) {
+            direct = true;
+            return fd;
+        }
+        if (errno != EINVAL) {
+            return -1;
+        }
+        // EINVAL: the filesystem has no O_DIRECT support (e.g. tmpfs)
+    }
+#endif
+    fd = ::open(path.toString().c_str(), flags, 0666);
+#ifdef F_NOCACHE
+    if (fd >= 0 && mode == IoMode::Direct) {
+        direct = fcntl(fd, F_NOCACHE, 1) == 0;
+    }
+#endif
+    return fd;
+}
+
+void disableDirect(int fd, bool& direct) {
+#ifdef O_DIRECT
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags & ~O_DIRECT);
+    }
+#endif
+    direct = false;
+}
+
+// pread/pwrite wrappers that retry EINTR and drop O_DIRECT on EINVAL
+ssize_t readAt(int fd, char* buffer, size_t length, off_t offset, bool& direct) {
+    for (;;) {
+        ssize_t got = pread(fd, buffer, length, offset);
+        if (got >= 0) {
+            return got;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EINVAL && direct) {
+            disableDirect(fd, direct);
+            continue;
+        }
+        throw FileSystemException("Could not read file");
+    }
+}
+
+void writeAt(int fd, const char* data, size_t length, off_t offset, bool& direct) {
+    while (length > 0) {
+        ssize_t put = pwrite(fd, data, length, offset);
+        if (put < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EINVAL && direct) {
+                disableDirect(fd, direct);
+                continue;
+            }
+            if (errno == ENOSPC) {
+                throw FileSystemException("No space left on device");
+            }
+            throw FileSystemException("Could not write file");
+        }
+        data += put;
+        length -= static_cast<size_t>(put);
+        offset += put;
+    }
+}
+
+} // namespace
+
+// FileReader implementation
+struct FileReader::Impl {
+    int fd = -1;
+    bool direct = false;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    off_t offset = 0;
+    AlignedBufferPool::Buffer buffer;
+    size_t begin = 0;
+    size_t end = 0;
+    bool eof = false;
+    bool dropBehind = false;
+    off_t dropped = 0;
+
+    ~Impl() {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    // Evict everything fetched so far; called after each read
+    void dropConsumed() {
+        if (dropBehind && offset > dropped) {
+            detail::adviseDescriptor(fd, AccessHint::DontNeed, dropped, offset - dropped);
+            dropped = offset;
+        }
+    }
+};
+
+FileReader::FileReader(const Path& path, IoMode mode) : m_impl(new Impl) {
+    m_impl->fd = openFile(path, O_RDONLY | O_CLOEXEC, mode, m_impl->direct);
+    if (m_impl->fd < 0) {
+        throw FileSystemException("Could not open file for reading");
+    }
+    struct stat st;
+    if (fstat(m_impl->fd, &st) != 0) {
+        throw FileSystemException("Could not get file size");
+    }
+    m_impl->size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    m_impl->mtimeNs = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    m_impl->mtimeNs = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+    if (m_impl->direct) {
+        m_impl->buffer = AlignedBufferPool::shared().acquire();
+    }
+}
+
+FileReader::~FileReader() = default;
+FileReader::FileReader(FileReader&& other) noexcept = default;
+FileReader& FileReader::operator=(FileReader&& other) noexcept = default;
+
+size_t FileReader::read(void* buffer, size_t length) {
+    Impl& impl = *m_impl;
+    if (impl.fd < 0) {
+        throw FileSystemException("File is closed");
+    }
+
+    if (!impl.buffer) {
+        // Buffered mode reads straight into the caller's memory
+        ssize_t got = readAt(impl.fd, static_cast<char*>(buffer), length, impl.offset, impl.direct);
+        impl.offset += got;
+        impl.dropConsumed();
+        return static_cast<size_t>(got);
+    }
+
+    // Direct mode: whole aligned blocks are staged in the pooled buffer
+    size_t copied = 0;
+    char* out = static_cast<char*>(buffer);
+    while (copied < length) {
+        if (impl.begin == impl.end) {
+            if (impl.eof) {
+                break;
+            }
+            ssize_t got = readAt(impl.fd, impl.buffer.data(), impl.buffer.size(), impl.offset, impl.direct);
+            impl.offset += got;
+            impl.begin = 0;
+            impl.end = static_cast<size_t>(got);
+            // A short read only happens at the unaligned tail of the file
+            impl.eof = static_cast<size_t>(got) < impl.buffer.size();
+            impl.dropConsumed();
+            if (got == 0) {
+                break;
+            }
+        }
+        size_t chunk = std::min(length - copied, impl.end - impl.begin);
+        std::memcpy(out + copied, impl.buffer.data() + impl.begin, chunk);
+        impl.begin += chunk;
+        copied += chunk;
+    }
+    return copied;
+}
+
+uint64_t FileReader::size() const {
+    return m_impl->size;
+}
+
+int64_t FileReader::mtimeNs() const {
+    return m_impl->mtimeNs;
+}
+
+bool FileReader::direct() const {
+    return m_impl->direct;
+}
+
+void FileReader::advise(AccessHint hint) {
+    detail::adviseDescriptor(m_impl->fd, hint, 0, 0);
+    m_impl->dropBehind = hint == AccessHint::DontNeed;
+}
+
+void FileReader::close() {
+    if (m_impl->fd >= 0) {
+        ::close(m_impl->fd);
+        m_impl->fd = -1;
+    }
+}
+
+// FileWriter implementation
+struct FileWriter::Impl {
+    int fd = -1;
+    bool direct = false;
+    off_t offset = 0;
+    AlignedBufferPool::Buffer buffer;
+    size_t fill = 0;
+    uint64_t reserved = 0;
+    bool stampMtime = false;
+    int64_t mtimeNs = 0;
+    std::unique_ptr<detail::DropBehind> dropBehind;
+
+    ~Impl() {
+        dropBehind.reset();
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+
+    void put(const char* data, size_t length) {
+        writeAt(fd, data, length, offset, direct);
+        if (dropBehind) {
+            dropBehind->written(offset, static_cast<off_t>(length));
+        }
+        offset += static_cast<off_t>(length);
+    }
+
+    void flushBlock() {
+        put(buffer.data(), fill);
+        fill = 0;
+    }
+};
+
+FileWriter::FileWriter(const Path& path, IoMode mode) : m_impl(new Impl) {
+    m_impl->fd = openFile(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode, m_impl->direct);
+    if (m_impl->fd < 0) {
+        throw FileSystemException("Could not open file for writing");
+    }
+    if (m_impl->direct) {
+        m_impl->buffer = AlignedBufferPool::shared().acquire();
+    }
+}
+
+FileWriter::~FileWriter() {
+    if (m_impl) {
+        try {
+            close();
+        } catch (const FileSystemException&) {
+        }
+    }
+}
+
+FileWriter::FileWriter(FileWriter&& other) noexcept = default;
+
+// Not defaulted: the writer being replaced must flush its staged tail first, as ~FileWriter() does
+FileWriter& FileWriter::operator=(FileWriter&& other) noexcept {
+    if (this != &other) {
+        if (m_impl) {
+            try {
+                close();
+            } catch (const FileSystemException&) {
+            }
+        }
+        m_impl = std::move(other.m_impl);
+    }
+    return *this;
+}
+
+void FileWriter::write(const void* data, size_t length) {
+    Impl& impl = *m_impl;
+    if (impl.fd < 0) {
+        throw FileSystemException("File is closed");
+    }
+
+    const char* in = static_cast<const char*>(data);
+    if (!impl.buffer) {
+        impl.put(in, length);
+        return;
+    }
+
+    while (length > 0) {
+        size_t chunk = std::min(length, impl.buffer.size() - impl.fill);
+        std::memcpy(impl.buffer.data() + impl.fill, in, chunk);
+        impl.fill += chunk;
+        in += chunk;
+        length -= chunk;
+        if (impl.fill == impl.buffer.size()) {
+            impl.flushBlock();
+        }
+    }
+}
+
+void FileWriter::reserve(uint64_t bytes) {
+    Impl& impl = *m_impl;
+    if (impl.fd < 0) {
+        throw FileSystemException("File is closed");
+    }
+    int error = detail::preallocate(impl.fd, 0, static_cast<off_t>(bytes), true);
+    if (error == ENOSPC) {
+        throw FileSystemException("No space left on device");
+    }
+    if (error != 0) {
+        throw FileSystemException("Could not reserve file space");
+    }
+    impl.reserved = std::max(impl.reserved, bytes);
+}
+
+uint64_t FileWriter::written() const {
+    return static_cast<uint64_t>(m_impl->offset) + m_impl->fill;
+}
+
+bool FileWriter::direct() const {
+    return m_impl->direct;
+}
+
+void FileWriter::advise(AccessHint hint) {
+    detail::adviseDescriptor(m_impl->fd, hint, 0, 0);
+    if (hint == AccessHint::DontNeed) {
+        if (!m_impl->dropBehind) {
+            m_impl->dropBehind.reset(new detail::DropBehind(m_impl->fd));
+        }
+    } else {
+        m_impl->dropBehind.reset();
+    }
+}
+
+void FileWriter::setMtime(int64_t mtimeNs) {
+    m_impl->stampMtime = true;
+    m_impl->mtimeNs = mtimeNs;
+}
+
+void FileWriter::close() {
+    Impl& impl = *m_impl;
+    if (impl.fd < 0) {
+        return;
+    }
+    if (impl.fill > 0) {
+        // The tail is not a whole block, which O_DIRECT cannot write
+        if (impl.direct) {
+            disableDirect(impl.fd, impl.direct);
+        }
+        impl.flushBlock();
+    }
+    impl.dropBehind.reset();
+    // Blocks reserved past the final length would otherwise stay allocated
+    if (impl.reserved > static_cast<uint64_t>(impl.offset) && ftruncate(impl.fd, impl.offset) != 0) {
+        throw FileSystemException("Could not release reserved space");
+    }
+    if (impl.stampMtime) {
+        struct timespec times[2];
+        times[0].tv_sec = 0;
+        times[0].tv_nsec = UTIME_OMIT;
+        // Floor division, so times before the epoch keep tv_nsec in [0, 1e9)
+        int64_t seconds = impl.mtimeNs / 1000000000 - (impl.mtimeNs % 1000000000 < 0 ? 1 : 0);
+        times[1].tv_sec = static_cast<time_t>(seconds);
+        times[1].tv_nsec = static_cast<long>(impl.mtimeNs - seconds * 1000000000);
+        if (::futimens(impl.fd, times) != 0) {
+            throw FileSystemException("Could not set modification time");
+        }
+    }
+    int fd = impl.fd;
+    impl.fd = -1;
+    if (::close(fd) != 0) {
+        throw FileSystemException("Could not close file");
+    }
+}
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
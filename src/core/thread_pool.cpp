@@ -0,0 +1,143 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace crossdev {
+
+namespace {
+
+thread_local const ThreadPool* t_currentPool = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+struct ParallelForState {
+    std::atomic<size_t> next{0};
+    size_t count = 0;
+    size_t inFlight = 0;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done;
+};
+
+void drain(ParallelForState& state, const std::function<void(size_t)>& body) {
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(state.mutex);
+            ++state.inFlight;
+        }
+        size_t index = state.next.fetch_add(1);
+        if (index < state.count) {
+            try {
+                body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(state.mutex);
+                if (!state.error) {
+                    state.error = std::current_exception();
+                }
+                // Stop handing out further iterations
+                state.next.store(state.count);
+            }
+        }
+        std::lock_guard<std::mutex> lock(state.mutex);
+        --state.inFlight;
+        if (index >= state.count) {
+            if (state.inFlight == 0) {
+                state.done.notify_all();
+            }
+            return;
+        }
+    }
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t threads, size_t maxQueued)
+    : m_maxQueued(std::max<size_t>(maxQueued, 1)) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        m_workers.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_notEmpty.notify_all();
+    m_notFull.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::enqueue(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    // A worker waiting on its own pool would deadlock behind a full queue
+    if (t_currentPool != this) {
+        m_notFull.wait(lock, [this]() { return m_stopping || m_queue.size() < m_maxQueued; });
+    }
+    m_queue.push_back(std::move(task));
+    lock.unlock();
+    m_notEmpty.notify_one();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    t_currentPool = this;
+    t_workerIndex = index;
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_notEmpty.wait(lock, [this]() { return m_stopping || !m_queue.empty(); });
+            if (m_queue.empty()) {
+                return;
+            }
+            task = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+        m_notFull.notify_one();
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+    state->count = count;
+
+    size_t helpers = std::min(m_workers.size(), count - 1);
+    for (size_t i = 0; i < helpers; ++i) {
+        // Helpers that start after the range is exhausted simply return
+        enqueue([state, &body]() { drain(*state, body); });
+    }
+    drain(*state, body);
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() {
+        return state->inFlight == 0 && state->next.load() >= state->count;
+    });
+    if (state->error) {
+        std::rethrow_exception(state->error);
+    }
+}
+
+size_t ThreadPool::workerIndex() const {
+    return t_currentPool == this ? t_workerIndex : m_workers.size();
+}
+
+ThreadPool& ThreadPool::io() {
+    // I/O tasks spend most of their time blocked in the kernel, so the pool
+    // is deliberately wider than the number of cores
+    static ThreadPool pool(std::max(4u, 2 * std::thread::hardware_concurrency()), 4096);
+    return pool;
+}
+
+} // namespace crossdev
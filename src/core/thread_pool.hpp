@@ -0,0 +1,79 @@
+#ifndef CROSSDEV_THREAD_POOL_HPP
+#define CROSSDEV_THREAD_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace crossdev {
+
+/**
+ * Fixed-size worker pool with a bounded task queue.
+ *
+ * submit() blocks while the queue is full, so producers that enqueue
+ * faster than the workers drain are throttled instead of growing memory.
+ */
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t threads = 0, size_t maxQueued = 1024);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * Queue a callable and return a future for its result.
+     * Exceptions thrown by the callable are delivered through the future.
+     */
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packaged->get_future();
+        enqueue([packaged]() { (*packaged)(); });
+        return future;
+    }
+
+    /**
+     * Run body(i) for every i in [0, count) across the pool and wait.
+     * The calling thread participates, so this is safe to call from a worker.
+     * The first exception thrown by any iteration is rethrown.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    size_t size() const { return m_workers.size(); }
+
+    /**
+     * Index of the calling worker in [0, size()), or size() when called
+     * from a thread that does not belong to this pool.
+     */
+    size_t workerIndex() const;
+
+    /**
+     * Process-wide pool shared by the asynchronous filesystem operations.
+     */
+    static ThreadPool& io();
+
+private:
+    void enqueue(std::function<void()> task);
+    void workerLoop(size_t index);
+
+    std::vector<std::thread> m_workers;
+    std::deque<std::function<void()>> m_queue;
+    size_t m_maxQueued;
+    bool m_stopping = false;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::condition_variable m_notFull;
+};
+
+} // namespace crossdev
+
+#endif // CROSSDEV_THREAD_POOL_HPP
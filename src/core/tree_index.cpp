@@ -0,0 +1,330 @@
+#include "tree_index.hpp"
+#include "index_format.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'D', 'X', 'T', 'R', 'E', 'E', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint32_t kBlockSize = 16;
+
+using detail::Section;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t entryCount;
+    uint64_t extensionCount;
+    uint32_t blockSize;
+    uint32_t reserved;
+    Section root;
+    Section blockOffsets;
+    Section paths;
+    Section types;
+    Section sizes;
+    Section mtimes;
+    Section extensionIds;
+    Section extensionOffsets;
+    Section extensionNames;
+};
+
+static_assert(sizeof(Header) % 8 == 0, "sections after the header must stay 8-byte aligned");
+
+[[noreturn]] void corrupt() {
+    throw FileSystemException("Corrupt tree index");
+}
+
+const uint8_t* getVarint(const uint8_t* position, const uint8_t* end, uint64_t& value) {
+    position = detail::getVarint(position, end, value);
+    if (position == nullptr) {
+        corrupt();
+    }
+    return position;
+}
+
+std::string lowerAscii(std::string_view text) {
+    std::string result(text);
+    detail::lowerAsciiInPlace(result);
+    return result;
+}
+
+} // namespace
+
+void TreeIndex::write(const PathList& entries, const Path& file) {
+    const size_t count = entries.size();
+
+    std::vector<std::string> paths(count);
+    for (size_t i = 0; i < count; ++i) {
+        entries.relativePathInto(i, paths[i]);
+    }
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return paths[a] < paths[b]; });
+
+    // Extension table in sorted order; "" is id 0
+    std::map<std::string, uint32_t> extensionIds{{std::string(), 0}};
+    std::vector<std::string> lowered(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (entries.type(i) != EntryType::Directory) {
+            lowered[i] = lowerAscii(extensionOf(entries.name(i)));
+            extensionIds.emplace(lowered[i], 0);
+        }
+    }
+    std::vector<uint32_t> extensionOffsets{0};
+    std::string extensionNames;
+    uint32_t nextId = 0;
+    for (auto& extension : extensionIds) {
+        extension.second = nextId++;
+        extensionNames += extension.first;
+        extensionOffsets.push_back(static_cast<uint32_t>(extensionNames.size()));
+    }
+
+    std::string pathData;
+    std::vector<uint64_t> blockOffsets;
+    std::vector<EntryType> types(count);
+    std::vector<uint64_t> sizes(count);
+    std::vector<int64_t> mtimes(count);
+    std::vector<uint32_t> extensions(count);
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t i = order[k];
+        const std::string& path = paths[i];
+        if (k % kBlockSize == 0) {
+            blockOffsets.push_back(pathData.size());
+            detail::putVarint(pathData, path.size());
+            pathData += path;
+        } else {
+            const std::string& previous = paths[order[k - 1]];
+            size_t shared = 0;
+            size_t limit = std::min(previous.size(), path.size());
+            while (shared < limit && previous[shared] == path[shared]) {
+                ++shared;
+            }
+            detail::putVarint(pathData, shared);
+            detail::putVarint(pathData, path.size() - shared);
+            pathData.append(path, shared, std::string::npos);
+        }
+        types[k] = entries.type(i);
+        sizes[k] = entries.fileSize(i);
+        mtimes[k] = entries.mtime(i);
+        extensions[k] = extensionIds[lowered[i]];
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = detail::kByteOrderMark;
+    header.entryCount = count;
+    header.extensionCount = extensionIds.size();
+    header.blockSize = kBlockSize;
+
+    std::string out(sizeof(Header), '\0');
+    std::string root = entries.root().toString();
+    header.root = detail::appendSection(out, root.data(), root.size());
+    header.blockOffsets = detail::appendColumn(out, blockOffsets);
+    header.paths = detail::appendSection(out, pathData.data(), pathData.size());
+    header.types = detail::appendColumn(out, types);
+    header.sizes = detail::appendColumn(out, sizes);
+    header.mtimes = detail::appendColumn(out, mtimes);
+    header.extensionIds = detail::appendColumn(out, extensions);
+    header.extensionOffsets = detail::appendColumn(out, extensionOffsets);
+    header.extensionNames = detail::appendSection(out, extensionNames.data(), extensionNames.size());
+    std::memcpy(&out[0], &header, sizeof(header));
+
+    // Readers may have the old index mapped: never rewrite it in place
+    detail::writeFileAtomically(file, out);
+}
+
+TreeIndex::TreeIndex(const Path& file) : m_file(file) {
+    const char* base = m_file.data();
+    const uint64_t fileSize = m_file.size();
+    if (fileSize < sizeof(Header)) {
+        corrupt();
+    }
+    Header header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+        throw FileSystemException("Not a tree index: " + file.toString());
+    }
+    if (header.version != kVersion) {
+        throw FileSystemException("Unsupported tree index version: " + std::to_string(header.version));
+    }
+    if (header.byteOrder != detail::kByteOrderMark) {
+        throw FileSystemException("Tree index was written with another byte order");
+    }
+
+    const uint64_t count = header.entryCount;
+    const uint64_t blocks = (count + kBlockSize - 1) / kBlockSize;
+    auto check = [&](const Section& section, uint64_t expectedLength) {
+        const char* data = detail::sectionData(base, fileSize, section, expectedLength);
+        if (data == nullptr) {
+            corrupt();
+        }
+        return data;
+    };
+    if (header.blockSize != kBlockSize || count > fileSize || header.extensionCount == 0 ||
+        header.extensionCount > fileSize) {
+        corrupt();
+    }
+
+    m_root = std::string_view(check(header.root, UINT64_MAX), header.root.length);
+    m_count = static_cast<size_t>(count);
+    m_blockCount = static_cast<size_t>(blocks);
+    m_blockOffsets = reinterpret_cast<const uint64_t*>(check(header.blockOffsets, blocks * 8));
+    m_paths = reinterpret_cast<const uint8_t*>(check(header.paths, UINT64_MAX));
+    m_pathsEnd = m_paths + header.paths.length;
+    m_types = reinterpret_cast<const EntryType*>(check(header.types, count));
+    m_sizes = reinterpret_cast<const uint64_t*>(check(header.sizes, count * 8));
+    m_mtimes = reinterpret_cast<const int64_t*>(check(header.mtimes, count * 8));
+    m_extensionIds = reinterpret_cast<const uint32_t*>(check(header.extensionIds, count * 4));
+    m_extensionCount = static_cast<size_t>(header.extensionCount);
+    m_extensionOffsets =
+        reinterpret_cast<const uint32_t*>(check(header.extensionOffsets, (header.extensionCount + 1) * 4));
+    m_extensionNames = check(header.extensionNames, UINT64_MAX);
+    m_extensionNamesLength = static_cast<size_t>(header.extensionNames.length);
+}
+
+const uint8_t* TreeIndex::decode(const uint8_t* position, bool first, std::string& path) const {
+    uint64_t shared = 0;
+    if (!first) {
+        position = getVarint(position, m_pathsEnd, shared);
+    }
+    uint64_t length;
+    position = getVarint(position, m_pathsEnd, length);
+    if (shared > path.size() || length > static_cast<uint64_t>(m_pathsEnd - position)) {
+        corrupt();
+    }
+    path.resize(static_cast<size_t>(shared));
+    path.append(reinterpret_cast<const char*>(position), static_cast<size_t>(length));
+    return position + length;
+}
+
+const uint8_t* TreeIndex::blockStart(size_t block) const {
+    if (m_blockOffsets[block] >= static_cast<uint64_t>(m_pathsEnd - m_paths)) {
+        corrupt();
+    }
+    return m_paths + m_blockOffsets[block];
+}
+
+void TreeIndex::relativePathInto(size_t index, std::string& out) const {
+    size_t block = index / kBlockSize;
+    const uint8_t* position = blockStart(block);
+    out.clear();
+    for (size_t i = block * kBlockSize; i <= index; ++i) {
+        position = decode(position, i == block * kBlockSize, out);
+    }
+}
+
+std::string TreeIndex::relativePath(size_t index) const {
+    std::string result;
+    relativePathInto(index, result);
+    return result;
+}
+
+Path TreeIndex::path(size_t index) const {
+    std::string relative;
+    relativePathInto(index, relative);
+    return Path(m_root) / relative;
+}
+
+size_t TreeIndex::find(std::string_view relativePath) const {
+    // Last block whose first path is not greater than the key
+    auto firstPath = [&](size_t block) {
+        const uint8_t* position = blockStart(block);
+        uint64_t length;
+        position = getVarint(position, m_pathsEnd, length);
+        if (length > static_cast<uint64_t>(m_pathsEnd - position)) {
+            corrupt();
+        }
+        return std::string_view(reinterpret_cast<const char*>(position), static_cast<size_t>(length));
+    };
+    size_t low = 0;
+    size_t high = m_blockCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (firstPath(middle) <= relativePath) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == 0) {
+        return npos;
+    }
+
+    Cursor cursor(*this, (low - 1) * kBlockSize);
+    std::string_view path;
+    for (size_t i = 0; i < kBlockSize && cursor.next(path); ++i) {
+        if (path == relativePath) {
+            return cursor.index();
+        }
+        if (path > relativePath) {
+            break;
+        }
+    }
+    return npos;
+}
+
+std::string_view TreeIndex::extension(uint32_t id) const {
+    if (id >= m_extensionCount) {
+        corrupt();
+    }
+    uint32_t begin = m_extensionOffsets[id];
+    uint32_t end = m_extensionOffsets[id + 1];
+    if (begin > end || end > m_extensionNamesLength) {
+        corrupt();
+    }
+    return std::string_view(m_extensionNames + begin, end - begin);
+}
+
+size_t TreeIndex::findExtension(std::string_view extension) const {
+    std::string key = lowerAscii(extension);
+    // The table is sorted, so binary search it
+    size_t low = 0;
+    size_t high = m_extensionCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (this->extension(static_cast<uint32_t>(middle)) < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low < m_extensionCount && this->extension(static_cast<uint32_t>(low)) == key ? low : npos;
+}
+
+TreeIndex::Cursor::Cursor(const TreeIndex& index, size_t begin) : m_tree(index), m_index(begin) {
+    if (begin >= index.m_count) {
+        m_index = index.m_count;
+        return;
+    }
+    // Decode from the start of the block up to the entry before begin
+    size_t block = begin / kBlockSize;
+    m_index = block * kBlockSize;
+    m_position = index.blockStart(block);
+    std::string_view skipped;
+    while (m_index < begin) {
+        next(skipped);
+    }
+}
+
+bool TreeIndex::Cursor::next(std::string_view& relativePath) {
+    if (m_index >= m_tree.m_count) {
+        return false;
+    }
+    m_position = m_tree.decode(m_position, m_index % kBlockSize == 0, m_path);
+    ++m_index;
+    relativePath = m_path;
+    return true;
+}
+
+} // namespace fs
+} // namespace crossdev
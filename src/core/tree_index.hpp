@@ -0,0 +1,116 @@
+#ifndef CROSSDEV_TREE_INDEX_HPP
+#define CROSSDEV_TREE_INDEX_HPP
+
+#include "filesystem.hpp"
+#include "mapped_file.hpp"
+#include "path_list.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * Read-only tree listing stored in a memory-mappable file.
+ *
+ * Entries are sorted by their path relative to the root. Paths are
+ * front-coded in blocks of 16: the first path of a block is stored in
+ * full, the others as the length shared with their predecessor plus the
+ * remaining suffix, and a block offset table makes every block directly
+ * addressable. Type, size, mtime and extension id live in fixed-width
+ * columns that are used in place. Extensions are lower-cased and
+ * numbered through a small table; id 0 means no extension.
+ *
+ * Opening validates only the fixed header, so it costs one mmap however
+ * large the index is. The file is written in native byte order and is
+ * rejected on a host with a different one.
+ */
+class TreeIndex {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    /** Write entries sorted by path; the file is replaced atomically */
+    static void write(const PathList& entries, const Path& file);
+
+    explicit TreeIndex(const Path& file);
+
+    std::string_view root() const { return m_root; }
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+
+    /** Path of entry index relative to the root */
+    std::string relativePath(size_t index) const;
+    void relativePathInto(size_t index, std::string& out) const;
+    /** Full path of an entry, root included */
+    Path path(size_t index) const;
+
+    /** Index of the entry with the given relative path, or npos */
+    size_t find(std::string_view relativePath) const;
+
+    EntryType type(size_t index) const { return m_types[index]; }
+    uint64_t fileSize(size_t index) const { return m_sizes[index]; }
+    int64_t mtime(size_t index) const { return m_mtimes[index]; }
+    uint32_t extensionId(size_t index) const { return m_extensionIds[index]; }
+
+    /** Columns for bulk scans, each size() long */
+    const EntryType* types() const { return m_types; }
+    const uint64_t* sizes() const { return m_sizes; }
+    const int64_t* mtimes() const { return m_mtimes; }
+    const uint32_t* extensionIds() const { return m_extensionIds; }
+
+    /** Extension table: ids run from 0 (none) to extensionCount() - 1 */
+    size_t extensionCount() const { return m_extensionCount; }
+    std::string_view extension(uint32_t id) const;
+    /** Id of an extension such as ".js" (any case), or npos if absent */
+    size_t findExtension(std::string_view extension) const;
+
+    /**
+     * Sequential decoder over the relative paths, much cheaper than
+     * calling relativePathInto() for every entry. Views stay valid until
+     * the next call to next().
+     */
+    class Cursor {
+    public:
+        explicit Cursor(const TreeIndex& index, size_t begin = 0);
+
+        /** Decode the next path; false after the last entry */
+        bool next(std::string_view& relativePath);
+        /** Index of the path most recently returned by next() */
+        size_t index() const { return m_index - 1; }
+
+    private:
+        const TreeIndex& m_tree;
+        size_t m_index;
+        const uint8_t* m_position = nullptr;
+        std::string m_path;
+    };
+
+private:
+    /** First byte of a path block, checked against the mapping */
+    const uint8_t* blockStart(size_t block) const;
+    const uint8_t* decode(const uint8_t* position, bool first, std::string& path) const;
+
+    MappedFile m_file;
+    std::string_view m_root;
+    size_t m_count = 0;
+    size_t m_blockCount = 0;
+    const uint64_t* m_blockOffsets = nullptr;
+    const uint8_t* m_paths = nullptr;
+    const uint8_t* m_pathsEnd = nullptr;
+    const EntryType* m_types = nullptr;
+    const uint64_t* m_sizes = nullptr;
+    const int64_t* m_mtimes = nullptr;
+    const uint32_t* m_extensionIds = nullptr;
+    size_t m_extensionCount = 0;
+    const uint32_t* m_extensionOffsets = nullptr;
+    const char* m_extensionNames = nullptr;
+    size_t m_extensionNamesLength = 0;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_TREE_INDEX_HPP
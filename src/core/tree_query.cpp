@@ -0,0 +1,219 @@
+#include "tree_query.hpp"
+#include "simd.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Entries per parallel task; the chunk's mask stays in L1/L2
+constexpr size_t kChunk = 1 << 15;
+
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') {
+            x = static_cast<char>(x - 'A' + 'a');
+        }
+        if (y >= 'A' && y <= 'Z') {
+            y = static_cast<char>(y - 'A' + 'a');
+        }
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view lastComponent(std::string_view path) {
+    size_t slash = path.find_last_of(Path::separator() == '/' ? "/" : "/\\");
+    return slash == std::string_view::npos ? path : path.substr(slash + 1);
+}
+
+} // namespace
+
+struct TreeQuery::Columns {
+    size_t count;
+    const EntryType* types;
+    const uint64_t* sizes;
+    const int64_t* mtimes;
+};
+
+TreeQuery::TreeQuery(ThreadPool* pool) : m_pool(pool) {}
+
+TreeQuery& TreeQuery::type(EntryType type) {
+    m_anyType = false;
+    m_type = type;
+    return *this;
+}
+
+TreeQuery& TreeQuery::sizeBetween(uint64_t minimum, uint64_t maximum) {
+    m_minSize = minimum;
+    m_maxSize = maximum;
+    return *this;
+}
+
+TreeQuery& TreeQuery::modifiedBetween(int64_t from, int64_t to) {
+    m_from = from;
+    m_to = to;
+    return *this;
+}
+
+TreeQuery& TreeQuery::extensions(std::vector<std::string> extensions) {
+    m_extensions = std::move(extensions);
+    return *this;
+}
+
+TreeQuery& TreeQuery::namePrefix(std::string prefix) {
+    m_prefix = std::move(prefix);
+    return *this;
+}
+
+TreeQuery& TreeQuery::nameContains(std::string substring) {
+    m_substring = std::move(substring);
+    return *this;
+}
+
+bool TreeQuery::matchesName(std::string_view name) const {
+    if (name.compare(0, m_prefix.size(), m_prefix) != 0) {
+        return false;
+    }
+    if (!m_substring.empty()) {
+        const char* end = name.data() + name.size();
+        return simd::findLiteral(name.data(), end, m_substring.data(), m_substring.size()) != end;
+    }
+    return true;
+}
+
+std::vector<uint32_t> TreeQuery::run(const PathList& entries) const {
+    Columns columns{entries.size(), entries.types().data(), entries.sizes().data(), entries.mtimes().data()};
+    return runColumns(columns, &entries, nullptr);
+}
+
+std::vector<uint32_t> TreeQuery::run(const TreeIndex& index) const {
+    Columns columns{index.size(), index.types(), index.sizes(), index.mtimes()};
+    return runColumns(columns, nullptr, &index);
+}
+
+std::vector<uint32_t> TreeQuery::runColumns(const Columns& columns, const PathList* entries,
+                                            const TreeIndex* index) const {
+    if (m_minSize > m_maxSize || m_from > m_to || columns.count == 0) {
+        return {};
+    }
+
+    // An index already numbers its extensions: turn the set into a lookup table
+    std::vector<uint8_t> allowedExtensions;
+    if (index != nullptr && !m_extensions.empty()) {
+        allowedExtensions.assign(index->extensionCount(), 0);
+        for (const std::string& extension : m_extensions) {
+            size_t id = index->findExtension(extension);
+            if (id != TreeIndex::npos && id != 0) {
+                allowedExtensions[id] = 1;
+            }
+        }
+    }
+    const bool filterNames = !m_prefix.empty() || !m_substring.empty();
+
+    // Unsigned offsets turn each range test into a single compare
+    const uint64_t minSize = m_minSize;
+    const uint64_t sizeSpan = m_maxSize - m_minSize;
+    const uint64_t from = static_cast<uint64_t>(m_from);
+    const uint64_t timeSpan = static_cast<uint64_t>(m_to) - from;
+    const uint8_t anyType = m_anyType ? 1 : 0;
+    const EntryType wantedType = m_type;
+
+    size_t chunks = (columns.count + kChunk - 1) / kChunk;
+    std::vector<std::vector<uint32_t>> partials(chunks);
+    ThreadPool& pool = m_pool ? *m_pool : ThreadPool::io();
+
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        const size_t begin = chunk * kChunk;
+        const size_t end = std::min(columns.count, begin + kChunk);
+        std::vector<uint8_t> mask(end - begin);
+        uint8_t* out = mask.data();
+        const EntryType* types = columns.types + begin;
+        const uint64_t* sizes = columns.sizes + begin;
+        const int64_t* mtimes = columns.mtimes + begin;
+        for (size_t i = 0; i < end - begin; ++i) {
+            uint8_t sizeOk = (sizes[i] - minSize) <= sizeSpan;
+            uint8_t timeOk = (static_cast<uint64_t>(mtimes[i]) - from) <= timeSpan;
+            uint8_t typeOk = anyType | static_cast<uint8_t>(types[i] == wantedType);
+            out[i] = sizeOk & timeOk & typeOk;
+        }
+
+        if (!allowedExtensions.empty()) {
+            // Ids come straight from the mapping: one outside the table never matches
+            const uint32_t* ids = index->extensionIds() + begin;
+            const size_t extensionCount = allowedExtensions.size();
+            for (size_t i = 0; i < end - begin; ++i) {
+                out[i] &= ids[i] < extensionCount ? allowedExtensions[ids[i]] : 0;
+            }
+        }
+
+        std::vector<uint32_t>& result = partials[chunk];
+        if (index != nullptr) {
+            if (!filterNames) {
+                for (size_t i = 0; i < end - begin; ++i) {
+                    if (out[i]) {
+                        result.push_back(static_cast<uint32_t>(begin + i));
+                    }
+                }
+                return;
+            }
+            // Paths are front-coded, so decode the chunk sequentially
+            TreeIndex::Cursor cursor(*index, begin);
+            std::string_view path;
+            for (size_t i = 0; i < end - begin && cursor.next(path); ++i) {
+                if (out[i] && matchesName(lastComponent(path))) {
+                    result.push_back(static_cast<uint32_t>(begin + i));
+                }
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < end - begin; ++i) {
+            if (!out[i]) {
+                continue;
+            }
+            std::string_view name = entries->name(begin + i);
+            if (!m_extensions.empty()) {
+                if (types[i] == EntryType::Directory) {
+                    continue;
+                }
+                std::string_view extension = extensionOf(name);
+                bool found = false;
+                for (const std::string& wanted : m_extensions) {
+                    found = found || equalsIgnoreCase(extension, wanted);
+                }
+                if (!found) {
+                    continue;
+                }
+            }
+            if (!filterNames || matchesName(name)) {
+                result.push_back(static_cast<uint32_t>(begin + i));
+            }
+        }
+    });
+
+    std::vector<uint32_t> result;
+    size_t total = 0;
+    for (const auto& partial : partials) {
+        total += partial.size();
+    }
+    result.reserve(total);
+    for (const auto& partial : partials) {
+        result.insert(result.end(), partial.begin(), partial.end());
+    }
+    return result;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,66 @@
+#ifndef CROSSDEV_TREE_QUERY_HPP
+#define CROSSDEV_TREE_QUERY_HPP
+
+#include "path_list.hpp"
+#include "tree_index.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * Filter over a scanned tree (PathList) or a TreeIndex.
+ *
+ * Size, mtime and type are tested first, over the metadata columns in
+ * branch-free loops the compiler vectorises; extension and name tests
+ * run only on the survivors. Nothing touches the filesystem. Entries are
+ * scanned in chunks on a thread pool and returned in index order.
+ *
+ * All conditions must hold. Ranges are inclusive, extensions compare
+ * case-insensitively and name tests apply to the last path component.
+ */
+class TreeQuery {
+public:
+    explicit TreeQuery(ThreadPool* pool = nullptr);
+
+    TreeQuery& type(EntryType type);
+    TreeQuery& sizeBetween(uint64_t minimum, uint64_t maximum = std::numeric_limits<uint64_t>::max());
+    /** Modification time range in nanoseconds since the epoch */
+    TreeQuery& modifiedBetween(int64_t from, int64_t to = std::numeric_limits<int64_t>::max());
+    /** Any of the given extensions, e.g. {".js", ".mjs"} */
+    TreeQuery& extensions(std::vector<std::string> extensions);
+    TreeQuery& namePrefix(std::string prefix);
+    TreeQuery& nameContains(std::string substring);
+
+    std::vector<uint32_t> run(const PathList& entries) const;
+    std::vector<uint32_t> run(const TreeIndex& index) const;
+
+private:
+    struct Columns;
+
+    std::vector<uint32_t> runColumns(const Columns& columns, const PathList* entries, const TreeIndex* index) const;
+    bool matchesName(std::string_view name) const;
+
+    ThreadPool* m_pool;
+    bool m_anyType = true;
+    EntryType m_type = EntryType::File;
+    uint64_t m_minSize = 0;
+    uint64_t m_maxSize = std::numeric_limits<uint64_t>::max();
+    int64_t m_from = std::numeric_limits<int64_t>::min();
+    int64_t m_to = std::numeric_limits<int64_t>::max();
+    std::vector<std::string> m_extensions;
+    std::string m_prefix;
+    std::string m_substring;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_TREE_QUERY_HPP
@@ -0,0 +1,215 @@
+#include "tree_stats.hpp"
+#include "index_format.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Entries per task when aggregating an existing PathList
+constexpr size_t kChunkSize = 32 * 1024;
+// Counting tracks this many times maxExtensions, so the cap can be applied once, after merging
+constexpr size_t kTrackedExtensionFactor = 16;
+
+// Heap order that keeps the smallest kept file at the front
+bool largerFirst(const LargeFile& a, const LargeFile& b) {
+    return a.size > b.size;
+}
+
+} // namespace
+
+size_t SizeHistogram::bucketOf(uint64_t size) {
+    if (size == 0) {
+        return 0;
+    }
+#if defined(_MSC_VER) && !defined(__clang__)
+    unsigned long index;
+    _BitScanReverse64(&index, size);
+    return static_cast<size_t>(index) + 1;
+#else
+    return static_cast<size_t>(64 - __builtin_clzll(size));
+#endif
+}
+
+void SizeHistogram::merge(const SizeHistogram& other) {
+    for (size_t bucket = 0; bucket < kBuckets; ++bucket) {
+        m_counts[bucket] += other.m_counts[bucket];
+        m_bytes[bucket] += other.m_bytes[bucket];
+    }
+}
+
+void TopFiles::add(uint64_t size, std::string path) {
+    if (!accepts(size)) {
+        return;
+    }
+    if (m_heap.size() == m_capacity) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), largerFirst);
+        m_heap.pop_back();
+    }
+    m_heap.push_back({std::move(path), size});
+    std::push_heap(m_heap.begin(), m_heap.end(), largerFirst);
+}
+
+void TopFiles::merge(const TopFiles& other) {
+    for (const LargeFile& file : other.m_heap) {
+        add(file.size, file.path);
+    }
+}
+
+std::vector<LargeFile> TopFiles::sorted() const {
+    std::vector<LargeFile> result = m_heap;
+    std::sort(result.begin(), result.end(), [](const LargeFile& a, const LargeFile& b) {
+        return a.size != b.size ? a.size > b.size : a.path < b.path;
+    });
+    return result;
+}
+
+TreeStats::TreeStats(TreeStatsOptions options)
+    : m_options(options),
+      m_trackedExtensions(options.maxExtensions > SIZE_MAX / kTrackedExtensionFactor
+                              ? SIZE_MAX
+                              : options.maxExtensions * kTrackedExtensionFactor),
+      m_top(options.topCount) {}
+
+ExtensionStats& TreeStats::extensionEntry(std::string_view extension) {
+    m_scratch.assign(extension);
+    detail::lowerAsciiInPlace(m_scratch);
+    auto found = m_extensions.find(m_scratch);
+    if (found != m_extensions.end()) {
+        return found->second;
+    }
+    if (m_extensions.size() >= m_trackedExtensions) {
+        return m_other;
+    }
+    ExtensionStats& entry = m_extensions[m_scratch];
+    entry.extension = m_scratch;
+    return entry;
+}
+
+bool TreeStats::count(std::string_view name, uint64_t size) {
+    ++m_files;
+    m_bytes += size;
+    m_histogram.add(size);
+
+    ExtensionStats& extension = extensionEntry(extensionOf(name));
+    ++extension.files;
+    extension.bytes += size;
+    extension.histogram.add(size);
+    return m_top.accepts(size);
+}
+
+void TreeStats::add(std::string_view directory, std::string_view name, uint64_t size) {
+    if (count(name, size)) {
+        std::string path;
+        path.reserve(directory.size() + 1 + name.size());
+        path.append(directory);
+        if (!path.empty() && path.back() != Path::separator()) {
+            path.push_back(Path::separator());
+        }
+        path.append(name);
+        m_top.add(size, std::move(path));
+    }
+}
+
+void TreeStats::merge(const TreeStats& other) {
+    m_files += other.m_files;
+    m_bytes += other.m_bytes;
+    m_histogram.merge(other.m_histogram);
+    m_top.merge(other.m_top);
+    for (const auto& entry : other.m_extensions) {
+        ExtensionStats& mine = extensionEntry(entry.first);
+        mine.files += entry.second.files;
+        mine.bytes += entry.second.bytes;
+        mine.histogram.merge(entry.second.histogram);
+    }
+    m_other.files += other.m_other.files;
+    m_other.bytes += other.m_other.bytes;
+    m_other.histogram.merge(other.m_other.histogram);
+}
+
+std::vector<ExtensionStats> TreeStats::rankedExtensions() const {
+    std::vector<ExtensionStats> result;
+    result.reserve(m_extensions.size());
+    for (const auto& entry : m_extensions) {
+        result.push_back(entry.second);
+    }
+    std::sort(result.begin(), result.end(), [](const ExtensionStats& a, const ExtensionStats& b) {
+        return a.bytes != b.bytes ? a.bytes > b.bytes : a.extension < b.extension;
+    });
+    return result;
+}
+
+std::vector<ExtensionStats> TreeStats::extensions() const {
+    std::vector<ExtensionStats> result = rankedExtensions();
+    if (result.size() > m_options.maxExtensions) {
+        result.resize(m_options.maxExtensions);
+    }
+    return result;
+}
+
+ExtensionStats TreeStats::otherExtensions() const {
+    ExtensionStats other = m_other;
+    std::vector<ExtensionStats> ranked = rankedExtensions();
+    for (size_t i = m_options.maxExtensions; i < ranked.size(); ++i) {
+        other.files += ranked[i].files;
+        other.bytes += ranked[i].bytes;
+        other.histogram.merge(ranked[i].histogram);
+    }
+    return other;
+}
+
+TreeStats TreeStats::collect(const Path& root, TreeStatsOptions options) {
+    WalkOptions walkOptions = options.walk;
+    walkOptions.collectMetadata = true;
+    Walker walker(walkOptions);
+
+    std::vector<TreeStats> partials(walker.workerCount(), TreeStats(options));
+    walker.walk(root, [&](size_t worker, const WalkEntry& entry) {
+        if (entry.type == EntryType::File) {
+            partials[worker].add(entry.directory, entry.name, entry.size);
+        }
+    });
+
+    TreeStats result(options);
+    for (const TreeStats& partial : partials) {
+        result.merge(partial);
+    }
+    return result;
+}
+
+TreeStats TreeStats::collect(const PathList& entries, TreeStatsOptions options) {
+    ThreadPool& pool = options.walk.pool ? *options.walk.pool : ThreadPool::io();
+    size_t chunks = (entries.size() + kChunkSize - 1) / kChunkSize;
+
+    std::vector<TreeStats> partials(chunks, TreeStats(options));
+    pool.parallelFor(chunks, [&](size_t chunk) {
+        TreeStats& partial = partials[chunk];
+        const std::vector<EntryType>& types = entries.types();
+        std::string path;
+        size_t end = std::min(entries.size(), (chunk + 1) * kChunkSize);
+        for (size_t i = chunk * kChunkSize; i < end; ++i) {
+            // Full paths are built only for files that enter the top list
+            if (types[i] == EntryType::File && partial.count(entries.name(i), entries.fileSize(i))) {
+                entries.pathInto(i, path);
+                partial.m_top.add(entries.fileSize(i), path);
+            }
+        }
+    });
+
+    TreeStats result(options);
+    for (const TreeStats& partial : partials) {
+        result.merge(partial);
+    }
+    return result;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,155 @@
+#ifndef CROSSDEV_TREE_STATS_HPP
+#define CROSSDEV_TREE_STATS_HPP
+
+#include "path_list.hpp"
+#include "walker.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+
+/**
+ * File count and bytes per power-of-two size bucket.
+ *
+ * Bucket 0 holds empty files and bucket b > 0 holds sizes in
+ * [2^(b-1), 2^b), so 65 buckets cover every 64-bit size.
+ */
+class SizeHistogram {
+public:
+    static constexpr size_t kBuckets = 65;
+
+    static size_t bucketOf(uint64_t size);
+    /** Smallest size that falls into bucket */
+    static uint64_t bucketFloor(size_t bucket) { return bucket == 0 ? 0 : uint64_t(1) << (bucket - 1); }
+
+    void add(uint64_t size) {
+        size_t bucket = bucketOf(size);
+        ++m_counts[bucket];
+        m_bytes[bucket] += size;
+    }
+    void merge(const SizeHistogram& other);
+
+    uint64_t count(size_t bucket) const { return m_counts[bucket]; }
+    uint64_t bytes(size_t bucket) const { return m_bytes[bucket]; }
+
+private:
+    std::array<uint64_t, kBuckets> m_counts{};
+    std::array<uint64_t, kBuckets> m_bytes{};
+};
+
+struct LargeFile {
+    std::string path;
+    uint64_t size = 0;
+};
+
+/**
+ * The largest files seen so far, kept in a bounded min-heap.
+ *
+ * A file only costs a comparison against the smallest kept size unless
+ * it makes the cut, so callers can test accepts() before building its
+ * path. Ties at the boundary keep the file seen first.
+ */
+class TopFiles {
+public:
+    explicit TopFiles(size_t capacity) : m_capacity(capacity) {}
+
+    bool accepts(uint64_t size) const {
+        return m_heap.size() < m_capacity || (m_capacity > 0 && size > m_heap.front().size);
+    }
+    void add(uint64_t size, std::string path);
+    void merge(const TopFiles& other);
+
+    size_t capacity() const { return m_capacity; }
+    /** Kept files, largest first; equal sizes ordered by path */
+    std::vector<LargeFile> sorted() const;
+
+private:
+    size_t m_capacity;
+    std::vector<LargeFile> m_heap;
+};
+
+struct ExtensionStats {
+    /** Lower-cased extension including the dot; empty for none */
+    std::string extension;
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+    SizeHistogram histogram;
+};
+
+/**
+ * Tuning for TreeStats
+ */
+struct TreeStatsOptions {
+    /** Number of largest files to keep */
+    size_t topCount = 100;
+    /**
+     * Distinct extensions reported. The ones with the most bytes (ties by
+     * name) get their own entry, the rest are summed in otherExtensions().
+     * Counting keeps up to 16 times as many, which bounds memory on any
+     * tree; past that, the choice can depend on scheduling.
+     */
+    size_t maxExtensions = 1024;
+    /** Walk used by collect(root); its pool also runs collect(PathList) */
+    WalkOptions walk;
+};
+
+/**
+ * Single-pass capacity statistics over the regular files of a tree: the
+ * largest files, an overall size histogram and per-extension counters
+ * with their own histograms.
+ *
+ * collect(root) streams the walk through Walker::walk() without building
+ * a PathList. Every walker thread feeds its own partial TreeStats, and the
+ * partials are merged once at the end, so the pass takes no locks and
+ * its memory is bounded by the options, not by the size of the tree.
+ */
+class TreeStats {
+public:
+    explicit TreeStats(TreeStatsOptions options = TreeStatsOptions());
+
+    static TreeStats collect(const Path& root, TreeStatsOptions options = TreeStatsOptions());
+    static TreeStats collect(const PathList& entries, TreeStatsOptions options = TreeStatsOptions());
+
+    /** Account one regular file found in directory */
+    void add(std::string_view directory, std::string_view name, uint64_t size);
+    void merge(const TreeStats& other);
+
+    uint64_t files() const { return m_files; }
+    uint64_t bytes() const { return m_bytes; }
+    const SizeHistogram& histogram() const { return m_histogram; }
+    std::vector<LargeFile> largest() const { return m_top.sorted(); }
+    /** Per-extension counters, most bytes first, at most maxExtensions of them */
+    std::vector<ExtensionStats> extensions() const;
+    /** Files whose extension did not make extensions() */
+    ExtensionStats otherExtensions() const;
+
+private:
+    // Update the counters; true if the file also belongs in the top list
+    bool count(std::string_view name, uint64_t size);
+    ExtensionStats& extensionEntry(std::string_view extension);
+    // Every tracked extension, in reporting order
+    std::vector<ExtensionStats> rankedExtensions() const;
+
+    TreeStatsOptions m_options;
+    // Extensions counted individually before falling back to m_other
+    size_t m_trackedExtensions;
+    uint64_t m_files = 0;
+    uint64_t m_bytes = 0;
+    SizeHistogram m_histogram;
+    TopFiles m_top;
+    std::unordered_map<std::string, ExtensionStats> m_extensions;
+    ExtensionStats m_other;
+    std::string m_scratch;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_TREE_STATS_HPP
@@ -0,0 +1,205 @@
+#ifndef CROSSDEV_UNIX_IO_HPP
+#define CROSSDEV_UNIX_IO_HPP
+
+// Internal POSIX helpers shared by the *_unix.cpp translation units.
+
+#include "filesystem.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+namespace crossdev {
+namespace fs {
+namespace detail {
+
+// Closes a file descriptor when it goes out of scope
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd = -1) : m_fd(fd) {}
+    ~FileDescriptor() {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+    }
+    FileDescriptor(FileDescriptor&& other) noexcept : m_fd(other.release()) {}
+    FileDescriptor& operator=(FileDescriptor&& other) noexcept {
+        if (this != &other) {
+            reset(other.release());
+        }
+        return *this;
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    int get() const { return m_fd; }
+    bool valid() const { return m_fd >= 0; }
+
+    int release() {
+        int fd = m_fd;
+        m_fd = -1;
+        return fd;
+    }
+
+    void reset(int fd = -1) {
+        if (m_fd >= 0) {
+            ::close(m_fd);
+        }
+        m_fd = fd;
+    }
+
+private:
+    int m_fd;
+};
+
+/**
+ * Pass an access hint for [offset, offset + length) of an open file to the
+ * kernel. A length of 0 means "to the end of the file". Hints are advisory;
+ * platforms without the call ignore them.
+ */
+inline void adviseDescriptor(int fd, AccessHint hint, off_t offset, off_t length) {
+#if defined(POSIX_FADV_NORMAL)
+    int advice = POSIX_FADV_NORMAL;
+    switch (hint) {
+        case AccessHint::Normal: advice = POSIX_FADV_NORMAL; break;
+        case AccessHint::Sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+        case AccessHint::Random: advice = POSIX_FADV_RANDOM; break;
+        case AccessHint::WillNeed: advice = POSIX_FADV_WILLNEED; break;
+        case AccessHint::DontNeed: advice = POSIX_FADV_DONTNEED; break;
+    }
+    posix_fadvise(fd, offset, length, advice);
+#elif defined(F_RDADVISE)
+    if (hint == AccessHint::WillNeed) {
+        struct radvisory ra;
+        ra.ra_offset = offset;
+        ra.ra_count = static_cast<int>(length > 0 ? length : 0x7fffffff);
+        fcntl(fd, F_RDADVISE, &ra);
+    } else if (hint == AccessHint::Sequential || hint == AccessHint::Normal) {
+        fcntl(fd, F_RDAHEAD, 1);
+    } else if (hint == AccessHint::Random) {
+        fcntl(fd, F_RDAHEAD, 0);
+    }
+#else
+    (void)fd;
+    (void)hint;
+    (void)offset;
+    (void)length;
+#endif
+}
+
+/**
+ * Same hints for a memory mapping
+ */
+inline void adviseMemory(const void* address, size_t length, AccessHint hint) {
+    int advice = MADV_NORMAL;
+    switch (hint) {
+        case AccessHint::Normal: advice = MADV_NORMAL; break;
+        case AccessHint::Sequential: advice = MADV_SEQUENTIAL; break;
+        case AccessHint::Random: advice = MADV_RANDOM; break;
+        case AccessHint::WillNeed: advice = MADV_WILLNEED; break;
+        case AccessHint::DontNeed: advice = MADV_DONTNEED; break;
+    }
+    madvise(const_cast<void*>(address), length, advice);
+}
+
+/**
+ * Allocate disk blocks for [offset, offset + length) up front so a large
+ * write lands in few extents and runs out of space before, not during,
+ * the transfer. With keepSize the file length is left unchanged.
+ *
+ * Returns 0 on success or when the filesystem cannot preallocate (the
+ * write then simply allocates as it goes), otherwise the errno value.
+ */
+inline int preallocate(int fd, off_t offset, off_t length, bool keepSize) {
+    if (length <= 0) {
+        return 0;
+    }
+    int result = 0;
+#if defined(__linux__)
+    result = fallocate(fd, keepSize ? FALLOC_FL_KEEP_SIZE : 0, offset, length) == 0 ? 0 : errno;
+#elif defined(F_PREALLOCATE)
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        return errno;
+    }
+    off_t end = offset + length;
+    if (end > st.st_size) {
+        fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, end - st.st_size, 0};
+        if (fcntl(fd, F_PREALLOCATE, &store) != 0) {
+            store.fst_flags = F_ALLOCATEALL;
+            result = fcntl(fd, F_PREALLOCATE, &store) == 0 ? 0 : errno;
+        }
+        if (result == 0 && !keepSize && ftruncate(fd, end) != 0) {
+            result = errno;
+        }
+    }
+#else
+    if (!keepSize) {
+        result = posix_fallocate(fd, offset, length);
+    }
+#endif
+    if (result == EOPNOTSUPP || result == ENOSYS || result == EINVAL) {
+        return 0;
+    }
+    return result;
+}
+
+/**
+ * Evicts the pages of a file being written once they reach the disk.
+ *
+ * Each new range is submitted for writeback immediately; the previous range
+ * is waited on and dropped from the cache. Keeping one range in flight lets
+ * the device work while the caller produces the next chunk.
+ */
+class DropBehind {
+public:
+    explicit DropBehind(int fd) : m_fd(fd) {}
+    ~DropBehind() { finish(); }
+    DropBehind(const DropBehind&) = delete;
+    DropBehind& operator=(const DropBehind&) = delete;
+
+    void written(off_t offset, off_t length) {
+#if defined(SYNC_FILE_RANGE_WRITE)
+        sync_file_range(m_fd, offset, length, SYNC_FILE_RANGE_WRITE);
+#endif
+        retire();
+        m_offset = offset;
+        m_length = length;
+    }
+
+    void finish() {
+        retire();
+        m_length = 0;
+    }
+
+private:
+    void retire() {
+        if (m_length == 0) {
+            return;
+        }
+#if defined(SYNC_FILE_RANGE_WRITE)
+        sync_file_range(m_fd, m_offset, m_length,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+#else
+        fsync(m_fd);
+#endif
+        adviseDescriptor(m_fd, AccessHint::DontNeed, m_offset, m_length);
+    }
+
+    int m_fd;
+    off_t m_offset = 0;
+    off_t m_length = 0;
+};
+
+} // namespace detail
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
+
+#endif // CROSSDEV_UNIX_IO_HPP
@@ -0,0 +1,207 @@
+#include "walker.hpp"
+#include "walker_detail.hpp"
+#include "thread_pool.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace crossdev {
+namespace fs {
+
+namespace {
+
+// Directories on the path from the root, shared between siblings
+struct Ancestor {
+    FileId id;
+    std::shared_ptr<const Ancestor> parent;
+};
+
+struct PendingDirectory {
+    uint32_t index;
+    std::string path;
+    std::shared_ptr<const Ancestor> chain;
+};
+
+bool onChain(const Ancestor* ancestor, const FileId& id) {
+    for (; ancestor != nullptr; ancestor = ancestor->parent.get()) {
+        if (ancestor->id == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Directories waiting to be read, shared by every worker of one walk
+struct WalkState {
+    FileIdSet visited;
+    std::deque<PendingDirectory> pending;
+    size_t active = 0;
+    /** Set once any worker failed; the others stop taking directories */
+    bool stopped = false;
+    std::mutex mutex;
+    std::condition_variable changed;
+};
+
+/**
+ * Hands a claimed directory back and stops the walk if reading,
+ * visiting or queueing it throws, so the remaining workers drain out
+ * instead of waiting forever for active to drop to zero
+ */
+class ActiveClaim {
+public:
+    ActiveClaim(WalkState& state, std::unique_lock<std::mutex>& lock) : m_state(state), m_lock(lock) {}
+
+    ~ActiveClaim() {
+        if (m_held) {
+            if (!m_lock.owns_lock()) {
+                m_lock.lock();
+            }
+            --m_state.active;
+            m_state.stopped = true;
+            m_state.changed.notify_all();
+        }
+    }
+
+    ActiveClaim(const ActiveClaim&) = delete;
+    ActiveClaim& operator=(const ActiveClaim&) = delete;
+
+    void release() { m_held = false; }
+
+private:
+    WalkState& m_state;
+    std::unique_lock<std::mutex>& m_lock;
+    bool m_held = true;
+};
+
+ThreadPool& poolOf(const WalkOptions& options) {
+    return options.pool ? *options.pool : ThreadPool::io();
+}
+
+/**
+ * Drain the tree below root on the pool. Each directory read is handed to
+ * visit(worker, directory, entries, indices) outside the queue lock; visit
+ * may fill indices with the parent index to give each entry's children.
+ */
+template <typename Visit>
+void walkTree(const Path& root, const WalkOptions& options, Visit visit) {
+    if (!root.isDirectory()) {
+        throw FileSystemException("Directory does not exist: " + root.toString());
+    }
+
+    ThreadPool& pool = poolOf(options);
+    WalkState state;
+    FileId rootId;
+    detail::identify(root.getNative(), rootId);
+    if (options.symlinks == SymlinkPolicy::FollowOnce) {
+        state.visited.insert(rootId);
+    }
+    state.pending.push_back({PathList::kRoot, root.getNative(),
+                             std::make_shared<const Ancestor>(Ancestor{rootId, nullptr})});
+
+    const char separator = Path::separator();
+    detail::ReadOptions readOptions;
+    readOptions.collectMetadata = options.collectMetadata;
+    readOptions.followSymlinks = options.symlinks != SymlinkPolicy::Never;
+    const bool once = options.symlinks == SymlinkPolicy::FollowOnce;
+
+    // Each iteration is a worker draining the queue; the caller participates
+    pool.parallelFor(pool.size() + 1, [&](size_t worker) {
+        std::vector<detail::RawEntry> entries;
+        std::vector<uint32_t> indices;
+        std::unique_lock<std::mutex> lock(state.mutex);
+        for (;;) {
+            state.changed.wait(lock, [&]() { return state.stopped || !state.pending.empty() || state.active == 0; });
+            if (state.stopped || state.pending.empty()) {
+                return;
+            }
+            PendingDirectory directory = std::move(state.pending.front());
+            state.pending.pop_front();
+            ++state.active;
+            ActiveClaim claim(state, lock);
+            lock.unlock();
+
+            entries.clear();
+            indices.clear();
+            detail::readDirectory(directory.path, readOptions, entries);
+            visit(worker, directory, entries, indices);
+
+            lock.lock();
+            bool queued = false;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const detail::RawEntry& entry = entries[i];
+                if (!options.recursive || entry.type != EntryType::Directory) {
+                    continue;
+                }
+                if (options.oneFileSystem && entry.id.device != rootId.device) {
+                    continue;
+                }
+                // Ancestors catch loops; the global set also drops repeated subtrees.
+                // An unknown identity (0, 0) cannot be checked and is let through.
+                if (entry.id != FileId() &&
+                    (onChain(directory.chain.get(), entry.id) || (once && !state.visited.insert(entry.id)))) {
+                    continue;
+                }
+                std::string child;
+                child.reserve(directory.path.size() + 1 + entry.name.size());
+                child.append(directory.path);
+                if (child.back() != separator) {
+                    child.push_back(separator);
+                }
+                child.append(entry.name);
+                uint32_t index = i < indices.size() ? indices[i] : PathList::kRoot;
+                state.pending.push_back({index, std::move(child),
+                                         std::make_shared<const Ancestor>(Ancestor{entry.id, directory.chain})});
+                queued = true;
+            }
+            claim.release();
+            --state.active;
+            if (queued || state.active == 0) {
+                state.changed.notify_all();
+            }
+        }
+    });
+}
+
+} // namespace
+
+Walker::Walker(WalkOptions options) : m_options(options) {}
+
+PathList Walker::scan(const Path& root) const {
+    PathList list(root);
+    std::mutex listMutex;
+    walkTree(root, m_options,
+             [&](size_t, const PendingDirectory& directory, const std::vector<detail::RawEntry>& entries,
+                 std::vector<uint32_t>& indices) {
+                 std::lock_guard<std::mutex> lock(listMutex);
+                 for (const detail::RawEntry& entry : entries) {
+                     indices.push_back(list.add(directory.index, entry.name, entry.type, entry.size, entry.mtimeNs));
+                 }
+             });
+    return list;
+}
+
+void Walker::walk(const Path& root, const WalkCallback& callback) const {
+    walkTree(root, m_options,
+             [&](size_t worker, const PendingDirectory& directory, const std::vector<detail::RawEntry>& entries,
+                 std::vector<uint32_t>&) {
+                 WalkEntry streamed;
+                 streamed.directory = directory.path;
+                 for (const detail::RawEntry& entry : entries) {
+                     streamed.name = entry.name;
+                     streamed.type = entry.type;
+                     streamed.size = entry.size;
+                     streamed.mtimeNs = entry.mtimeNs;
+                     callback(worker, streamed);
+                 }
+             });
+}
+
+size_t Walker::workerCount() const {
+    return poolOf(m_options).size() + 1;
+}
+
+} // namespace fs
+} // namespace crossdev
@@ -0,0 +1,99 @@
+#ifndef CROSSDEV_WALKER_HPP
+#define CROSSDEV_WALKER_HPP
+
+#include "filesystem.hpp"
+#include "path_list.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace crossdev {
+
+class ThreadPool;
+
+namespace fs {
+
+/**
+ * How a walk treats symbolic links.
+ *
+ * Never reports links as EntryType::Symlink without following them.
+ * Follow reports a link with the type and metadata of its target and
+ * descends into linked directories, skipping only those that would
+ * re-enter one of their own ancestors. FollowOnce additionally scans
+ * every physical directory at most once, however many links or bind
+ * mounts lead to it.
+ */
+enum class SymlinkPolicy {
+    Never,
+    Follow,
+    FollowOnce
+};
+
+/**
+ * Tuning for Walker
+ */
+struct WalkOptions {
+    bool recursive = true;
+    SymlinkPolicy symlinks = SymlinkPolicy::Never;
+    /** Do not descend into directories on another device (mount points) */
+    bool oneFileSystem = false;
+    /** Fill in size and mtime for every entry (one stat per entry) */
+    bool collectMetadata = true;
+    /** Pool that reads directories concurrently; defaults to ThreadPool::io() */
+    ThreadPool* pool = nullptr;
+};
+
+/**
+ * One entry as streamed by Walker::walk(); the views are valid only for
+ * the duration of the callback
+ */
+struct WalkEntry {
+    /** Native path of the directory holding the entry */
+    std::string_view directory;
+    std::string_view name;
+    EntryType type = EntryType::Unknown;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+};
+
+/**
+ * Receives streamed entries. worker is in [0, pool size + 1) and no two
+ * concurrent calls share it, so it can index per-thread state directly.
+ */
+using WalkCallback = std::function<void(size_t worker, const WalkEntry& entry)>;
+
+/**
+ * Parallel directory tree scanner producing a PathList.
+ *
+ * Directories are read concurrently, each entry is stat-ed relative to
+ * its open directory, and results are appended to the arena-backed
+ * list. Every directory is identified by (device, inode), so loops made
+ * of symlinks or bind mounts are never entered twice along one path.
+ * Entry order is not deterministic across runs.
+ */
+class Walker {
+public:
+    explicit Walker(WalkOptions options = WalkOptions());
+
+    PathList scan(const Path& root) const;
+
+    /**
+     * Stream every entry to callback instead of collecting them, so the
+     * walk needs memory only for the directories still queued. Callbacks
+     * run concurrently on the reading threads, without any lock held.
+     */
+    void walk(const Path& root, const WalkCallback& callback) const;
+
+    /** Number of distinct worker indices walk() may pass to its callback */
+    size_t workerCount() const;
+
+private:
+    WalkOptions m_options;
+};
+
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_WALKER_HPP
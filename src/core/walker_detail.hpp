@@ -0,0 +1,57 @@
+#ifndef CROSSDEV_WALKER_DETAIL_HPP
+#define CROSSDEV_WALKER_DETAIL_HPP
+
+// Internal interface between the portable walker and the per-platform
+// directory readers in walker_unix.cpp / walker_win.cpp.
+
+#include "file_id.hpp"
+#include "path_list.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace crossdev {
+namespace fs {
+namespace detail {
+
+struct RawEntry {
+    std::string name;
+    EntryType type = EntryType::Unknown;
+    uint64_t size = 0;
+    int64_t mtimeNs = 0;
+    /** Filled in for directories (including followed links to them) */
+    FileId id;
+};
+
+struct ReadOptions {
+    bool collectMetadata = true;
+    /** Report symlinks with the type and metadata of their target */
+    bool followSymlinks = false;
+};
+
+/**
+ * Append the entries of one directory (without "." and "..") to out.
+ * Returns false if the directory cannot be opened. Links whose target
+ * cannot be resolved stay EntryType::Symlink.
+ */
+bool readDirectory(const std::string& path, const ReadOptions& options, std::vector<RawEntry>& out);
+
+/** Identity of the directory at path (symlinks followed) */
+bool identify(const std::string& path, FileId& id);
+
+/** Identity plus modification and status-change times of a directory */
+bool stampDirectory(const std::string& path, FileId& id, int64_t& mtimeNs, int64_t& ctimeNs);
+
+/**
+ * Refresh type, size and mtime of entries already known to live in the
+ * directory at path, without listing it. Entries that vanished keep
+ * their old values; returns the number refreshed.
+ */
+size_t restatEntries(const std::string& path, std::vector<RawEntry>& entries);
+
+} // namespace detail
+} // namespace fs
+} // namespace crossdev
+
+#endif // CROSSDEV_WALKER_DETAIL_HPP
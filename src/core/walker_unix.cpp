@@ -0,0 +1,145 @@
+#include "walker_detail.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <sys/stat.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace crossdev {
+namespace fs {
+namespace detail {
+
+namespace {
+
+EntryType fromMode(mode_t mode) {
+    if (S_ISREG(mode)) {
+        return EntryType::File;
+    }
+    if (S_ISDIR(mode)) {
+        return EntryType::Directory;
+    }
+    if (S_ISLNK(mode)) {
+        return EntryType::Symlink;
+    }
+    return EntryType::Other;
+}
+
+EntryType fromDirentType(unsigned char type) {
+    switch (type) {
+        case DT_REG: return EntryType::File;
+        case DT_DIR: return EntryType::Directory;
+        case DT_LNK: return EntryType::Symlink;
+        case DT_UNKNOWN: return EntryType::Unknown;
+        default: return EntryType::Other;
+    }
+}
+
+int64_t modifiedNs(const struct stat& st) {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+int64_t changedNs(const struct stat& st) {
+#if defined(__APPLE__)
+    return static_cast<int64_t>(st.st_ctimespec.tv_sec) * 1000000000 + st.st_ctimespec.tv_nsec;
+#else
+    return static_cast<int64_t>(st.st_ctim.tv_sec) * 1000000000 + st.st_ctim.tv_nsec;
+#endif
+}
+
+void fill(RawEntry& raw, const struct stat& st) {
+    raw.type = fromMode(st.st_mode);
+    raw.size = static_cast<uint64_t>(st.st_size);
+    raw.mtimeNs = modifiedNs(st);
+    raw.id = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+}
+
+} // namespace
+
+bool readDirectory(const std::string& path, const ReadOptions& options, std::vector<RawEntry>& out) {
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) {
+        return false;
+    }
+    int fd = dirfd(dir);
+
+    while (struct dirent* entry = readdir(dir)) {
+        const char* name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        RawEntry raw;
+        raw.name = name;
+        raw.type = fromDirentType(entry->d_type);
+
+        // Directories are always stat-ed: their identity guards against loops.
+        // The stat is relative to the open directory, one component to resolve.
+        if (options.collectMetadata || raw.type == EntryType::Unknown || raw.type == EntryType::Directory ||
+            (options.followSymlinks && raw.type == EntryType::Symlink)) {
+            struct stat st;
+            if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+                fill(raw, st);
+                if (options.followSymlinks && S_ISLNK(st.st_mode) && fstatat(fd, name, &st, 0) == 0) {
+                    fill(raw, st);
+                }
+            }
+        }
+        out.push_back(std::move(raw));
+    }
+
+    closedir(dir);
+    return true;
+}
+
+bool identify(const std::string& path, FileId& id) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) {
+        return false;
+    }
+    id = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    return true;
+}
+
+bool stampDirectory(const std::string& path, FileId& id, int64_t& mtimeNs, int64_t& ctimeNs) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    id = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino)};
+    mtimeNs = modifiedNs(st);
+    ctimeNs = changedNs(st);
+    return true;
+}
+
+size_t restatEntries(const std::string& path, std::vector<RawEntry>& entries) {
+    int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    size_t refreshed = 0;
+    for (RawEntry& raw : entries) {
+        struct stat st;
+        if (fstatat(fd, raw.name.c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0) {
+            FileId id = raw.id;
+            fill(raw, st);
+            if (raw.type != EntryType::Directory) {
+                raw.id = id;
+            }
+            ++refreshed;
+        }
+    }
+    close(fd);
+    return refreshed;
+}
+
+} // namespace detail
+} // namespace fs
+} // namespace crossdev
+
+#endif // __unix__ || __APPLE__
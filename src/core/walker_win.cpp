@@ -0,0 +1,125 @@
+#include "walker_detail.hpp"
+
+#ifdef _WIN32
+
+#include <Windows.h>
+
+namespace crossdev {
+namespace fs {
+namespace detail {
+
+namespace {
+
+// FILETIME counts 100 ns intervals since 1601-01-01
+int64_t toUnixNanoseconds(const FILETIME& time) {
+    ULARGE_INTEGER value;
+    value.LowPart = time.dwLowDateTime;
+    value.HighPart = time.dwHighDateTime;
+    return (static_cast<int64_t>(value.QuadPart) - 116444736000000000LL) * 100;
+}
+
+} // namespace
+
+bool readDirectory(const std::string& path, const ReadOptions& options, std::vector<RawEntry>& out) {
+    std::string pattern = path + "\\*";
+    WIN32_FIND_DATAA findData;
+    // The find data already carries type, size and time: no extra stat needed
+    HANDLE find = FindFirstFileExA(pattern.c_str(), FindExInfoBasic, &findData, FindExSearchNameMatch, NULL,
+                                   FIND_FIRST_EX_LARGE_FETCH);
+    if (find == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    do {
+        const char* name = findData.cFileName;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0'))) {
+            continue;
+        }
+
+        RawEntry raw;
+        raw.name = name;
+        bool isDirectory = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            raw.type = EntryType::Symlink;
+            // Junctions and directory links resolve when opened by name
+            if (options.followSymlinks && isDirectory && identify(path + "\\" + raw.name, raw.id)) {
+                raw.type = EntryType::Directory;
+            }
+        } else if (isDirectory) {
+            raw.type = EntryType::Directory;
+            identify(path + "\\" + raw.name, raw.id);
+        } else {
+            raw.type = EntryType::File;
+        }
+        raw.size = (static_cast<uint64_t>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+        raw.mtimeNs = toUnixNanoseconds(findData.ftLastWriteTime);
+        out.push_back(std::move(raw));
+    } while (FindNextFileA(find, &findData));
+
+    FindClose(find);
+    return true;
+}
+
+bool identify(const std::string& path, FileId& id) {
+    HANDLE handle = CreateFileA(path.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+                                OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    bool ok = GetFileInformationByHandle(handle, &info) != 0;
+    CloseHandle(handle);
+    if (ok) {
+        id.device = info.dwVolumeSerialNumber;
+        id.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+    }
+    return ok;
+}
+
+bool stampDirectory(const std::string& path, FileId& id, int64_t& mtimeNs, int64_t& ctimeNs) {
+    HANDLE handle = CreateFileA(path.c_str(), FILE_READ_ATTRIBUTES, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, NULL);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    BY_HANDLE_FILE_INFORMATION info;
+    FILE_BASIC_INFO basic;
+    bool ok = GetFileInformationByHandle(handle, &info) != 0 &&
+              GetFileInformationByHandleEx(handle, FileBasicInfo, &basic, sizeof(basic)) != 0 &&
+              (info.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+    CloseHandle(handle);
+    if (ok) {
+        id.device = info.dwVolumeSerialNumber;
+        id.inode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+        mtimeNs = (basic.LastWriteTime.QuadPart - 116444736000000000LL) * 100;
+        ctimeNs = (basic.ChangeTime.QuadPart - 116444736000000000LL) * 100;
+    }
+    return ok;
+}
+
+size_t restatEntries(const std::string& path, std::vector<RawEntry>& entries) {
+    size_t refreshed = 0;
+    for (RawEntry& raw : entries) {
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA((path + "\\" + raw.name).c_str(), GetFileExInfoStandard, &data)) {
+            continue;
+        }
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT) {
+            raw.type = EntryType::Symlink;
+        } else if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            raw.type = EntryType::Directory;
+        } else {
+            raw.type = EntryType::File;
+        }
+        raw.size = (static_cast<uint64_t>(data.nFileSizeHigh) << 32) | data.nFileSizeLow;
+        raw.mtimeNs = toUnixNanoseconds(data.ftLastWriteTime);
+        ++refreshed;
+    }
+    return refreshed;
+}
+
+} // namespace detail
+} // namespace fs
+} // namespace crossdev
+
+#endif // _WIN32
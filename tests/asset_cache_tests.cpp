@@ -0,0 +1,170 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/asset_cache.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include "core/hash.hpp"
+#include <unistd.h>
+#include <atomic>
+#include <clocale>
+#include <thread>
+#include <vector>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("HTTP dates and MIME types", "[assets]") {
+    REQUIRE(httpDate(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+    int64_t seconds = 0;
+    REQUIRE(parseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", seconds));
+    REQUIRE(seconds == 784111777);
+    REQUIRE_FALSE(parseHttpDate("yesterday", seconds));
+    REQUIRE_FALSE(parseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", seconds));
+    REQUIRE_FALSE(parseHttpDate("Sun, 06 Nov 1994 08:49:37 UTC", seconds));
+
+    // Day and month names stay English whatever LC_TIME says
+    const char* previous = std::setlocale(LC_TIME, nullptr);
+    std::string saved = previous ? previous : "C";
+    if (std::setlocale(LC_TIME, "de_DE.UTF-8") || std::setlocale(LC_TIME, "fr_FR.UTF-8")) {
+        REQUIRE(httpDate(784111777) == "Sun, 06 Nov 1994 08:49:37 GMT");
+        REQUIRE(parseHttpDate("Thu, 01 May 2025 00:00:00 GMT", seconds));
+        REQUIRE(seconds == 1746057600);
+    }
+    std::setlocale(LC_TIME, saved.c_str());
+
+    REQUIRE(std::string(mimeTypeFor("index.HTML")) == "text/html; charset=utf-8");
+    REQUIRE(std::string(mimeTypeFor("app.v2/main.js")) == "text/javascript; charset=utf-8");
+    REQUIRE(std::string(mimeTypeFor("archive.v2/README")) == "application/octet-stream");
+}
+
+TEST_CASE("Asset metadata cache", "[assets]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-assets";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "css").create();
+    std::string css = "body { margin: 0 }";
+    File(testDir / "css" / "site.css").writeText(css);
+
+    SECTION("Validators and headers") {
+        AssetCache cache(testDir);
+        AssetLookup lookup = cache.lookup("css/site.css");
+        REQUIRE(lookup.status == AssetStatus::Found);
+        REQUIRE_FALSE(lookup.cached);
+        const Asset& asset = *lookup.asset;
+        REQUIRE(asset.size() == css.size());
+        REQUIRE(asset.path() == "css/site.css");
+        REQUIRE(std::string(asset.contentType()) == "text/css; charset=utf-8");
+        REQUIRE(asset.contentHash() == hash64(css.data(), css.size()));
+        REQUIRE(asset.etag().size() == 18);
+        REQUIRE(asset.headers() == "Content-Type: text/css; charset=utf-8\r\nLast-Modified: " + asset.lastModified() +
+                                       "\r\nETag: " + asset.etag() + "\r\nAccept-Ranges: bytes\r\n");
+
+        char buffer[64];
+        REQUIRE(::pread(asset.fd(), buffer, sizeof(buffer), 0) == static_cast<ssize_t>(css.size()));
+
+        REQUIRE(asset.matchesETag(asset.etag()));
+        REQUIRE(asset.matchesETag("\"other\", W/" + asset.etag()));
+        REQUIRE(asset.matchesETag("*"));
+        REQUIRE_FALSE(asset.matchesETag("\"other\""));
+        REQUIRE_FALSE(asset.modifiedSince(asset.lastModified()));
+        REQUIRE(asset.modifiedSince("Thu, 01 Jan 1970 00:00:00 GMT"));
+        REQUIRE(asset.modifiedSince("not a date"));
+    }
+
+    SECTION("Identical content shares an ETag") {
+        File(testDir / "copy.css").writeText(css);
+        AssetCache cache(testDir);
+        REQUIRE(cache.lookup("copy.css").asset->etag() == cache.lookup("css/site.css").asset->etag());
+    }
+
+    SECTION("Large files fall back to size and mtime") {
+        AssetCacheOptions options;
+        options.hashLimit = 4;
+        AssetCache cache(testDir, options);
+        std::shared_ptr<const Asset> asset = cache.lookup("css/site.css").asset;
+        REQUIRE(asset->contentHash() == 0);
+        REQUIRE(asset->etag().find('-') != std::string::npos);
+    }
+
+    SECTION("Lookup failures") {
+        AssetCache cache(testDir);
+        REQUIRE(cache.lookup("missing.css").status == AssetStatus::NotFound);
+        REQUIRE(cache.lookup("css").status == AssetStatus::Directory);
+        REQUIRE_FALSE(cache.lookup("css").asset);
+        REQUIRE(cache.size() == 0);
+    }
+
+    SECTION("Fresh entries are served without touching the disk") {
+        AssetCacheOptions options;
+        options.revalidateMs = 60 * 60 * 1000;
+        AssetCache cache(testDir, options);
+        std::shared_ptr<const Asset> first = cache.lookup("css/site.css").asset;
+        File(testDir / "css" / "site.css").remove();
+
+        AssetLookup again = cache.lookup("css/site.css");
+        REQUIRE(again.cached);
+        REQUIRE(again.asset == first);
+
+        // A watcher reporting the change drops the entry
+        cache.invalidate("css/site.css");
+        REQUIRE(cache.lookup("css/site.css").status == AssetStatus::NotFound);
+    }
+
+    SECTION("Stale entries are re-stat-ed") {
+        AssetCacheOptions options;
+        options.revalidateMs = 0;
+        AssetCache cache(testDir, options);
+        std::shared_ptr<const Asset> first = cache.lookup("css/site.css").asset;
+        std::string etag = first->etag();
+
+        AssetLookup unchanged = cache.lookup("css/site.css");
+        REQUIRE(unchanged.cached);
+        REQUIRE(unchanged.asset == first);
+
+        File(testDir / "next.css").writeText("body { margin: 1px }");
+        File(testDir / "next.css").move(testDir / "css" / "site.css");
+        AssetLookup replaced = cache.lookup("css/site.css");
+        REQUIRE_FALSE(replaced.cached);
+        REQUIRE(replaced.asset != first);
+        REQUIRE(replaced.asset->etag() != etag);
+        // The old version stays readable through its holder
+        REQUIRE(first->contentHash() == hash64(css.data(), css.size()));
+    }
+
+    SECTION("Capacity and concurrent lookups") {
+        for (int i = 0; i < 20; ++i) {
+            File(testDir / ("file" + std::to_string(i) + ".txt")).writeText(std::to_string(i));
+        }
+        AssetCacheOptions options;
+        options.capacity = 8;
+        AssetCache cache(testDir, options);
+        std::vector<std::thread> threads;
+        std::atomic<int> failures{0};
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&cache, &failures, t]() {
+                for (int i = 0; i < 200; ++i) {
+                    int n = (i * 7 + t) % 20;
+                    AssetLookup lookup = cache.lookup("file" + std::to_string(n) + ".txt");
+                    std::string expected = std::to_string(n);
+                    if (!lookup.asset || lookup.asset->contentHash() != hash64(expected.data(), expected.size())) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        REQUIRE(failures == 0);
+        REQUIRE(cache.size() == 8);
+        cache.clear();
+        REQUIRE(cache.size() == 0);
+    }
+
+    Directory(testDir).remove(true);
+}
+
+#endif // __unix__ || __APPLE__
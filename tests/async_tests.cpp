@@ -0,0 +1,78 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/async.hpp"
+#include "core/thread_pool.hpp"
+
+#include <atomic>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Thread pool", "[threadpool]") {
+    ThreadPool pool(2, 4);
+
+    SECTION("Submit returns results and propagates exceptions") {
+        REQUIRE(pool.submit([]() { return 42; }).get() == 42);
+        auto failing = pool.submit([]() -> int { throw std::runtime_error("boom"); });
+        REQUIRE_THROWS_AS(failing.get(), std::runtime_error);
+    }
+
+    SECTION("Bounded queue accepts more tasks than its capacity") {
+        std::atomic<int> counter{0};
+        std::vector<std::future<void>> futures;
+        for (int i = 0; i < 64; ++i) {
+            futures.push_back(pool.submit([&counter]() { ++counter; }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+        REQUIRE(counter == 64);
+    }
+
+    SECTION("parallelFor visits every index once") {
+        std::vector<std::atomic<int>> hits(100);
+        pool.parallelFor(hits.size(), [&hits](size_t i) { ++hits[i]; });
+        for (auto& hit : hits) {
+            REQUIRE(hit == 1);
+        }
+    }
+}
+
+TEST_CASE("Asynchronous file operations", "[async]") {
+    Path testDir(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-async");
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+
+    Path source(testDir.toString() + Path::separator() + "source.txt");
+    Path copy(testDir.toString() + Path::separator() + "copy.txt");
+
+    SECTION("Write, read, copy and list") {
+        writeAsync(source, "async content").get();
+
+        bool callbackRan = false;
+        std::string text = readAsync(source, [&callbackRan](const std::string& value, std::exception_ptr error) {
+            callbackRan = !error && value == "async content";
+        }).get();
+        REQUIRE(text == "async content");
+        REQUIRE(callbackRan);
+
+        copyAsync(source, copy).get();
+        REQUIRE(File(copy).readAsText() == "async content");
+
+        REQUIRE(listAsync(testDir).get().size() == 2);
+    }
+
+    SECTION("Errors reach both the callback and the future") {
+        Path missing(testDir.toString() + Path::separator() + "missing.txt");
+        bool sawError = false;
+        auto future = readAsync(missing, [&sawError](const std::string&, std::exception_ptr error) {
+            sawError = error != nullptr;
+        });
+        REQUIRE_THROWS_AS(future.get(), FileSystemException);
+        REQUIRE(sawError);
+    }
+
+    Directory(testDir).remove(true);
+}
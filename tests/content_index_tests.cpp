@@ -0,0 +1,136 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/content_index.hpp"
+
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace crossdev::fs;
+
+namespace {
+
+std::vector<std::string> filenames(const std::vector<Path>& paths) {
+    std::vector<std::string> result;
+    for (const Path& path : paths) {
+        result.push_back(path.filename());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("Trigram content index", "[contentindex]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-content-index";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "sub").create();
+    File(testDir / "alpha.txt").writeText("the quick brown fox\njumps over\n");
+    File(testDir / "beta.txt").writeText("a lazy dog\nquick thinking\n");
+    File(testDir / "sub" / "gamma.txt").writeText("nothing to see here\n");
+    File(testDir / "blob.bin").writeBinary({'q', 'u', 'i', 'c', 'k', 0, 1, 2});
+
+    ContentIndex index(testDir);
+    index.update();
+    REQUIRE(index.size() == 4);
+    REQUIRE(index.stats().filesIndexed == 3);
+    REQUIRE(index.stats().filesSkipped == 1);
+
+    SECTION("Candidates come from the posting lists") {
+        REQUIRE(filenames(index.candidates("quick")) == std::vector<std::string>{"alpha.txt", "beta.txt"});
+        REQUIRE(filenames(index.candidates("see here")) == std::vector<std::string>{"gamma.txt"});
+        REQUIRE(index.candidates("absent").empty());
+        REQUIRE(index.candidates("Quick").empty());
+        // Too short for a trigram: every indexed file, never the binary one
+        REQUIRE(index.candidates("qu").size() == 3);
+    }
+
+    SECTION("Search confirms matches in the candidates") {
+        std::vector<SearchMatch> matches = index.search("jumps over");
+        REQUIRE(matches.size() == 1);
+        REQUIRE(matches[0].file.filename() == "alpha.txt");
+        REQUIRE(matches[0].line == 2);
+        REQUIRE(index.search("fox jumps").empty());
+    }
+
+    SECTION("Updates re-read changed files only") {
+        File(testDir / "beta.txt").writeText("the lazy dog sleeps on\n");
+        File(testDir / "delta.txt").writeText("a quick reply\n");
+        File(testDir / "sub" / "gamma.txt").remove();
+        index.update();
+        REQUIRE(index.size() == 4);
+        REQUIRE(index.stats().filesIndexed == 2);
+        REQUIRE(index.stats().filesReused == 2);
+        REQUIRE(filenames(index.candidates("quick")) == std::vector<std::string>{"alpha.txt", "delta.txt"});
+        REQUIRE(index.candidates("see here").empty());
+        REQUIRE(filenames(index.candidates("sleeps")) == std::vector<std::string>{"beta.txt"});
+    }
+
+    SECTION("Saved indexes are mapped back and stay updatable") {
+        Path saved = Path::tempDirectory() / "crossdev-test-content-index.idx";
+        index.save(saved);
+
+        ContentIndex loaded(testDir);
+        loaded.load(saved);
+        REQUIRE(loaded.size() == 4);
+        REQUIRE(filenames(loaded.candidates("quick")) == std::vector<std::string>{"alpha.txt", "beta.txt"});
+
+        loaded.update();
+        REQUIRE(loaded.stats().filesIndexed == 0);
+        REQUIRE(loaded.stats().filesReused == 4);
+
+        ContentIndex other(testDir / "sub");
+        REQUIRE_THROWS_AS(other.load(saved), FileSystemException);
+
+        File(saved).writeText("not an index at all, just some text");
+        REQUIRE_THROWS_AS(loaded.load(saved), FileSystemException);
+        File(saved).remove();
+    }
+
+    SECTION("Oversized files are listed but not indexed") {
+        ContentIndexOptions options;
+        options.maxFileSize = 30;
+        ContentIndex small(testDir, options);
+        small.update();
+        REQUIRE(small.size() == 4);
+        REQUIRE(small.stats().filesSkipped == 2);
+        // alpha.txt has no trigrams, so it cannot be ruled out; the binary file can
+        REQUIRE(filenames(small.candidates("quick")) == std::vector<std::string>{"alpha.txt", "beta.txt"});
+        REQUIRE(filenames(small.candidates("absent")) == std::vector<std::string>{"alpha.txt"});
+        REQUIRE(small.candidates("qu").size() == 3);
+        std::vector<SearchMatch> matches = small.search("brown fox");
+        REQUIRE(matches.size() == 1);
+        REQUIRE(matches[0].file.filename() == "alpha.txt");
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    SECTION("Unreadable files are searched and retried") {
+        // Permissions do not stop root, so the check needs an ordinary user
+        if (geteuid() != 0) {
+            Path locked = testDir / "locked.txt";
+            File(locked).writeText("quick but locked\n");
+            REQUIRE(chmod(locked.toString().c_str(), 0) == 0);
+            index.update();
+            REQUIRE(index.stats().filesSkipped == 1);
+            REQUIRE(filenames(index.candidates("locked")) == std::vector<std::string>{"locked.txt"});
+
+            // Same size and mtime, but it could not be read last time
+            REQUIRE(chmod(locked.toString().c_str(), 0644) == 0);
+            index.update();
+            REQUIRE(index.stats().filesIndexed == 1);
+            REQUIRE(index.stats().filesSkipped == 0);
+            REQUIRE(filenames(index.candidates("locked")) == std::vector<std::string>{"locked.txt"});
+            REQUIRE(filenames(index.candidates("quick")) ==
+                    std::vector<std::string>{"alpha.txt", "beta.txt", "locked.txt"});
+        }
+    }
+#endif
+
+    Directory(testDir).remove(true);
+}
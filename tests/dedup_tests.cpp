@@ -0,0 +1,75 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/dedup.hpp"
+#include "core/hash.hpp"
+
+#include <string>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Content hash", "[hash]") {
+    std::string data(1000, 'a');
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<char>('a' + i % 26);
+    }
+
+    SECTION("Known XXH64 vectors") {
+        REQUIRE(hash64("", 0) == 0xEF46DB3751D8E999ULL);
+        REQUIRE(hash64("a", 1) == 0xD24EC4F1A98C6E5BULL);
+    }
+
+    SECTION("Incremental hashing matches one-shot hashing") {
+        Hasher64 hasher(7);
+        for (size_t offset = 0; offset < data.size(); offset += 13) {
+            hasher.update(data.data() + offset, std::min<size_t>(13, data.size() - offset));
+        }
+        REQUIRE(hasher.digest() == hash64(data.data(), data.size(), 7));
+    }
+}
+
+TEST_CASE("Duplicate finder", "[dedup]") {
+    Path testDir(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-dedup");
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(Path(testDir.toString() + Path::separator() + "sub")).create();
+
+    auto write = [&testDir](const std::string& name, const std::string& content) {
+        File(Path(testDir.toString() + Path::separator() + name)).writeText(content);
+    };
+
+    std::string large(20000, 'x');
+    std::string largeVariant = large;
+    largeVariant[10000] = 'y'; // Same size and edges, different middle
+
+    write("small-a.txt", "same small content");
+    write("sub/small-b.txt", "same small content");
+    write("unique.txt", "unique content of another length");
+    write("large-a.bin", large);
+    write("sub/large-b.bin", large);
+    write("large-c.bin", largeVariant);
+    write("empty-a.txt", "");
+    write("empty-b.txt", "");
+
+    DuplicateOptions options;
+    options.edgeBytes = 1024;
+    DuplicateFinder finder(options);
+    std::vector<DuplicateGroup> groups = finder.find(testDir);
+
+    REQUIRE(groups.size() == 2);
+    REQUIRE(groups[0].size == large.size());
+    REQUIRE(groups[0].files.size() == 2);
+    REQUIRE(groups[0].files[0].filename() == "large-a.bin");
+    REQUIRE(groups[1].files.size() == 2);
+    REQUIRE(groups[1].files[1].filename() == "small-b.txt");
+
+    const DuplicateStats& stats = finder.stats();
+    REQUIRE(stats.filesScanned == 8);
+    REQUIRE(stats.sizeCandidates == 5);
+    REQUIRE(stats.edgeCandidates == 5);
+    REQUIRE(stats.fullyHashed == 3);
+
+    Directory(testDir).remove(true);
+}
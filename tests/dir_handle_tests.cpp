@@ -0,0 +1,89 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/dir_handle.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+
+using namespace crossdev::fs;
+
+TEST_CASE("Directory handle relative operations", "[dirhandle]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-dirhandle";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+
+    DirHandle root(testDir);
+
+    SECTION("Create, stat, rename and remove entries") {
+        root.mkdirAt("sub");
+        DirHandle sub = root.openDirectory("sub");
+        REQUIRE(sub.path().toString() == (testDir / "sub").toString());
+
+        int fd = sub.openAt("file.txt", O_WRONLY | O_CREAT | O_TRUNC);
+        REQUIRE(::write(fd, "hello", 5) == 5);
+        ::close(fd);
+
+        FileStatus status = sub.statAt("file.txt");
+        REQUIRE(status.isFile());
+        REQUIRE(status.size == 5);
+        REQUIRE(root.statAt("sub").isDirectory());
+
+        sub.renameAt("file.txt", root, "moved.txt");
+        REQUIRE_FALSE(sub.existsAt("file.txt"));
+        REQUIRE(File(testDir / "moved.txt").readAsText() == "hello");
+
+        std::vector<std::string> names = root.list();
+        std::sort(names.begin(), names.end());
+        REQUIRE(names == std::vector<std::string>{"moved.txt", "sub"});
+
+        root.unlinkAt("moved.txt");
+        root.removeDirectoryAt("sub");
+        REQUIRE(root.list().empty());
+        REQUIRE_THROWS_AS(root.statAt("missing"), FileSystemException);
+    }
+
+    SECTION("Recursive removal does not follow symlinks") {
+        Path outside = Path::tempDirectory() / "crossdev-test-dirhandle-outside";
+        Directory(outside).create();
+        File(outside / "keep.txt").writeText("keep");
+
+        root.mkdirAt("tree");
+        REQUIRE(::symlink(outside.toString().c_str(), (testDir / "tree" / "link").toString().c_str()) == 0);
+        File(testDir / "tree" / "file.txt").writeText("x");
+
+        root.removeTreeAt("tree");
+        REQUIRE_FALSE(root.existsAt("tree"));
+        REQUIRE(File(outside / "keep.txt").exists());
+        Directory(outside).remove(true);
+    }
+
+    SECTION("Handle cache reuses and evicts handles") {
+        Directory(testDir / "a").create();
+        Directory(testDir / "a" / "b").create();
+        Directory(testDir / "c").create();
+
+        DirHandleCache cache(2);
+        auto first = cache.get(testDir);
+        REQUIRE(cache.get(testDir) == first);
+
+        // Opened relative to the cached parent
+        auto child = cache.get(testDir / "a");
+        REQUIRE(child->statAt("b").isDirectory());
+        REQUIRE(cache.size() == 2);
+
+        cache.get(testDir / "c");
+        REQUIRE(cache.size() == 2);
+        // The evicted handle remains usable while referenced
+        REQUIRE(first->existsAt("a"));
+        REQUIRE(cache.get(testDir) != first);
+    }
+
+    Directory(testDir).remove(true);
+}
+
+#endif
@@ -2,6 +2,12 @@
 #include <catch2/catch.hpp>
 #include "core/filesystem.hpp"
 
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace crossdev::fs;
 
 TEST_CASE("Path construction and basic operations", "[path]") {
@@ -31,6 +37,71 @@ TEST_CASE("Path construction and basic operations", "[path]") {
     }
 }
 
+TEST_CASE("Lexical path operations", "[path]") {
+    const std::string sep(1, Path::separator());
+    auto native = [&sep](std::string path) {
+        for (char& c : path) {
+            if (c == '/') {
+                c = sep[0];
+            }
+        }
+        return path;
+    };
+
+    SECTION("Construction from every string form") {
+        std::string owned = "dir\\sub/file.txt";
+        const char* expected = sep == "/" ? "dir/sub/file.txt" : "dir\\sub\\file.txt";
+        REQUIRE(Path(owned).toString() == expected);
+        REQUIRE(Path(std::string_view(owned)).toString() == expected);
+        REQUIRE(Path(owned.c_str()).toString() == expected);
+        REQUIRE(Path(std::move(owned)).toString() == expected);
+    }
+
+    SECTION("Join") {
+        Path base("base/dir");
+        REQUIRE((base / "file.txt").toString() == native("base/dir/file.txt"));
+        REQUIRE((base / "nested/").toString() == native("base/dir/nested"));
+        REQUIRE((Path("root/") / "x").toString() == native("root/x"));
+
+        Path built("a");
+        built.append("b").append("").append("c");
+        built /= "d";
+        REQUIRE(built.toString() == native("a/b/c/d"));
+    }
+
+    SECTION("Normalize") {
+        REQUIRE(Path("a/./b//c/../d").lexicallyNormal().toString() == native("a/b/d"));
+        REQUIRE(Path("a/..").lexicallyNormal().toString() == ".");
+        REQUIRE(Path("../a/../../b").lexicallyNormal().toString() == native("../../b"));
+        if (sep == "/") {
+            REQUIRE(Path("/../x/./y/..").lexicallyNormal().toString() == "/x");
+            REQUIRE(Path("/").lexicallyNormal().toString() == "/");
+        }
+    }
+
+    SECTION("Relative paths") {
+        REQUIRE(Path("a/b/c/d").relativeTo(Path("a/b")).toString() == native("c/d"));
+        REQUIRE(Path("a/x").relativeTo(Path("a/b/c")).toString() == native("../../x"));
+        REQUIRE(Path("a/b").relativeTo(Path("a/b")).toString() == ".");
+
+        std::string buffer;
+        Path("src/core/path.cpp").relativeTo(Path("src"), buffer);
+        REQUIRE(buffer == native("core/path.cpp"));
+    }
+
+    SECTION("Components") {
+        std::vector<std::string> parts;
+        for (std::string_view part : Path("a//b/c").components()) {
+            parts.emplace_back(part);
+        }
+        REQUIRE(parts == std::vector<std::string>{"a", "b", "c"});
+
+        Path absolute = Path::currentDirectory();
+        REQUIRE(absolute.isAbsolute());
+        REQUIRE_FALSE(Path("relative/path").isAbsolute());
+    }
+}
+
 TEST_CASE("Path static methods", "[path]") {
     SECTION("Current directory") {
         Path currentDir = Path::currentDirectory();
@@ -192,6 +263,21 @@ TEST_CASE("Directory operations", "[directory]") {
         REQUIRE_FALSE(dir.exists());
     }
     
+#if defined(__unix__) || defined(__APPLE__)
+    SECTION("Recursive listing survives symlink loops") {
+        Directory dir(testDir);
+        dir.create();
+        Directory(testDir / "a").create();
+        File(testDir / "a" / "file.txt").writeText("x");
+        REQUIRE(::symlink(testDir.toString().c_str(), (testDir / "a" / "loop").toString().c_str()) == 0);
+
+        // a, a/file.txt, a/loop; the loop target was already listed
+        REQUIRE(dir.list(true).size() == 3);
+
+        dir.remove(true);
+    }
+#endif
+
     SECTION("Recursive directory removal") {
         // Create test directory with nested content
         Directory dir(testDir);
@@ -227,4 +313,152 @@ TEST_CASE("Directory operations", "[directory]") {
         REQUIRE_FALSE(Directory(subDir2).exists());
         REQUIRE_FALSE(Directory(nestedDir).exists());
     }
-} 
\ No newline at end of file
+} 
+TEST_CASE("Line iteration", "[file]") {
+    Path testFile(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-lines.txt");
+
+    SECTION("LF, CRLF, empty and unterminated lines") {
+        File(testFile).writeBinary({'a', '\n', 'b', 'c', '\r', '\n', '\n', 'd'});
+
+        std::vector<std::string> lines;
+        for (std::string_view line : File(testFile).lines()) {
+            lines.emplace_back(line);
+        }
+        REQUIRE(lines == std::vector<std::string>{"a", "bc", "", "d"});
+    }
+
+    SECTION("Lines spanning buffer refills stay intact") {
+        std::string longLine(100, 'x');
+        std::string content;
+        for (int i = 0; i < 20; ++i) {
+            content += "line " + std::to_string(i) + "\r\n";
+        }
+        content += longLine + "\n" + "tail";
+        File(testFile).writeText(content);
+
+        std::vector<std::string> lines;
+        for (std::string_view line : File(testFile).lines(16)) {
+            lines.emplace_back(line);
+        }
+        REQUIRE(lines.size() == 22);
+        REQUIRE(lines[0] == "line 0");
+        REQUIRE(lines[19] == "line 19");
+        REQUIRE(lines[20] == longLine);
+        REQUIRE(lines[21] == "tail");
+    }
+
+    SECTION("Empty file yields no lines") {
+        File(testFile).writeText("");
+        LineRange range = File(testFile).lines();
+        REQUIRE(range.begin() == range.end());
+    }
+
+    File(testFile).remove();
+}
+
+TEST_CASE("File space reservation", "[file]") {
+    Path testFile(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-reserve.bin");
+    if (File(testFile).exists()) {
+        File(testFile).remove();
+    }
+
+    SECTION("Reserve creates and extends the file") {
+        File(testFile).reserve(1 << 20);
+        REQUIRE(File(testFile).size() == (1 << 20));
+    }
+
+    SECTION("Reserve with keepSize leaves the length alone") {
+        File(testFile).writeText("abc");
+        File(testFile).reserve(1 << 20, true);
+        REQUIRE(File(testFile).size() == 3);
+        REQUIRE(File(testFile).readAsText() == "abc");
+    }
+
+    File(testFile).remove();
+}
+
+TEST_CASE("Batched reads of many files", "[file]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-read-many";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+
+    // More files than one submission round, plus failures mixed in
+    std::vector<Path> paths;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 300; ++i) {
+        Path path = testDir / ("config" + std::to_string(i) + ".json");
+        std::string content = "{\"id\": " + std::to_string(i) + ", \"pad\": \"" + std::string(i % 50, 'x') + "\"}";
+        File(path).writeText(content);
+        paths.push_back(path);
+        expected.push_back(content);
+    }
+    File(testDir / "empty.json").writeText("");
+    paths.push_back(testDir / "empty.json");
+    expected.push_back("");
+    paths.insert(paths.begin() + 7, testDir / "missing.json");
+    expected.insert(expected.begin() + 7, "");
+    paths.push_back(testDir);
+    expected.push_back("");
+
+    for (bool allowIoUring : {true, false}) {
+        ReadManyOptions options;
+        options.allowIoUring = allowIoUring;
+        ReadBatch batch = File::readMany(paths, options);
+        if (!allowIoUring) {
+            REQUIRE_FALSE(batch.usedIoUring());
+        }
+        REQUIRE(batch.size() == paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            INFO(paths[i].toString());
+            if (i == 7) {
+                REQUIRE(batch[i].error == std::errc::no_such_file_or_directory);
+            } else if (i + 1 == paths.size()) {
+                REQUIRE(batch[i].error == std::errc::is_a_directory);
+            } else {
+                REQUIRE_FALSE(batch[i].error);
+                REQUIRE(batch[i].data == expected[i]);
+            }
+        }
+        size_t total = 0;
+        for (const std::string& content : expected) {
+            total += content.size();
+        }
+        REQUIRE(batch.arenaSize() == total);
+    }
+
+    REQUIRE(File::readMany({}).size() == 0);
+    Directory(testDir).remove(true);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("Sparse file copy", "[file]") {
+    Path tempDir = Path::tempDirectory();
+    Path sparse(tempDir.toString() + Path::separator() + "crossdev-test-sparse.img");
+    Path copy(tempDir.toString() + Path::separator() + "crossdev-test-sparse-copy.img");
+
+    // 8 MiB file with two small data extents and a trailing hole
+    const off_t size = 8 << 20;
+    int fd = ::open(sparse.toString().c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    REQUIRE(fd >= 0);
+    REQUIRE(pwrite(fd, "head", 4, 0) == 4);
+    REQUIRE(pwrite(fd, "middle", 6, 4 << 20) == 6);
+    REQUIRE(ftruncate(fd, size) == 0);
+    ::close(fd);
+
+    File(sparse).copy(copy);
+
+    REQUIRE(File(copy).size() == static_cast<size_t>(size));
+    REQUIRE(File(copy).readAsBinary() == File(sparse).readAsBinary());
+
+    struct stat source, destination;
+    REQUIRE(stat(sparse.toString().c_str(), &source) == 0);
+    REQUIRE(stat(copy.toString().c_str(), &destination) == 0);
+    // The copy must not be materialised densely
+    REQUIRE(destination.st_blocks <= source.st_blocks + 16);
+
+    File(sparse).remove();
+    File(copy).remove();
+}
+#endif
@@ -0,0 +1,111 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/fuzzy_match.hpp"
+#include "core/thread_pool.hpp"
+
+#include <algorithm>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Fuzzy scoring", "[fuzzy]") {
+    SECTION("Characters must appear in order") {
+        REQUIRE(FuzzyMatcher::score("abc", "xaxbxcx") != FuzzyMatcher::kNoMatch);
+        REQUIRE(FuzzyMatcher::score("abc", "cba") == FuzzyMatcher::kNoMatch);
+        REQUIRE(FuzzyMatcher::score("abc", "ab") == FuzzyMatcher::kNoMatch);
+        REQUIRE(FuzzyMatcher::score("ABC", "xaxbxc") == FuzzyMatcher::score("abc", "xaxbxc"));
+    }
+
+    SECTION("Consecutive and boundary matches rank higher") {
+        REQUIRE(FuzzyMatcher::score("abc", "xxabcxx") > FuzzyMatcher::score("abc", "xaxbxcx"));
+        REQUIRE(FuzzyMatcher::score("fm", "src/fuzzy_match") > FuzzyMatcher::score("fm", "src/offmap"));
+        REQUIRE(FuzzyMatcher::score("fm", "FuzzyMatch") > FuzzyMatcher::score("fm", "fuzzymatch"));
+        REQUIRE(FuzzyMatcher::score("main", "src/main.cpp") > FuzzyMatcher::score("main", "src/domain.cpp"));
+    }
+
+    SECTION("Best alignment is found, not the greedy one") {
+        // Greedy would take the first 'a' and then the far 'b'
+        REQUIRE(FuzzyMatcher::score("ab", "xaxxx_ab") > FuzzyMatcher::score("ab", "xab"));
+    }
+}
+
+TEST_CASE("Fuzzy matcher top-K", "[fuzzy]") {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 50000; ++i) {
+        paths.push_back("project/module" + std::to_string(i % 211) + "/src/file_" + std::to_string(i) + ".cpp");
+    }
+    paths.push_back("project/core/fuzzy_match.cpp");
+    paths.push_back("project/core/fuzzy_match.hpp");
+    paths.push_back("tests/fuzzy_match_tests.cpp");
+
+    FuzzyMatcher matcher(paths);
+    ThreadPool pool(2);
+
+    SECTION("Top results agree with scoring every candidate") {
+        std::vector<FuzzyMatch> top = matcher.match("fzmtch", 10, &pool);
+        REQUIRE(top.size() == 3);
+        REQUIRE(matcher.candidate(top[0].index).find("fuzzy_match") != std::string_view::npos);
+
+        std::vector<FuzzyMatch> files = matcher.match("m7s12", 25, &pool);
+        REQUIRE(files.size() == 25);
+        std::vector<int32_t> all;
+        for (const std::string& path : paths) {
+            int32_t score = FuzzyMatcher::score("m7s12", path);
+            if (score != FuzzyMatcher::kNoMatch) {
+                all.push_back(score);
+            }
+        }
+        std::sort(all.rbegin(), all.rend());
+        for (size_t i = 0; i < files.size(); ++i) {
+            REQUIRE(files[i].score == all[i]);
+            if (i > 0) {
+                REQUIRE(files[i - 1].score >= files[i].score);
+            }
+        }
+    }
+
+    SECTION("Empty query keeps the shortest candidates") {
+        std::vector<FuzzyMatch> top = matcher.match("", 3, &pool);
+        REQUIRE(top.size() == 3);
+        REQUIRE(matcher.candidate(top[0].index) == "tests/fuzzy_match_tests.cpp");
+    }
+
+    SECTION("A session narrows as the query is typed") {
+        FuzzySession session(matcher, &pool);
+        size_t previous = session.survivors();
+        REQUIRE(previous == matcher.size());
+        // Extending, editing and clearing must all agree with a full match
+        for (const char* query : {"f", "fu", "fuz", "fuzm", "fuzmat", "fuzmac", "m7", "m7s1", "", "m7s12"}) {
+            std::vector<FuzzyMatch> typed = session.match(query, 25);
+            std::vector<FuzzyMatch> full = matcher.match(query, 25, &pool);
+            REQUIRE(typed.size() == full.size());
+            for (size_t i = 0; i < typed.size(); ++i) {
+                REQUIRE(typed[i].index == full[i].index);
+                REQUIRE(typed[i].score == full[i].score);
+            }
+        }
+
+        session.reset();
+        session.match("f", 10);
+        size_t broad = session.survivors();
+        session.match("fuzzy", 10);
+        REQUIRE(session.survivors() == 3);
+        REQUIRE(session.survivors() < broad);
+    }
+
+    SECTION("No match") {
+        REQUIRE(matcher.match("qqqqzz", 10, &pool).empty());
+    }
+}
+
+TEST_CASE("Fuzzy matcher over a path list", "[fuzzy]") {
+    PathList list(Path("/repo"));
+    uint32_t src = list.add(PathList::kRoot, "src", EntryType::Directory);
+    list.add(src, "walker.cpp", EntryType::File);
+    list.add(src, "path_list.cpp", EntryType::File);
+
+    FuzzyMatcher matcher(list);
+    std::vector<FuzzyMatch> top = matcher.match("plc");
+    REQUIRE(!top.empty());
+    REQUIRE(matcher.candidate(top[0].index) == (Path("src") / "path_list.cpp").toString());
+}
@@ -0,0 +1,152 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/incremental_scan.hpp"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace crossdev::fs;
+
+namespace {
+
+std::set<std::string> relativePaths(const PathList& list) {
+    std::set<std::string> result;
+    std::string relative;
+    for (size_t i = 0; i < list.size(); ++i) {
+        list.relativePathInto(i, relative);
+        result.insert(relative);
+    }
+    return result;
+}
+
+// Temporaries left beside file by an interrupted or failed write
+size_t temporariesBeside(const Path& file) {
+    size_t count = 0;
+    std::string prefix = file.filename() + ".";
+    for (const Path& entry : Directory(file.parent()).list()) {
+        std::string name = entry.filename();
+        bool temporary = name.size() > 4 && name.substr(name.size() - 4) == ".tmp";
+        if (temporary && name.compare(0, prefix.size(), prefix) == 0) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("Incremental rescans reuse unchanged directories", "[incremental]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-incremental";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    for (int d = 0; d < 3; ++d) {
+        Path dir = testDir / ("dir" + std::to_string(d));
+        Directory(dir).create();
+        File(dir / "a.txt").writeText("a");
+        File(dir / "b.txt").writeText("bb");
+    }
+
+    IncrementalOptions options;
+    options.racyWindowNs = 0;
+    IncrementalScanner scanner(testDir, options);
+
+    const PathList& first = scanner.scan();
+    REQUIRE(first.size() == 9);
+    REQUIRE(scanner.stats().directoriesRead == 4);
+    REQUIRE(scanner.stats().directoriesReused == 0);
+
+    SECTION("Nothing changed") {
+        const PathList& second = scanner.scan();
+        REQUIRE(second.size() == 9);
+        REQUIRE(scanner.stats().directoriesRead == 0);
+        REQUIRE(scanner.stats().directoriesReused == 4);
+    }
+
+    SECTION("Only the changed directory is read") {
+        File(testDir / "dir1" / "c.txt").writeText("ccc");
+        File(testDir / "dir2" / "a.txt").remove();
+        std::set<std::string> expected = relativePaths(scanner.scan());
+        REQUIRE(scanner.stats().directoriesRead == 2);
+        REQUIRE(scanner.stats().directoriesReused == 2);
+        REQUIRE(expected.count((Path("dir1") / "c.txt").toString()) == 1);
+        REQUIRE(expected.count((Path("dir2") / "a.txt").toString()) == 0);
+        REQUIRE(scanner.entries().size() == 9);
+    }
+
+    SECTION("Files are re-stat-ed on request") {
+        File(testDir / "dir0" / "a.txt").writeText("rewritten");
+        options.restatFiles = true;
+        IncrementalScanner restating(testDir, options);
+        restating.scan();
+        File(testDir / "dir0" / "b.txt").writeText("rewritten too");
+        const PathList& list = restating.scan();
+        REQUIRE(restating.stats().directoriesRead == 0);
+        REQUIRE(restating.stats().filesRestated == 9);
+        for (size_t i = 0; i < list.size(); ++i) {
+            std::string path;
+            list.relativePathInto(i, path);
+            if (path == (Path("dir0") / "b.txt").toString()) {
+                REQUIRE(list.fileSize(i) == 13);
+            }
+        }
+    }
+
+    SECTION("State survives save and load") {
+        Path stateFile = Path::tempDirectory() / "crossdev-test-incremental.state";
+        scanner.save(stateFile);
+
+        IncrementalScanner restored(testDir, options);
+        restored.load(stateFile);
+        REQUIRE(relativePaths(restored.entries()) == relativePaths(scanner.entries()));
+        restored.scan();
+        REQUIRE(restored.stats().directoriesRead == 0);
+        REQUIRE(relativePaths(restored.entries()) == relativePaths(scanner.entries()));
+
+        IncrementalScanner other(testDir / "dir0", options);
+        REQUIRE_THROWS_AS(other.load(stateFile), FileSystemException);
+
+        File(stateFile).writeText("garbage");
+        REQUIRE_THROWS_AS(restored.load(stateFile), FileSystemException);
+        File(stateFile).remove();
+    }
+
+    SECTION("Concurrent saves of one file do not share a temporary") {
+        Path stateFile = Path::tempDirectory() / "crossdev-test-incremental-shared.state";
+        std::atomic<int> failures{0};
+        std::vector<std::thread> savers;
+        for (int t = 0; t < 4; ++t) {
+            savers.emplace_back([&]() {
+                for (int i = 0; i < 25; ++i) {
+                    try {
+                        scanner.save(stateFile);
+                    } catch (const FileSystemException&) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+        for (std::thread& saver : savers) {
+            saver.join();
+        }
+        REQUIRE(failures == 0);
+        REQUIRE(temporariesBeside(stateFile) == 0);
+        IncrementalScanner restored(testDir, options);
+        restored.load(stateFile);
+        REQUIRE(relativePaths(restored.entries()) == relativePaths(scanner.entries()));
+        File(stateFile).remove();
+    }
+
+    SECTION("Recent changes are re-read next time") {
+        IncrementalOptions cautious;
+        IncrementalScanner racy(testDir, cautious);
+        racy.scan();
+        racy.scan();
+        REQUIRE(racy.stats().directoriesReused == 0);
+    }
+
+    Directory(testDir).remove(true);
+}
@@ -0,0 +1,85 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/name_index.hpp"
+#include "core/thread_pool.hpp"
+
+#include <algorithm>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+namespace {
+
+std::vector<std::string> sorted(std::vector<std::string> values) {
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+// Reference answer: plain case-insensitive substring test over every path
+std::vector<std::string> bruteForce(const std::vector<std::string>& paths, std::string needle) {
+    std::transform(needle.begin(), needle.end(), needle.begin(), ::tolower);
+    std::vector<std::string> result;
+    for (const std::string& path : paths) {
+        std::string lowered = path;
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        if (lowered.find(needle) != std::string::npos) {
+            result.push_back(path);
+        }
+    }
+    return sorted(result);
+}
+
+} // namespace
+
+TEST_CASE("Trigram name index", "[nameindex]") {
+    std::vector<std::string> paths;
+    for (int i = 0; i < 20000; ++i) {
+        paths.push_back("src/module" + std::to_string(i % 97) + "/File" + std::to_string(i) +
+                        (i % 3 ? ".cpp" : ".Hpp"));
+    }
+    paths.push_back("README.md");
+    paths.push_back("docs/readme-extra.md");
+
+    ThreadPool pool(2);
+    NameIndex index = NameIndex::build(paths, &pool);
+    REQUIRE(index.size() == paths.size());
+
+    SECTION("Results match a brute-force scan") {
+        for (const char* query : {"file1234", "MODULE9/", ".hpp", "readme", "zz", "e", "module96/file19", "nothere"}) {
+            REQUIRE(sorted(index.search(query)) == bruteForce(paths, query));
+        }
+        REQUIRE(index.search(".cpp", 5).size() == 5);
+    }
+
+    SECTION("Incremental updates") {
+        index.add("new/Thing.cpp");
+        index.remove("README.md");
+        index.remove("README.md");
+        index.add("src/module0/File0.Hpp"); // already present
+        REQUIRE(index.size() == paths.size());
+        REQUIRE(index.search("thing") == std::vector<std::string>{"new/Thing.cpp"});
+        REQUIRE(index.search("readme") == std::vector<std::string>{"docs/readme-extra.md"});
+
+        index.add("README.md");
+        REQUIRE(index.search("readme.md").size() == 1);
+        index.remove("new/Thing.cpp");
+        REQUIRE(index.search("thing").empty());
+    }
+
+    SECTION("Save and map") {
+        Path file = Path::tempDirectory() / "crossdev-test-names.idx";
+        index.add("added/later.txt");
+        index.remove("README.md");
+        index.save(file, &pool);
+
+        NameIndex mapped = NameIndex::open(file);
+        REQUIRE(mapped.size() == paths.size());
+        REQUIRE(mapped.search("later") == std::vector<std::string>{"added/later.txt"});
+        REQUIRE(mapped.search("README.md").empty());
+        REQUIRE(sorted(mapped.search("file1999")) == sorted(index.search("file1999")));
+
+        File(file).writeText("definitely not a name index, but long enough to pass the size check.......");
+        REQUIRE_THROWS_AS(NameIndex::open(file), FileSystemException);
+        File(file).remove();
+    }
+}
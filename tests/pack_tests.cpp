@@ -0,0 +1,131 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/hash.hpp"
+#include "core/pack.hpp"
+#include "core/thread_pool.hpp"
+
+#include <cstring>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Small-file packs", "[pack]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-pack";
+    Path packFile = Path::tempDirectory() / "crossdev-test.pack";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "css").create();
+    Directory(testDir / "img").create();
+    File(testDir / "index.html").writeText("<html>hello</html>");
+    File(testDir / "css" / "site.css").writeText("body { margin: 0 }");
+    File(testDir / "empty.txt").writeText("");
+    std::vector<uint8_t> binary(70000);
+    for (size_t i = 0; i < binary.size(); ++i) {
+        binary[i] = static_cast<uint8_t>(i * 31);
+    }
+    File(testDir / "img" / "logo.png").writeBinary(binary);
+    for (int i = 0; i < 500; ++i) {
+        File(testDir / "img" / ("icon" + std::to_string(i) + ".svg")).writeText("<svg id=" + std::to_string(i) + "/>");
+    }
+
+    ThreadPool pool(2);
+    PackOptions options;
+    options.pool = &pool;
+    // Small batches exercise the batch boundaries
+    options.batchBytes = 4096;
+    PackStats stats = Pack::build(testDir, packFile, options);
+    REQUIRE(stats.files == 504);
+    REQUIRE(stats.bytes == 18 + 18 + 70000 + [] {
+        uint64_t total = 0;
+        for (int i = 0; i < 500; ++i) {
+            total += ("<svg id=" + std::to_string(i) + "/>").size();
+        }
+        return total;
+    }());
+
+    Pack pack = Pack::open(packFile);
+    REQUIRE(pack.size() == 504);
+    for (size_t i = 1; i < pack.size(); ++i) {
+        REQUIRE(pack.path(i - 1) < pack.path(i));
+    }
+
+    PackEntry entry;
+    REQUIRE(pack.find("index.html", entry));
+    REQUIRE(entry.data == "<html>hello</html>");
+    REQUIRE(entry.hash == hash64(entry.data.data(), entry.data.size()));
+    REQUIRE(pack.find("css/site.css", entry));
+    REQUIRE(entry.data == "body { margin: 0 }");
+    REQUIRE(pack.find("empty.txt", entry));
+    REQUIRE(entry.data.empty());
+    REQUIRE(pack.find("img/logo.png", entry));
+    REQUIRE(entry.data.size() == binary.size());
+    REQUIRE(std::memcmp(entry.data.data(), binary.data(), binary.size()) == 0);
+    REQUIRE(pack.find("img/icon321.svg", entry));
+    REQUIRE(entry.data == "<svg id=321/>");
+
+    REQUIRE_FALSE(pack.find("missing.html", entry));
+    REQUIRE_FALSE(pack.find("css", entry));
+    REQUIRE_FALSE(pack.find("", entry));
+
+    SECTION("Rebuilding replaces the pack") {
+        File(testDir / "index.html").writeText("<html>changed</html>");
+        Pack::build(testDir, packFile, options);
+        Pack rebuilt = Pack::open(packFile);
+        REQUIRE(rebuilt.find("index.html", entry));
+        REQUIRE(entry.data == "<html>changed</html>");
+        // The old mapping still reads the old contents
+        REQUIRE(pack.find("index.html", entry));
+        REQUIRE(entry.data == "<html>hello</html>");
+    }
+
+    SECTION("A corrupt slot table without an empty slot ends the lookup") {
+        // The slot section's offset and length follow the two counts and two sections
+        std::vector<uint8_t> bytes = File(packFile).readAsBinary();
+        uint64_t slots;
+        uint64_t slotBytes;
+        std::memcpy(&slots, bytes.data() + 64, sizeof(slots));
+        std::memcpy(&slotBytes, bytes.data() + 72, sizeof(slotBytes));
+        std::memset(bytes.data() + slots, 0xFF, static_cast<size_t>(slotBytes));
+        Path broken = Path::tempDirectory() / "crossdev-test-broken.pack";
+        File(broken).writeBinary(bytes);
+        REQUIRE_FALSE(Pack::open(broken).find("index.html", entry));
+        File(broken).remove();
+    }
+
+#if defined(__unix__) || defined(__APPLE__)
+    SECTION("A failed build leaves no temporary behind") {
+        // Permissions do not stop root, so the check needs an ordinary user
+        if (geteuid() != 0) {
+            Path locked = testDir / "locked.txt";
+            File(locked).writeText("secret");
+            REQUIRE(chmod(locked.toString().c_str(), 0) == 0);
+            REQUIRE_THROWS_AS(Pack::build(testDir, packFile, options), FileSystemException);
+            for (const Path& entry : Directory(packFile.parent()).list()) {
+                std::string name = entry.filename();
+                bool temporary = name.size() > 4 && name.substr(name.size() - 4) == ".tmp";
+                REQUIRE_FALSE((temporary && name.compare(0, packFile.filename().size(), packFile.filename()) == 0));
+            }
+            // The previous pack is untouched
+            REQUIRE(Pack::open(packFile).find("index.html", entry));
+            REQUIRE(chmod(locked.toString().c_str(), 0644) == 0);
+        }
+    }
+#endif
+
+    SECTION("Invalid files are rejected") {
+        Path bogus = Path::tempDirectory() / "crossdev-test-bogus.pack";
+        File(bogus).writeText("definitely not a pack file, but long enough to hold a header or two ...........");
+        REQUIRE_THROWS_AS(Pack::open(bogus), FileSystemException);
+        File(bogus).remove();
+    }
+
+    File(packFile).remove();
+    Directory(testDir).remove(true);
+}
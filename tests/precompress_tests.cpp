@@ -0,0 +1,184 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/precompress.hpp"
+#include "core/stream.hpp"
+#include "core/thread_pool.hpp"
+#include "core/walker.hpp"
+
+#include <chrono>
+#include <thread>
+
+#if defined(CROSSDEV_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+namespace {
+
+#if defined(CROSSDEV_HAVE_ZLIB)
+std::string gunzip(const std::vector<uint8_t>& compressed) {
+    z_stream stream = {};
+    REQUIRE(inflateInit2(&stream, 15 + 16) == Z_OK);
+    stream.next_in = const_cast<Bytef*>(compressed.data());
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    std::string result;
+    char chunk[4096];
+    int status;
+    do {
+        stream.next_out = reinterpret_cast<Bytef*>(chunk);
+        stream.avail_out = sizeof(chunk);
+        status = inflate(&stream, Z_NO_FLUSH);
+        REQUIRE((status == Z_OK || status == Z_STREAM_END));
+        result.append(chunk, sizeof(chunk) - stream.avail_out);
+    } while (status != Z_STREAM_END);
+    inflateEnd(&stream);
+    return result;
+}
+#endif
+
+size_t countTemporaries(const Path& root) {
+    std::atomic<size_t> count{0};
+    Walker().walk(root, [&count](size_t, const WalkEntry& entry) {
+        if (entry.name.size() > 4 && entry.name.substr(entry.name.size() - 4) == ".tmp") {
+            ++count;
+        }
+    });
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("Precompressed variants", "[precompress]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-precompress";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "css").create();
+
+    std::string css;
+    for (int i = 0; i < 2000; ++i) {
+        css += ".rule" + std::to_string(i) + " { margin: 0; padding: 0 }\n";
+    }
+    std::string html;
+    for (int i = 0; i < 200; ++i) {
+        html += "<p>Paragraph " + std::to_string(i) + "</p>\n";
+    }
+    std::string noise(4096, '\0');
+    uint32_t state = 12345;
+    for (char& c : noise) {
+        state = state * 1103515245 + 12345;
+        c = static_cast<char>(state >> 24);
+    }
+    File(testDir / "css" / "site.css").writeText(css);
+    File(testDir / "INDEX.HTML").writeText(html);
+    File(testDir / "tiny.js").writeText("let a = 1;");
+    File(testDir / "image.png").writeText(css);
+    // An old variant of a file that no longer compresses
+    File(testDir / "noise.js.gz").writeText("stale");
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    File(testDir / "noise.js").writeText(noise);
+
+    ThreadPool pool(2);
+    PrecompressOptions options;
+    options.pool = &pool;
+    Precompressor precompressor(options);
+
+    if (!Precompressor::available()) {
+        PrecompressStats stats = precompressor.run(testDir);
+        REQUIRE_FALSE(stats.supported);
+        REQUIRE_FALSE(Path(testDir.toString() + "/css/site.css.gz").exists());
+        REQUIRE_THROWS_AS(precompressor.compressFile(testDir / "INDEX.HTML", testDir / "INDEX.HTML.gz"),
+                          FileSystemException);
+        Directory(testDir).remove(true);
+        return;
+    }
+
+    SECTION("Compress eligible files and skip up-to-date variants") {
+        PrecompressStats stats = precompressor.run(testDir);
+        REQUIRE(stats.supported);
+        REQUIRE(stats.eligible == 3);
+        REQUIRE(stats.compressed == 2);
+        REQUIRE(stats.incompressible == 1);
+        REQUIRE(stats.upToDate == 0);
+        REQUIRE(stats.failed == 0);
+        REQUIRE(stats.bytesIn == css.size() + html.size());
+        REQUIRE(stats.bytesOut < stats.bytesIn / 4);
+        REQUIRE(countTemporaries(testDir) == 0);
+
+        REQUIRE(Path(testDir.toString() + "/css/site.css.gz").exists());
+        REQUIRE(Path(testDir.toString() + "/INDEX.HTML.gz").exists());
+        REQUIRE_FALSE(Path(testDir.toString() + "/tiny.js.gz").exists());
+        REQUIRE_FALSE(Path(testDir.toString() + "/image.png.gz").exists());
+        REQUIRE_FALSE(Path(testDir.toString() + "/noise.js.gz").exists());
+#if defined(CROSSDEV_HAVE_ZLIB)
+        REQUIRE(gunzip(File(testDir / "css" / "site.css.gz").readAsBinary()) == css);
+        REQUIRE(gunzip(File(testDir / "INDEX.HTML.gz").readAsBinary()) == html);
+#endif
+
+        REQUIRE(Path(testDir.toString() + "/.precompress-skip").exists());
+
+        // The incompressible file is remembered, not compressed again
+        PrecompressStats again = precompressor.run(testDir);
+        REQUIRE(again.eligible == 3);
+        REQUIRE(again.upToDate == 3);
+        REQUIRE(again.compressed == 0);
+        REQUIRE(again.incompressible == 0);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        css += "body { color: red }\n";
+        File(testDir / "css" / "site.css").writeText(css);
+        PrecompressStats changed = precompressor.run(testDir);
+        REQUIRE(changed.compressed == 1);
+        REQUIRE(changed.upToDate == 2);
+#if defined(CROSSDEV_HAVE_ZLIB)
+        REQUIRE(gunzip(File(testDir / "css" / "site.css.gz").readAsBinary()) == css);
+#endif
+        REQUIRE(FileReader(testDir / "css" / "site.css.gz").mtimeNs() ==
+                FileReader(testDir / "css" / "site.css").mtimeNs());
+
+        // A deploy that preserves mtimes replaces the source with content older than its variant
+        css += "body { color: blue }\n";
+        int64_t older = FileReader(testDir / "css" / "site.css").mtimeNs() - 3600 * int64_t(1000000000);
+        FileWriter writer(testDir / "css" / "site.css");
+        writer.write(css.data(), css.size());
+        writer.setMtime(older);
+        writer.close();
+        PrecompressStats replaced = precompressor.run(testDir);
+        REQUIRE(replaced.compressed == 1);
+        REQUIRE(replaced.upToDate == 2);
+        REQUIRE(FileReader(testDir / "css" / "site.css.gz").mtimeNs() == older);
+#if defined(CROSSDEV_HAVE_ZLIB)
+        REQUIRE(gunzip(File(testDir / "css" / "site.css.gz").readAsBinary()) == css);
+#endif
+
+        // A changed incompressible file is tried again, and compressible content then leaves the list
+        File(testDir / "noise.js").writeText(html);
+        PrecompressStats retried = precompressor.run(testDir);
+        REQUIRE(retried.compressed == 1);
+        REQUIRE(Path(testDir.toString() + "/noise.js.gz").exists());
+        REQUIRE_FALSE(Path(testDir.toString() + "/.precompress-skip").exists());
+    }
+
+    SECTION("Compress a single file") {
+        Path target = Path::tempDirectory() / "crossdev-test-precompress.css.gz";
+        uint64_t written = precompressor.compressFile(testDir / "css" / "site.css", target);
+        REQUIRE(written == File(target).size());
+        REQUIRE(written < css.size() / 4);
+#if defined(CROSSDEV_HAVE_ZLIB)
+        REQUIRE(gunzip(File(target).readAsBinary()) == css);
+#endif
+        File(target).remove();
+        REQUIRE_THROWS_AS(precompressor.compressFile(testDir / "missing.css", target), FileSystemException);
+        REQUIRE_FALSE(target.exists());
+        for (const Path& entry : Directory(target.parent()).list()) {
+            std::string name = entry.filename();
+            bool temporary = name.size() > 4 && name.substr(name.size() - 4) == ".tmp";
+            REQUIRE_FALSE((temporary && name.compare(0, target.filename().size(), target.filename()) == 0));
+        }
+    }
+
+    Directory(testDir).remove(true);
+}
@@ -0,0 +1,99 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/mapped_file.hpp"
+#include "core/search.hpp"
+#include "core/simd.hpp"
+
+#include <string>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Vectorised literal search", "[simd]") {
+    std::string haystack(200, 'a');
+    haystack.replace(150, 5, "abcab");
+
+    const char* begin = haystack.data();
+    const char* end = begin + haystack.size();
+
+    REQUIRE(simd::findLiteral(begin, end, "abcab", 5) == begin + 150);
+    REQUIRE(simd::findLiteral(begin, end, "abcd", 4) == end);
+    REQUIRE(simd::findLiteral(begin, end, "ab", 2) == begin + 150);
+    REQUIRE(simd::findLiteral(begin, begin + 3, "aaaa", 4) == begin + 3);
+    REQUIRE(simd::countByte(begin, end, 'b') == 2);
+}
+
+TEST_CASE("Vectorised byte replacement", "[simd]") {
+    // Cover the scalar tail and both vector widths at every alignment
+    for (size_t length = 0; length < 100; ++length) {
+        for (size_t hit = 0; hit <= length; hit += 7) {
+            std::string text(length, 'a');
+            std::string expected = text;
+            bool changed = false;
+            for (size_t i = hit; i < length; i += 5) {
+                text[i] = '\\';
+                expected[i] = '/';
+                changed = true;
+            }
+            REQUIRE(simd::replaceByte(&text[0], text.size(), '\\', '/') == changed);
+            REQUIRE(text == expected);
+        }
+    }
+}
+
+TEST_CASE("Content search", "[search]") {
+    Path testDir(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-search");
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(Path(testDir.toString() + Path::separator() + "logs")).create();
+
+    Path source(testDir.toString() + Path::separator() + "main.cpp");
+    Path log(testDir.toString() + Path::separator() + "logs" + Path::separator() + "app.log");
+    Path binary(testDir.toString() + Path::separator() + "blob.bin");
+
+    File(source).writeText("int main() {\n    return TODO;\n}\n");
+    File(log).writeText("ok\r\nERROR disk full\r\nok\r\nERROR TODO retry\r\n");
+    File(binary).writeBinary({'T', 'O', 'D', 'O', 0, 1, 2});
+
+    SECTION("Single file with line and column") {
+        ContentSearch search({"TODO"});
+        std::vector<SearchMatch> matches = search.searchFile(source);
+        REQUIRE(matches.size() == 1);
+        REQUIRE(matches[0].line == 2);
+        REQUIRE(matches[0].column == 12);
+        REQUIRE(matches[0].offset == 24);
+        REQUIRE(matches[0].text == "    return TODO;");
+    }
+
+    SECTION("Multiple literals across a tree, skipping binaries") {
+        ContentSearch search({"ERROR", "TODO"});
+        std::vector<SearchMatch> matches = search.search(testDir);
+        REQUIRE(matches.size() == 4);
+
+        REQUIRE(matches[0].file.filename() == "app.log");
+        REQUIRE(matches[0].line == 2);
+        REQUIRE(matches[0].text == "ERROR disk full");
+        REQUIRE(matches[1].line == 4);
+        REQUIRE(matches[1].pattern == 0);
+        REQUIRE(matches[2].line == 4);
+        REQUIRE(matches[2].pattern == 1);
+        REQUIRE(matches[2].column == 7);
+        REQUIRE(matches[3].file.filename() == "main.cpp");
+    }
+
+    SECTION("Binary files can be included") {
+        SearchOptions options;
+        options.skipBinary = false;
+        ContentSearch search({"TODO"}, options);
+        REQUIRE(search.searchFile(binary).size() == 1);
+    }
+
+    SECTION("Mapped file views the whole content") {
+        MappedFile mapped(source);
+        REQUIRE(mapped.view() == File(source).readAsText());
+    }
+
+    Directory(testDir).remove(true);
+}
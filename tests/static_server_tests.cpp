@@ -0,0 +1,291 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/static_server.hpp"
+
+#if defined(__linux__)
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <ctime>
+
+using namespace crossdev::fs;
+
+namespace {
+
+struct Response {
+    int status = 0;
+    std::string head;
+    std::string body;
+
+    std::string header(const std::string& name) const {
+        size_t at = head.find("\r\n" + name + ": ");
+        if (at == std::string::npos) {
+            return std::string();
+        }
+        at += name.size() + 4;
+        return head.substr(at, head.find("\r\n", at) - at);
+    }
+};
+
+class Client {
+public:
+    explicit Client(uint16_t port) : m_fd(::socket(AF_INET, SOCK_STREAM, 0)) {
+        struct sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        REQUIRE(::connect(m_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    }
+    ~Client() { ::close(m_fd); }
+
+    void send(const std::string& request) {
+        REQUIRE(::send(m_fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size()));
+    }
+
+    // Next response; bodies are skipped for HEAD and 304
+    Response receive(bool headOnly = false) {
+        Response response;
+        size_t end;
+        while ((end = m_buffer.find("\r\n\r\n")) == std::string::npos) {
+            REQUIRE(fill());
+        }
+        response.head = m_buffer.substr(0, end);
+        m_buffer.erase(0, end + 4);
+        response.status = std::stoi(response.head.substr(9, 3));
+        std::string length = response.header("Content-Length");
+        size_t bodySize = headOnly || length.empty() ? 0 : std::stoul(length);
+        while (m_buffer.size() < bodySize) {
+            REQUIRE(fill());
+        }
+        response.body = m_buffer.substr(0, bodySize);
+        m_buffer.erase(0, bodySize);
+        return response;
+    }
+
+    // True once the server has closed its side
+    bool closed() {
+        return m_buffer.empty() && !fill();
+    }
+
+private:
+    bool fill() {
+        char chunk[65536];
+        ssize_t got = ::recv(m_fd, chunk, sizeof(chunk), 0);
+        if (got <= 0) {
+            return false;
+        }
+        m_buffer.append(chunk, static_cast<size_t>(got));
+        return true;
+    }
+
+    int m_fd;
+    std::string m_buffer;
+};
+
+Response get(uint16_t port, const std::string& target, const std::string& headers = std::string()) {
+    Client client(port);
+    client.send("GET " + target + " HTTP/1.1\r\nHost: test\r\n" + headers + "Connection: close\r\n\r\n");
+    return client.receive();
+}
+
+} // namespace
+
+TEST_CASE("Static file server", "[server]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-server";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "docs").create();
+    File(testDir / "index.html").writeText("<html>home</html>");
+    File(testDir / "docs" / "index.html").writeText("<html>docs</html>");
+    File(testDir / "hello world.txt").writeText("Hello, World!");
+    std::string large(300000, '\0');
+    for (size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<char>('a' + i % 26);
+    }
+    File(testDir / "large.bin").writeText(large);
+
+    StaticServerOptions options;
+    options.threads = 2;
+    StaticServer server(testDir, options);
+    server.start();
+    REQUIRE(server.running());
+    REQUIRE(server.port() != 0);
+    uint16_t port = server.port();
+
+    SECTION("Serve files, index documents and errors") {
+        Response response = get(port, "/hello%20world.txt?query=1");
+        REQUIRE(response.status == 200);
+        REQUIRE(response.body == "Hello, World!");
+        REQUIRE(response.header("Content-Type") == "text/plain; charset=utf-8");
+        REQUIRE(response.header("Accept-Ranges") == "bytes");
+        REQUIRE_FALSE(response.header("ETag").empty());
+        REQUIRE_FALSE(response.header("Last-Modified").empty());
+
+        REQUIRE(get(port, "/").body == "<html>home</html>");
+        REQUIRE(get(port, "/docs/").body == "<html>docs</html>");
+        Response redirect = get(port, "/docs");
+        REQUIRE(redirect.status == 301);
+        REQUIRE(redirect.header("Location") == "/docs/");
+        REQUIRE(get(port, "//docs").header("Location") == "/docs/");
+        REQUIRE(get(port, "/%2fdocs?x=1").header("Location") == "/docs/");
+
+        REQUIRE(get(port, "/missing.txt").status == 404);
+        REQUIRE(get(port, "/../etc/passwd").status == 400);
+        REQUIRE(get(port, "/docs/%2e%2e/%2e%2e/etc/passwd").status == 400);
+
+        Response large1 = get(port, "/large.bin");
+        REQUIRE(large1.status == 200);
+        REQUIRE(large1.body == large);
+    }
+
+    SECTION("HEAD and unsupported methods") {
+        Client client(port);
+        client.send("HEAD /large.bin HTTP/1.1\r\n\r\n");
+        Response head = client.receive(true);
+        REQUIRE(head.status == 200);
+        REQUIRE(head.header("Content-Length") == "300000");
+        client.send("POST /large.bin HTTP/1.1\r\n\r\n");
+        REQUIRE(client.receive().status == 405);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody");
+        REQUIRE(client.receive().status == 400);
+        REQUIRE(client.closed());
+    }
+
+    SECTION("Byte ranges") {
+        Response range = get(port, "/large.bin", "Range: bytes=100-199\r\n");
+        REQUIRE(range.status == 206);
+        REQUIRE(range.header("Content-Range") == "bytes 100-199/300000");
+        REQUIRE(range.body == large.substr(100, 100));
+
+        Response open = get(port, "/large.bin", "Range: bytes=299990-\r\n");
+        REQUIRE(open.status == 206);
+        REQUIRE(open.body == large.substr(299990));
+
+        Response suffix = get(port, "/large.bin", "Range: bytes=-5\r\n");
+        REQUIRE(suffix.status == 206);
+        REQUIRE(suffix.header("Content-Range") == "bytes 299995-299999/300000");
+        REQUIRE(suffix.body == large.substr(299995));
+
+        Response clamped = get(port, "/hello%20world.txt", "Range: bytes=7-1000\r\n");
+        REQUIRE(clamped.body == "World!");
+
+        Response unsatisfiable = get(port, "/large.bin", "Range: bytes=300000-\r\n");
+        REQUIRE(unsatisfiable.status == 416);
+        REQUIRE(unsatisfiable.header("Content-Range") == "bytes */300000");
+
+        // Multiple ranges are answered with the whole file
+        REQUIRE(get(port, "/hello%20world.txt", "Range: bytes=0-1,3-4\r\n").status == 200);
+
+        std::string etag = get(port, "/large.bin").header("ETag");
+        REQUIRE(get(port, "/large.bin", "Range: bytes=0-9\r\nIf-Range: " + etag + "\r\n").status == 206);
+        REQUIRE(get(port, "/large.bin", "Range: bytes=0-9\r\nIf-Range: \"stale\"\r\n").status == 200);
+    }
+
+    SECTION("Conditional requests") {
+        Response first = get(port, "/hello%20world.txt");
+        std::string etag = first.header("ETag");
+        std::string lastModified = first.header("Last-Modified");
+
+        Client client(port);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nIf-None-Match: \"other\", " + etag + "\r\n\r\n");
+        Response byTag = client.receive(true);
+        REQUIRE(byTag.status == 304);
+        REQUIRE(byTag.header("ETag") == etag);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nIf-None-Match: W/" + etag + "\r\n\r\n");
+        REQUIRE(client.receive(true).status == 304);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nIf-Modified-Since: " + lastModified + "\r\n\r\n");
+        REQUIRE(client.receive(true).status == 304);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nIf-Modified-Since: Thu, 01 Jan 1970 00:00:00 GMT\r\n\r\n");
+        REQUIRE(client.receive().status == 200);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\nIf-None-Match: \"other\"\r\n\r\n");
+        REQUIRE(client.receive().status == 200);
+        REQUIRE(server.stats().notModified == 3);
+    }
+
+    SECTION("Keep-alive and pipelining") {
+        Client client(port);
+        client.send("GET /hello%20world.txt HTTP/1.1\r\n\r\n"
+                    "GET /large.bin HTTP/1.1\r\nRange: bytes=0-2\r\n\r\n"
+                    "GET /index.html HTTP/1.1\r\n\r\n");
+        REQUIRE(client.receive().body == "Hello, World!");
+        REQUIRE(client.receive().body == "abc");
+        REQUIRE(client.receive().body == "<html>home</html>");
+        client.send("GET /large.bin HTTP/1.1\r\n\r\n");
+        REQUIRE(client.receive().body == large);
+
+        client.send("GET /index.html HTTP/1.0\r\n\r\n");
+        Response closing = client.receive();
+        REQUIRE(closing.header("Connection") == "close");
+        REQUIRE(client.closed());
+
+        StaticServerStats stats = server.stats();
+        REQUIRE(stats.requests >= 5);
+        REQUIRE(stats.cacheHits >= 1);
+    }
+
+    SECTION("Special files are refused without blocking the loop") {
+        REQUIRE(::mkfifo((testDir / "pipe").toString().c_str(), 0644) == 0);
+        REQUIRE(get(port, "/pipe").status == 403);
+        REQUIRE(get(port, "/hello%20world.txt").body == "Hello, World!");
+    }
+
+    SECTION("Symlinks cannot leave the root") {
+        Path outside = Path::tempDirectory() / "crossdev-test-server-outside";
+        Directory(outside).create();
+        File(outside / "secret.txt").writeText("secret");
+        REQUIRE(::symlink(outside.toString().c_str(), (testDir / "escape").toString().c_str()) == 0);
+        REQUIRE(::symlink((outside / "secret.txt").toString().c_str(), (testDir / "secret.txt").toString().c_str()) == 0);
+        REQUIRE(get(port, "/escape/secret.txt").status == 403);
+        REQUIRE(get(port, "/secret.txt").status == 403);
+        Directory(outside).remove(true);
+    }
+
+    SECTION("Oversized request heads") {
+        Client client(port);
+        client.send("GET / HTTP/1.1\r\nX-Filler: " + std::string(10000, 'x') + "\r\n\r\n");
+        REQUIRE(client.receive().status == 431);
+        REQUIRE(client.closed());
+    }
+
+    server.stop();
+    REQUIRE_FALSE(server.running());
+    Directory(testDir).remove(true);
+}
+
+TEST_CASE("Static file server revalidation", "[server]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-server-revalidate";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    File(testDir / "page.txt").writeText("first");
+
+    StaticServerOptions options;
+    options.revalidateMs = 0;
+    StaticServer server(testDir, options);
+    server.start();
+
+    std::string etag = get(server.port(), "/page.txt").header("ETag");
+    REQUIRE(get(server.port(), "/page.txt").body == "first");
+
+    // Replace the file: a new inode, size and mtime
+    File(testDir / "next.txt").writeText("second version");
+    File(testDir / "next.txt").move(testDir / "page.txt");
+    Response changed = get(server.port(), "/page.txt", "If-None-Match: " + etag + "\r\n");
+    REQUIRE(changed.status == 200);
+    REQUIRE(changed.body == "second version");
+    REQUIRE(changed.header("ETag") != etag);
+
+    File(testDir / "page.txt").remove();
+    REQUIRE(get(server.port(), "/page.txt").status == 404);
+
+    server.stop();
+    Directory(testDir).remove(true);
+}
+
+#endif // __linux__
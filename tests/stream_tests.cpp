@@ -0,0 +1,138 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/buffer_pool.hpp"
+#include "core/stream.hpp"
+
+#include <cstdint>
+#include <vector>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+namespace {
+
+std::vector<uint8_t> pattern(size_t size) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<uint8_t>(i * 31 + i / 4096);
+    }
+    return data;
+}
+
+} // namespace
+
+TEST_CASE("Aligned buffer pool", "[stream]") {
+    AlignedBufferPool pool(1000, 512, 1);
+    REQUIRE(pool.bufferSize() == 1024);
+
+    char* first;
+    {
+        AlignedBufferPool::Buffer buffer = pool.acquire();
+        first = buffer.data();
+        REQUIRE(reinterpret_cast<uintptr_t>(first) % 512 == 0);
+    }
+    // Released buffers are recycled
+    AlignedBufferPool::Buffer again = pool.acquire();
+    REQUIRE(again.data() == first);
+}
+
+TEST_CASE("Streaming reader and writer", "[stream]") {
+    Path testFile(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-stream.bin");
+    auto mode = GENERATE(IoMode::Buffered, IoMode::Direct);
+
+    SECTION("Round trip with an unaligned tail") {
+        // Several pool buffers plus a tail that is not a block multiple
+        std::vector<uint8_t> data = pattern(3 * (1 << 20) + 12345);
+
+        FileWriter writer(testFile, mode);
+        for (size_t offset = 0; offset < data.size(); offset += 100000) {
+            writer.write(data.data() + offset, std::min<size_t>(100000, data.size() - offset));
+        }
+        REQUIRE(writer.written() == data.size());
+        writer.close();
+
+        FileReader reader(testFile, mode);
+        REQUIRE(reader.size() == data.size());
+        std::vector<uint8_t> read(data.size());
+        size_t filled = 0;
+        while (size_t got = reader.read(read.data() + filled, std::min<size_t>(77777, read.size() - filled))) {
+            filled += got;
+        }
+        REQUIRE(filled == data.size());
+        REQUIRE(read == data);
+        REQUIRE(reader.read(read.data(), 1) == 0);
+    }
+
+    SECTION("Unused reservation is released on close") {
+        FileWriter writer(testFile, mode);
+        writer.reserve(4 << 20);
+        writer.write("hello", 5);
+        writer.close();
+        REQUIRE(File(testFile).size() == 5);
+        REQUIRE(File(testFile).readAsText() == "hello");
+    }
+
+    SECTION("Move assignment closes the replaced writer") {
+        Path otherFile(testFile.toString() + ".other");
+        // Less than one block, so a direct writer still holds it all in its staging buffer
+        std::vector<uint8_t> data = pattern(5000);
+        FileWriter writer(testFile, mode);
+        writer.write(data.data(), data.size());
+        writer = FileWriter(otherFile, mode);
+        writer.write("next", 4);
+        writer.close();
+        REQUIRE(File(testFile).size() == data.size());
+        REQUIRE(File(testFile).readAsBinary() == data);
+        REQUIRE(File(otherFile).readAsText() == "next");
+        File(otherFile).remove();
+    }
+
+    SECTION("Modification time is set after the tail is written") {
+        // A multiple of 100 ns, the Win32 resolution
+        const int64_t mtime = 1500000000123456700;
+        std::vector<uint8_t> data = pattern(5000);
+        FileWriter writer(testFile, mode);
+        writer.write(data.data(), data.size());
+        writer.setMtime(mtime);
+        writer.close();
+        FileReader reader(testFile, mode);
+        REQUIRE(reader.size() == data.size());
+        REQUIRE(reader.mtimeNs() == mtime);
+    }
+
+    SECTION("File binary helpers honour the I/O mode") {
+        std::vector<uint8_t> data = pattern(5000);
+        File file(testFile);
+        file.setIoMode(mode);
+        file.writeBinary(data);
+        REQUIRE(file.size() == data.size());
+        REQUIRE(file.readAsBinary() == data);
+    }
+
+    File(testFile).remove();
+}
+
+TEST_CASE("Access hints", "[stream]") {
+    Path testFile(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-hints.bin");
+    Path copyFile(Path::tempDirectory().toString() + Path::separator() + "crossdev-test-hints-copy.bin");
+    std::vector<uint8_t> data = pattern(3 * (1 << 20) + 100);
+
+    // Hints are advisory: every operation must still produce correct data
+    File file(testFile);
+    file.setAccessHint(AccessHint::DontNeed);
+    file.writeBinary(data);
+    file.advise(AccessHint::WillNeed);
+    REQUIRE(file.readAsBinary() == data);
+
+    file.copy(copyFile);
+    REQUIRE(File(copyFile).readAsBinary() == data);
+
+    FileReader reader(testFile);
+    reader.advise(AccessHint::Sequential);
+    std::vector<uint8_t> head(1000);
+    REQUIRE(reader.read(head.data(), head.size()) == head.size());
+    reader.close();
+
+    File(testFile).remove();
+    File(copyFile).remove();
+}
@@ -0,0 +1,126 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/tree_index.hpp"
+#include "core/walker.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+using namespace crossdev::fs;
+
+TEST_CASE("Tree index round trip", "[treeindex]") {
+    Path indexFile = Path::tempDirectory() / "crossdev-test-tree.idx";
+
+    // Enough entries for several front-coding blocks
+    PathList list(Path("/srv/site"));
+    uint32_t assets = list.add(PathList::kRoot, "assets", EntryType::Directory);
+    for (int i = 0; i < 40; ++i) {
+        std::string name = "image" + std::to_string(i) + (i % 2 ? ".PNG" : ".js");
+        list.add(assets, name, EntryType::File, static_cast<uint64_t>(i) * 100, 1000 + i);
+    }
+    list.add(PathList::kRoot, "index.html", EntryType::File, 512, 7);
+    list.add(PathList::kRoot, "README", EntryType::File, 3, 8);
+
+    TreeIndex::write(list, indexFile);
+    TreeIndex index(indexFile);
+
+    REQUIRE(index.root() == "/srv/site");
+    REQUIRE(index.size() == list.size());
+
+    SECTION("Paths are sorted and decode consistently") {
+        std::vector<std::string> expected;
+        std::string relative;
+        for (size_t i = 0; i < list.size(); ++i) {
+            list.relativePathInto(i, relative);
+            expected.push_back(relative);
+        }
+        std::sort(expected.begin(), expected.end());
+
+        TreeIndex::Cursor cursor(index);
+        std::string_view path;
+        size_t count = 0;
+        while (cursor.next(path)) {
+            REQUIRE(path == expected[cursor.index()]);
+            REQUIRE(index.relativePath(cursor.index()) == expected[cursor.index()]);
+            ++count;
+        }
+        REQUIRE(count == expected.size());
+
+        TreeIndex::Cursor middle(index, 20);
+        REQUIRE(middle.next(path));
+        REQUIRE(path == expected[20]);
+    }
+
+    SECTION("Lookup and columns") {
+        size_t found = index.find((Path("assets") / "image7.PNG").toString());
+        REQUIRE(found != TreeIndex::npos);
+        REQUIRE(index.fileSize(found) == 700);
+        REQUIRE(index.mtime(found) == 1007);
+        REQUIRE(index.type(found) == EntryType::File);
+        REQUIRE(index.extension(index.extensionId(found)) == ".png");
+        REQUIRE(index.path(found).toString() == (Path("/srv/site") / "assets" / "image7.PNG").toString());
+
+        REQUIRE(index.find("README") != TreeIndex::npos);
+        REQUIRE(index.find("assets") != TreeIndex::npos);
+        REQUIRE(index.find("missing") == TreeIndex::npos);
+        REQUIRE(index.find("") == TreeIndex::npos);
+
+        REQUIRE(index.extensionId(index.find("README")) == 0);
+        REQUIRE(index.extensionId(index.find("assets")) == 0);
+        REQUIRE(index.findExtension(".JS") != TreeIndex::npos);
+        REQUIRE(index.findExtension(".css") == TreeIndex::npos);
+        REQUIRE(index.extensionCount() == 4); // "", .html, .js, .png
+    }
+
+    SECTION("Corrupt offsets throw instead of reading past the mapping") {
+        // Header: magic, version, byte order, counts, block size, then the
+        // root section and the block offset section
+        std::vector<uint8_t> bytes = File(indexFile).readAsBinary();
+        uint64_t blockOffsets;
+        std::memcpy(&blockOffsets, bytes.data() + 56, sizeof(blockOffsets));
+        const uint64_t huge = uint64_t(1) << 40;
+        for (size_t block = 0; block < 3; ++block) {
+            std::memcpy(bytes.data() + blockOffsets + block * 8, &huge, sizeof(huge));
+        }
+        File(indexFile).writeBinary(bytes);
+
+        TreeIndex broken(indexFile);
+        REQUIRE_THROWS_WITH(broken.find("README"), "Corrupt tree index");
+        REQUIRE_THROWS_WITH(TreeIndex::Cursor(broken, 20), "Corrupt tree index");
+        REQUIRE_THROWS_WITH(broken.relativePath(0), "Corrupt tree index");
+        REQUIRE_THROWS_WITH(broken.extension(static_cast<uint32_t>(broken.extensionCount())), "Corrupt tree index");
+    }
+
+    SECTION("Invalid files are rejected") {
+        File(indexFile).writeText("not an index at all, just some text that is long enough to hold a header "
+                                  "and more text so the size check is not what rejects it....................."
+                                  "...........................................................................");
+        REQUIRE_THROWS_AS(TreeIndex(indexFile), FileSystemException);
+    }
+
+    File(indexFile).remove();
+}
+
+TEST_CASE("Tree index from a walk", "[treeindex]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-tree-walk";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    Directory(testDir / "src").create();
+    File(testDir / "src" / "main.cpp").writeText("int main() {}");
+    File(testDir / "notes.txt").writeText("notes");
+
+    Path indexFile = Path::tempDirectory() / "crossdev-test-tree-walk.idx";
+    TreeIndex::write(Walker().scan(testDir), indexFile);
+    TreeIndex index(indexFile);
+
+    REQUIRE(index.size() == 3);
+    size_t main = index.find((Path("src") / "main.cpp").toString());
+    REQUIRE(main != TreeIndex::npos);
+    REQUIRE(index.fileSize(main) == 13);
+
+    File(indexFile).remove();
+    Directory(testDir).remove(true);
+}
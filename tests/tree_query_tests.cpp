@@ -0,0 +1,146 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/tree_query.hpp"
+#include "core/thread_pool.hpp"
+
+#include <cstring>
+#include <set>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+namespace {
+
+// 100k entries so the scan spans several chunks
+PathList buildTree() {
+    PathList list(Path("/srv"));
+    uint32_t web = list.add(PathList::kRoot, "web", EntryType::Directory, 4096, 0);
+    uint32_t logs = list.add(PathList::kRoot, "logs", EntryType::Directory, 4096, 0);
+    for (uint32_t i = 0; i < 100000; ++i) {
+        switch (i % 4) {
+            case 0: list.add(web, "bundle" + std::to_string(i) + ".js", EntryType::File, i * 100, i); break;
+            case 1: list.add(web, "style" + std::to_string(i) + ".CSS", EntryType::File, i, i); break;
+            case 2: list.add(logs, "app" + std::to_string(i) + ".log", EntryType::File, i * 10, i); break;
+            default: list.add(web, "dir" + std::to_string(i) + ".js", EntryType::Directory, 0, i); break;
+        }
+    }
+    return list;
+}
+
+std::set<std::string> namesOf(const PathList& list, const std::vector<uint32_t>& hits) {
+    std::set<std::string> names;
+    for (uint32_t hit : hits) {
+        names.insert(std::string(list.name(hit)));
+    }
+    return names;
+}
+
+std::set<std::string> namesOf(const TreeIndex& index, const std::vector<uint32_t>& hits) {
+    std::set<std::string> names;
+    for (uint32_t hit : hits) {
+        names.insert(index.path(hit).filename());
+    }
+    return names;
+}
+
+} // namespace
+
+TEST_CASE("Tree queries over lists and indexes agree", "[query]") {
+    PathList list = buildTree();
+    Path indexFile = Path::tempDirectory() / "crossdev-test-query.idx";
+    TreeIndex::write(list, indexFile);
+    TreeIndex index(indexFile);
+    ThreadPool pool(2);
+
+    SECTION("Extension, size and mtime") {
+        TreeQuery query(&pool);
+        query.extensions({".JS"}).sizeBetween(1000000).modifiedBetween(50000, 60000);
+        std::vector<uint32_t> hits = query.run(list);
+        // Files i % 4 == 0 with i * 100 >= 1e6 and 50000 <= i <= 60000
+        REQUIRE(hits.size() == 2501);
+        for (uint32_t hit : hits) {
+            REQUIRE(list.fileSize(hit) >= 1000000);
+            REQUIRE(list.type(hit) == EntryType::File);
+        }
+        REQUIRE(namesOf(index, query.run(index)) == namesOf(list, hits));
+    }
+
+    SECTION("Case-insensitive extensions and type") {
+        TreeQuery query(&pool);
+        query.extensions({".css", ".log"}).type(EntryType::File).sizeBetween(0, 99);
+        std::vector<uint32_t> hits = query.run(list);
+        REQUIRE(namesOf(list, hits) == std::set<std::string>{"app2.log", "app6.log", "style1.CSS", "style5.CSS",
+                                                             "style9.CSS", "style13.CSS", "style17.CSS",
+                                                             "style21.CSS", "style25.CSS", "style29.CSS",
+                                                             "style33.CSS", "style37.CSS", "style41.CSS",
+                                                             "style45.CSS", "style49.CSS", "style53.CSS",
+                                                             "style57.CSS", "style61.CSS", "style65.CSS",
+                                                             "style69.CSS", "style73.CSS", "style77.CSS",
+                                                             "style81.CSS", "style85.CSS", "style89.CSS",
+                                                             "style93.CSS", "style97.CSS"});
+        REQUIRE(namesOf(index, query.run(index)) == namesOf(list, hits));
+    }
+
+    SECTION("Name prefix and substring") {
+        TreeQuery query(&pool);
+        query.namePrefix("app").nameContains("999");
+        std::vector<uint32_t> hits = query.run(list);
+        REQUIRE(namesOf(list, hits) ==
+                std::set<std::string>{"app9990.log", "app9994.log", "app9998.log", "app19990.log", "app19994.log",
+                                      "app19998.log", "app29990.log", "app29994.log", "app29998.log",
+                                      "app39990.log", "app39994.log", "app39998.log", "app49990.log",
+                                      "app49994.log", "app49998.log", "app59990.log", "app59994.log",
+                                      "app59998.log", "app69990.log", "app69994.log", "app69998.log",
+                                      "app79990.log", "app79994.log", "app79998.log", "app89990.log",
+                                      "app89994.log", "app89998.log", "app99902.log", "app99906.log",
+                                      "app99910.log", "app99914.log", "app99918.log", "app99922.log",
+                                      "app99926.log", "app99930.log", "app99934.log", "app99938.log",
+                                      "app99942.log", "app99946.log", "app99950.log", "app99954.log",
+                                      "app99958.log", "app99962.log", "app99966.log", "app99970.log",
+                                      "app99974.log", "app99978.log", "app99982.log", "app99986.log",
+                                      "app99990.log", "app99994.log", "app99998.log"});
+        REQUIRE(namesOf(index, query.run(index)) == namesOf(list, hits));
+    }
+
+    SECTION("Directories never match an extension and empty ranges match nothing") {
+        TreeQuery directories(&pool);
+        directories.type(EntryType::Directory).extensions({".js"});
+        REQUIRE(directories.run(list).empty());
+        REQUIRE(directories.run(index).empty());
+
+        TreeQuery empty(&pool);
+        empty.sizeBetween(10, 5);
+        REQUIRE(empty.run(list).empty());
+    }
+
+    SECTION("Extension ids outside the table never match") {
+        // The extension id column's section starts at byte 136 of the header
+        std::vector<uint8_t> bytes = File(indexFile).readAsBinary();
+        uint64_t idsOffset;
+        std::memcpy(&idsOffset, bytes.data() + 136, sizeof(idsOffset));
+        const uint32_t bogus = 0xFFFFFFF0u;
+        for (size_t i = 0; i < list.size(); i += 2) {
+            std::memcpy(bytes.data() + idsOffset + i * 4, &bogus, sizeof(bogus));
+        }
+        File(indexFile).writeBinary(bytes);
+
+        TreeIndex broken(indexFile);
+        TreeQuery query(&pool);
+        query.extensions({".js", ".css", ".log"});
+        std::vector<uint32_t> hits = query.run(broken);
+        REQUIRE_FALSE(hits.empty());
+        for (uint32_t hit : hits) {
+            REQUIRE(broken.extensionId(hit) < broken.extensionCount());
+        }
+    }
+
+    SECTION("Results come back in index order") {
+        std::vector<uint32_t> all = TreeQuery(&pool).run(list);
+        REQUIRE(all.size() == list.size());
+        for (size_t i = 0; i < all.size(); ++i) {
+            REQUIRE(all[i] == i);
+        }
+    }
+
+    File(indexFile).remove();
+}
@@ -0,0 +1,203 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/thread_pool.hpp"
+#include "core/tree_stats.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("Size histogram buckets by power of two", "[treestats]") {
+    REQUIRE(SizeHistogram::bucketOf(0) == 0);
+    REQUIRE(SizeHistogram::bucketOf(1) == 1);
+    REQUIRE(SizeHistogram::bucketOf(2) == 2);
+    REQUIRE(SizeHistogram::bucketOf(3) == 2);
+    REQUIRE(SizeHistogram::bucketOf(4096) == 13);
+    REQUIRE(SizeHistogram::bucketOf(UINT64_MAX) == 64);
+    REQUIRE(SizeHistogram::bucketFloor(13) == 4096);
+
+    SizeHistogram a;
+    a.add(3);
+    a.add(2);
+    SizeHistogram b;
+    b.add(0);
+    b.add(3);
+    a.merge(b);
+    REQUIRE(a.count(0) == 1);
+    REQUIRE(a.count(2) == 3);
+    REQUIRE(a.bytes(2) == 8);
+}
+
+TEST_CASE("Top files keep the largest in bounded memory", "[treestats]") {
+    TopFiles top(3);
+    // Sizes 1..1000 in scrambled order
+    for (uint64_t i = 0; i < 1000; ++i) {
+        uint64_t size = i * 7919 % 1000 + 1;
+        if (top.accepts(size)) {
+            top.add(size, "f" + std::to_string(size));
+        }
+    }
+    std::vector<LargeFile> largest = top.sorted();
+    REQUIRE(largest.size() == 3);
+    REQUIRE(largest[0].size == 1000);
+    REQUIRE(largest[1].size == 999);
+    REQUIRE(largest[2].size == 998);
+    REQUIRE_FALSE(top.accepts(998));
+
+    TopFiles other(3);
+    other.add(5000, "big");
+    top.merge(other);
+    REQUIRE(top.sorted()[0].path == "big");
+    REQUIRE(top.sorted()[2].size == 999);
+
+    TopFiles none(0);
+    REQUIRE_FALSE(none.accepts(1));
+}
+
+TEST_CASE("Tree statistics in one streaming pass", "[treestats]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-tree-stats";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    uint64_t totalBytes = 0;
+    for (int d = 0; d < 4; ++d) {
+        Path dir = testDir / ("dir" + std::to_string(d));
+        Directory(dir).create();
+        for (int f = 0; f < 25; ++f) {
+            int size = d * 100 + f;
+            const char* extension = f % 5 == 0 ? ".LOG" : (f % 2 ? ".txt" : ".bin");
+            File(dir / ("file" + std::to_string(f) + extension)).writeText(std::string(size, 'x'));
+            totalBytes += size;
+        }
+    }
+    File(testDir / "README").writeText("hello");
+    totalBytes += 5;
+
+    ThreadPool pool(3);
+    TreeStatsOptions options;
+    options.topCount = 5;
+    options.walk.pool = &pool;
+
+    SECTION("Streamed from the walker") {
+        TreeStats stats = TreeStats::collect(testDir, options);
+        REQUIRE(stats.files() == 101);
+        REQUIRE(stats.bytes() == totalBytes);
+
+        std::vector<LargeFile> largest = stats.largest();
+        REQUIRE(largest.size() == 5);
+        REQUIRE(largest[0].size == 324);
+        REQUIRE(largest[0].path == (testDir / "dir3" / "file24.bin").toString());
+        REQUIRE(largest[4].size == 320);
+
+        std::vector<ExtensionStats> extensions = stats.extensions();
+        REQUIRE(extensions.size() == 4);
+        uint64_t files = 0;
+        for (const ExtensionStats& extension : extensions) {
+            files += extension.files;
+            if (extension.extension == ".log") {
+                REQUIRE(extension.files == 20);
+            }
+            if (extension.extension.empty()) {
+                REQUIRE(extension.files == 1);
+                REQUIRE(extension.histogram.count(SizeHistogram::bucketOf(5)) == 1);
+            }
+        }
+        REQUIRE(files == 101);
+
+        uint64_t histogramFiles = 0;
+        for (size_t bucket = 0; bucket < SizeHistogram::kBuckets; ++bucket) {
+            histogramFiles += stats.histogram().count(bucket);
+        }
+        REQUIRE(histogramFiles == 101);
+        REQUIRE(stats.histogram().count(0) == 1);
+    }
+
+    SECTION("Same answer from an existing PathList") {
+        TreeStats streamed = TreeStats::collect(testDir, options);
+        TreeStats listed = TreeStats::collect(Walker(options.walk).scan(testDir), options);
+        REQUIRE(listed.files() == streamed.files());
+        REQUIRE(listed.bytes() == streamed.bytes());
+        REQUIRE(listed.largest()[0].path == streamed.largest()[0].path);
+        REQUIRE(listed.extensions().size() == streamed.extensions().size());
+    }
+
+    SECTION("Extensions beyond the limit are pooled") {
+        options.maxExtensions = 2;
+        TreeStats stats = TreeStats::collect(testDir, options);
+        REQUIRE(stats.extensions().size() == 2);
+        uint64_t files = stats.otherExtensions().files;
+        for (const ExtensionStats& extension : stats.extensions()) {
+            files += extension.files;
+        }
+        REQUIRE(files == 101);
+    }
+
+    SECTION("The extension cap is applied once, after merging") {
+        // 30 extensions spread over every directory, so each worker sees a different mix
+        for (int d = 0; d < 4; ++d) {
+            for (int e = 0; e < 30; ++e) {
+                File(testDir / ("dir" + std::to_string(d)) / ("extra" + std::to_string(e) + ".x" + std::to_string(e)))
+                    .writeText(std::string(static_cast<size_t>(e % 10 + d), 'y'));
+            }
+        }
+        options.maxExtensions = 5;
+        auto summary = [](const TreeStats& stats) {
+            std::vector<std::pair<std::string, uint64_t>> result;
+            for (const ExtensionStats& extension : stats.extensions()) {
+                result.emplace_back(extension.extension, extension.files);
+            }
+            result.emplace_back("other", stats.otherExtensions().files);
+            return result;
+        };
+        TreeStats first = TreeStats::collect(testDir, options);
+        std::vector<std::pair<std::string, uint64_t>> expected = summary(first);
+        REQUIRE(expected.size() == 6);
+        REQUIRE(expected[0].first == ".bin");
+        uint64_t files = 0;
+        for (const auto& entry : expected) {
+            files += entry.second;
+        }
+        REQUIRE(files == 101 + 120);
+        for (int run = 0; run < 5; ++run) {
+            REQUIRE(summary(TreeStats::collect(testDir, options)) == expected);
+        }
+        REQUIRE(summary(TreeStats::collect(Walker(options.walk).scan(testDir), options)) == expected);
+    }
+
+    SECTION("Walker streams entries without a list") {
+        // Callbacks run on pool threads, where Catch assertions are not safe
+        std::atomic<size_t> seen{0};
+        std::atomic<bool> valid{true};
+        Walker walker(options.walk);
+        walker.walk(testDir, [&](size_t worker, const WalkEntry& entry) {
+            if (worker >= walker.workerCount() || entry.directory.empty()) {
+                valid = false;
+            }
+            ++seen;
+        });
+        REQUIRE(seen == 105);
+        REQUIRE(valid);
+    }
+
+    SECTION("A throwing callback ends the walk with its exception") {
+        std::atomic<bool> thrown{false};
+        Walker walker(options.walk);
+        REQUIRE_THROWS_WITH(walker.walk(testDir,
+                                        [&](size_t, const WalkEntry& entry) {
+                                            // Thrown from a subdirectory while the other workers are busy
+                                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                                            if (entry.name == "file7.txt" && !thrown.exchange(true)) {
+                                                throw std::runtime_error("stop here");
+                                            }
+                                        }),
+                            "stop here");
+        REQUIRE(thrown);
+    }
+
+    Directory(testDir).remove(true);
+}
@@ -0,0 +1,185 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include "core/file_id.hpp"
+#include "core/walker.hpp"
+#include "core/thread_pool.hpp"
+
+#include <algorithm>
+#include <set>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+
+using namespace crossdev;
+using namespace crossdev::fs;
+
+TEST_CASE("PathList stores entries compactly", "[walker]") {
+    PathList list(Path("/data"));
+    uint32_t logs = list.add(PathList::kRoot, "logs", EntryType::Directory);
+    uint32_t app = list.add(logs, "app", EntryType::Directory);
+    uint32_t file = list.add(app, "today.log", EntryType::File, 1234, 42);
+    list.add(PathList::kRoot, "readme.txt", EntryType::File, 7);
+
+    REQUIRE(list.size() == 4);
+    REQUIRE(list.name(file) == "today.log");
+    REQUIRE(list.parent(file) == app);
+    REQUIRE(list.type(logs) == EntryType::Directory);
+    REQUIRE(list.fileSize(file) == 1234);
+    REQUIRE(list.mtime(file) == 42);
+
+    std::string buffer;
+    list.relativePathInto(file, buffer);
+    REQUIRE(buffer == (Path("logs") / "app" / "today.log").toString());
+    list.pathInto(3, buffer);
+    REQUIRE(buffer == (Path("/data") / "readme.txt").toString());
+    REQUIRE(list.path(file).toString() == (Path("/data") / "logs" / "app" / "today.log").toString());
+
+    PathList rooted(Path("/"));
+    rooted.add(PathList::kRoot, "etc", EntryType::Directory);
+    REQUIRE(rooted.path(0).toString() == Path("/etc").toString());
+
+    // Names are stored once, not as full paths
+    REQUIRE(list.memoryUsage() < 4 * 64);
+}
+
+TEST_CASE("FileIdSet tracks identities", "[walker]") {
+    FileIdSet ids;
+    REQUIRE(ids.insert({1, 2}));
+    REQUIRE_FALSE(ids.insert({1, 2}));
+    REQUIRE(ids.insert({2, 1}));
+    REQUIRE(ids.insert({0, 0}));
+    REQUIRE_FALSE(ids.insert({0, 0}));
+    for (uint64_t inode = 100; inode < 10000; ++inode) {
+        REQUIRE(ids.insert({7, inode}));
+    }
+    REQUIRE(ids.size() == 3 + 9900);
+    REQUIRE(ids.contains({7, 5000}));
+    REQUIRE_FALSE(ids.contains({8, 5000}));
+    ids.clear();
+    REQUIRE_FALSE(ids.contains({1, 2}));
+}
+
+TEST_CASE("Walker scans a tree with metadata", "[walker]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-walker";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    Directory(testDir).create();
+    std::set<std::string> expected;
+    for (int d = 0; d < 4; ++d) {
+        Path dir = testDir / ("dir" + std::to_string(d));
+        Directory(dir).create();
+        Directory(dir / "nested").create();
+        expected.insert((Path("dir" + std::to_string(d))).toString());
+        expected.insert((Path("dir" + std::to_string(d)) / "nested").toString());
+        for (int f = 0; f < 5; ++f) {
+            std::string name = "file" + std::to_string(f) + ".txt";
+            File(dir / "nested" / name).writeText(std::string(static_cast<size_t>(f), 'x'));
+            expected.insert((Path("dir" + std::to_string(d)) / "nested" / name).toString());
+        }
+    }
+    File(testDir / "top.txt").writeText("top");
+    expected.insert("top.txt");
+
+    ThreadPool pool(3);
+    WalkOptions options;
+    options.pool = &pool;
+
+    SECTION("Recursive scan finds every entry once") {
+        PathList list = Walker(options).scan(testDir);
+        std::set<std::string> found;
+        std::string relative;
+        for (size_t i = 0; i < list.size(); ++i) {
+            list.relativePathInto(i, relative);
+            REQUIRE(found.insert(relative).second);
+            if (list.name(i) == "file3.txt") {
+                REQUIRE(list.type(i) == EntryType::File);
+                REQUIRE(list.fileSize(i) == 3);
+                REQUIRE(list.mtime(i) > 0);
+            }
+        }
+        REQUIRE(found == expected);
+    }
+
+    SECTION("Non-recursive scan lists the root only") {
+        options.recursive = false;
+        PathList list = Walker(options).scan(testDir);
+        REQUIRE(list.size() == 5);
+        for (size_t i = 0; i < list.size(); ++i) {
+            REQUIRE(list.parent(i) == PathList::kRoot);
+        }
+    }
+
+    SECTION("Missing root throws") {
+        REQUIRE_THROWS_AS(Walker(options).scan(testDir / "missing"), FileSystemException);
+    }
+
+    Directory(testDir).remove(true);
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+TEST_CASE("Walker symlink policies", "[walker]") {
+    Path testDir = Path::tempDirectory() / "crossdev-test-walker-links";
+    if (Directory(testDir).exists()) {
+        Directory(testDir).remove(true);
+    }
+    // shared/data.bin is reachable through two links, and a/up loops to the root
+    Directory(testDir).create();
+    Directory(testDir / "a").create();
+    Directory(testDir / "shared").create();
+    File(testDir / "shared" / "data.bin").writeText("data");
+    REQUIRE(::symlink(testDir.toString().c_str(), (testDir / "a" / "up").toString().c_str()) == 0);
+    REQUIRE(::symlink((testDir / "shared").toString().c_str(), (testDir / "a" / "s1").toString().c_str()) == 0);
+    REQUIRE(::symlink((testDir / "shared").toString().c_str(), (testDir / "a" / "s2").toString().c_str()) == 0);
+
+    ThreadPool pool(2);
+    WalkOptions options;
+    options.pool = &pool;
+
+    auto countNamed = [](const PathList& list, std::string_view name) {
+        size_t count = 0;
+        for (size_t i = 0; i < list.size(); ++i) {
+            count += list.name(i) == name ? 1 : 0;
+        }
+        return count;
+    };
+
+    SECTION("Never reports links without following them") {
+        PathList list = Walker(options).scan(testDir);
+        REQUIRE(list.size() == 6);
+        REQUIRE(countNamed(list, "data.bin") == 1);
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (list.name(i) == "up") {
+                REQUIRE(list.type(i) == EntryType::Symlink);
+            }
+        }
+    }
+
+    SECTION("Follow descends links but never re-enters an ancestor") {
+        options.symlinks = SymlinkPolicy::Follow;
+        PathList list = Walker(options).scan(testDir);
+        // shared, s1 and s2 each list data.bin; up is reported but not entered
+        REQUIRE(countNamed(list, "data.bin") == 3);
+        for (size_t i = 0; i < list.size(); ++i) {
+            if (list.name(i) == "up") {
+                REQUIRE(list.type(i) == EntryType::Directory);
+            }
+        }
+    }
+
+    SECTION("FollowOnce scans each directory once") {
+        options.symlinks = SymlinkPolicy::FollowOnce;
+        PathList list = Walker(options).scan(testDir);
+        REQUIRE(countNamed(list, "data.bin") == 1);
+    }
+
+    SECTION("One filesystem stays on the root device") {
+        options.oneFileSystem = true;
+        PathList list = Walker(options).scan(testDir);
+        REQUIRE(countNamed(list, "data.bin") == 1);
+    }
+
+    Directory(testDir).remove(true);
+}
+#endif
@@ -0,0 +1,84 @@
+#include "core/async.hpp"
+#include "core/filesystem.hpp"
+#include "core/thread_pool.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace crossdev::fs;
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* label, size_t files, size_t bytes, double seconds) {
+    std::cout << label << ": " << files << " files in " << seconds * 1000.0 << " ms ("
+              << static_cast<size_t>(files / seconds) << " files/s, "
+              << (bytes / seconds) / (1024.0 * 1024.0) << " MiB/s)\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t fileCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    size_t fileSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 4096;
+
+    try {
+        Path benchDir(Path::tempDirectory().toString() + Path::separator() + "crossdev-async-bench");
+        Directory dir(benchDir);
+        if (dir.exists()) {
+            dir.remove(true);
+        }
+        dir.create();
+
+        std::cout << "Async I/O benchmark: " << fileCount << " files of " << fileSize << " bytes, "
+                  << crossdev::ThreadPool::io().size() << " I/O threads\n";
+
+        std::string payload(fileSize, 'x');
+        std::vector<Path> paths;
+        paths.reserve(fileCount);
+        for (size_t i = 0; i < fileCount; ++i) {
+            paths.emplace_back(benchDir.toString() + Path::separator() + "file" + std::to_string(i) + ".txt");
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::future<void>> writes;
+        writes.reserve(fileCount);
+        for (const Path& path : paths) {
+            writes.push_back(writeAsync(path, payload));
+        }
+        for (auto& pending : writes) {
+            pending.get();
+        }
+        report("writeAsync      ", fileCount, fileCount * fileSize, secondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        size_t bytes = 0;
+        for (const Path& path : paths) {
+            bytes += File(path).readAsText().size();
+        }
+        report("readAsText (sync)", fileCount, bytes, secondsSince(start));
+
+        start = std::chrono::steady_clock::now();
+        std::vector<std::future<std::string>> reads;
+        reads.reserve(fileCount);
+        for (const Path& path : paths) {
+            reads.push_back(readAsync(path));
+        }
+        bytes = 0;
+        for (auto& pending : reads) {
+            bytes += pending.get().size();
+        }
+        report("readAsync       ", fileCount, bytes, secondsSince(start));
+
+        dir.remove(true);
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "ERROR: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -16,8 +16,7 @@ int main() {
         std::cout << "Path separator: '" << Path::separator() << "'\n";
         
         // Create a test directory in the temp folder
-        Path testDir = Path::tempDirectory();
-        testDir = Path(testDir.toString() + Path::separator() + "crossdev-test-cpp");
+        Path testDir = Path::tempDirectory() / "crossdev-test-cpp";
         std::cout << "\nCreating test directory: " << testDir.toString() << "\n";
         
         Directory dir(testDir);
@@ -30,8 +29,8 @@ int main() {
         std::cout << "Directory created.\n";
         
         // Create some files
-        Path testFile1(testDir.toString() + Path::separator() + "test1.txt");
-        Path testFile2(testDir.toString() + Path::separator() + "test2.txt");
+        Path testFile1 = testDir / "test1.txt";
+        Path testFile2 = testDir / "test2.txt";
         
         std::cout << "\nCreating test files:\n";
         std::cout << "- " << testFile1.toString() << "\n";
@@ -62,7 +61,7 @@ int main() {
         }
         
         // Copy a file
-        Path copiedFile(testDir.toString() + Path::separator() + "test1-copy.txt");
+        Path copiedFile = testDir / "test1-copy.txt";
         std::cout << "\nCopying " << testFile1.filename() << " to " << copiedFile.filename() << "\n";
         file1.copy(copiedFile);
         
@@ -71,31 +70,23 @@ int main() {
         std::cout << "Copy exists: " << (copyExists ? "yes" : "no") << "\n";
         
         // Create a subdirectory
-        Path subDir(testDir.toString() + Path::separator() + "subdir");
+        Path subDir = testDir / "subdir";
         std::cout << "\nCreating subdirectory: " << subDir.toString() << "\n";
         Directory(subDir).create();
         
         // Create a file in the subdirectory
-        Path subFile(subDir.toString() + Path::separator() + "subfile.txt");
+        Path subFile = subDir / "subfile.txt";
         File(subFile).writeText("This is a file in a subdirectory.");
         
         // List directory contents recursively
         std::cout << "\nDirectory contents (recursive):\n";
         std::vector<Path> recursiveContents = dir.list(true);
+        std::string relativePath;
         for (const Path& entry : recursiveContents) {
             std::string type = entry.isDirectory() ? "Directory" : "File";
             
-            // Create a relative path for display
-            std::string entryStr = entry.toString();
-            std::string testDirStr = testDir.toString();
-            
-            std::string relativePath;
-            if (entryStr.length() > testDirStr.length()) {
-                // Remove the test directory prefix and the separator
-                relativePath = entryStr.substr(testDirStr.length() + 1);
-            } else {
-                relativePath = entry.filename();
-            }
+            // Create a relative path for display, reusing one buffer
+            entry.relativeTo(testDir, relativePath);
             
             std::cout << "- " << relativePath << " [" << type << "]\n";
         }
@@ -0,0 +1,148 @@
+#include "core/filesystem.hpp"
+#include "core/static_server.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace crossdev::fs;
+
+namespace {
+
+struct ClientTotals {
+    uint64_t requests = 0;
+    uint64_t bytes = 0;
+    uint64_t errors = 0;
+};
+
+// One keep-alive connection issuing GETs back to back until the deadline
+ClientTotals runClient(uint16_t port, const std::vector<std::string>& targets, size_t seed,
+                       std::chrono::steady_clock::time_point deadline) {
+    ClientTotals totals;
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        ++totals.errors;
+        return totals;
+    }
+
+    std::string buffer;
+    std::vector<char> chunk(256 * 1024);
+    for (size_t i = seed; std::chrono::steady_clock::now() < deadline; ++i) {
+        std::string request = "GET " + targets[i % targets.size()] + " HTTP/1.1\r\nHost: bench\r\n\r\n";
+        if (::send(fd, request.data(), request.size(), MSG_NOSIGNAL) != static_cast<ssize_t>(request.size())) {
+            ++totals.errors;
+            break;
+        }
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            ssize_t got = ::recv(fd, chunk.data(), chunk.size(), 0);
+            if (got <= 0) {
+                ++totals.errors;
+                ::close(fd);
+                return totals;
+            }
+            buffer.append(chunk.data(), static_cast<size_t>(got));
+        }
+        const char* length = std::strstr(buffer.c_str(), "Content-Length: ");
+        size_t body = length != nullptr ? std::strtoul(length + 16, nullptr, 10) : 0;
+        size_t total = end + 4 + body;
+        // Drain the body without keeping it
+        while (buffer.size() < total) {
+            ssize_t got = ::recv(fd, chunk.data(), std::min(chunk.size(), total - buffer.size()), 0);
+            if (got <= 0) {
+                ++totals.errors;
+                ::close(fd);
+                return totals;
+            }
+            total -= static_cast<size_t>(got);
+        }
+        buffer.erase(0, total);
+        ++totals.requests;
+        totals.bytes += body;
+    }
+    ::close(fd);
+    return totals;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t connections = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 8;
+    size_t fileSize = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 16384;
+    double seconds = argc > 3 ? std::strtod(argv[3], nullptr) : 3.0;
+    size_t serverThreads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 1;
+    const size_t fileCount = 64;
+
+    try {
+        Path benchDir = Path::tempDirectory() / "crossdev-server-bench";
+        if (Directory(benchDir).exists()) {
+            Directory(benchDir).remove(true);
+        }
+        Directory(benchDir).create();
+        std::vector<std::string> targets;
+        for (size_t i = 0; i < fileCount; ++i) {
+            std::string name = "file" + std::to_string(i) + ".bin";
+            File(benchDir / name).writeText(std::string(fileSize, static_cast<char>('a' + i % 26)));
+            targets.push_back("/" + name);
+        }
+
+        StaticServerOptions options;
+        options.threads = serverThreads;
+        StaticServer server(benchDir, options);
+        server.start();
+
+        std::cout << "Static server benchmark: " << connections << " keep-alive connections, " << fileCount
+                  << " files of " << fileSize << " bytes, " << serverThreads << " server threads, " << seconds
+                  << " s\n";
+
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double>(seconds));
+        std::vector<ClientTotals> totals(connections);
+        std::vector<std::thread> clients;
+        for (size_t i = 0; i < connections; ++i) {
+            clients.emplace_back([&, i]() { totals[i] = runClient(server.port(), targets, i * 7, deadline); });
+        }
+        for (std::thread& client : clients) {
+            client.join();
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        ClientTotals sum;
+        for (const ClientTotals& client : totals) {
+            sum.requests += client.requests;
+            sum.bytes += client.bytes;
+            sum.errors += client.errors;
+        }
+        StaticServerStats stats = server.stats();
+        server.stop();
+
+        std::cout << sum.requests << " requests in " << elapsed << " s (" << static_cast<uint64_t>(sum.requests / elapsed)
+                  << " req/s, " << (sum.bytes / elapsed) / (1024.0 * 1024.0) << " MiB/s), " << sum.errors
+                  << " errors\n";
+        std::cout << "Server: " << stats.connections << " connections, " << stats.cacheHits
+                  << " asset cache hits\n";
+
+        Directory(benchDir).remove(true);
+    } catch (const FileSystemException& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}